@@ -0,0 +1,248 @@
+// ------------------------------ avllinks.h ----------------------------------
+// Header file for the AvlLinks class template. AvlLinks holds the node-level
+// work that BinTree and BasicBinTree share: reading and recomputing the
+// height and size cached in each node, AVL rotations and rebalancing,
+// relinking a node under its parent, and unlinking a node and retracing
+// the path above it. Both trees call these instead of keeping copies of
+// their own, so the two cannot drift apart.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Node has left, right and parent pointers to Node, parent nullptr at the
+//   root of a tree, and int height and size members: the height of the
+//   subtree, 1 for a leaf, and the number of nodes in it.
+// - Every function is static; the tree passes its root pointer, as top, and
+//   its balancing mode wherever they are needed.
+// - Nothing here allocates, frees or compares keys, so a Node can hold its
+//   data in any form.
+// ----------------------------------------------------------------------------
+
+#ifndef AVLLINKS_H
+#define AVLLINKS_H
+
+using namespace std;
+
+template <typename Node>
+class AvlLinks
+{
+public:
+	/////////////////////// Height ////////////////////////////
+	// <summary>
+	// Reads the stored height of a subtree.
+	// </summary>
+	// <returns>
+	// Returns the height of node, 0 for an empty subtree.
+	// </returns>
+	static int height(const Node* node)
+	{
+		return (node != nullptr) ? node->height : 0;
+	}
+
+	//////////////////////// Size /////////////////////////////
+	// <summary>
+	// Reads the stored size of a subtree.
+	// </summary>
+	// <returns>
+	// Returns the number of nodes under and including node, 0 for an empty
+	// subtree.
+	// </returns>
+	static int size(const Node* node)
+	{
+		return (node != nullptr) ? node->size : 0;
+	}
+
+	/////////////////////// Update ////////////////////////////
+	// <summary>
+	// Recomputes the stored height and subtree size of node from those of
+	// its children.
+	// </summary>
+	static void update(Node* node)
+	{
+		int left = height(node->left);
+		int right = height(node->right);
+
+		node->height = ((right > left) ? right : left) + 1;
+		node->size = size(node->left) + size(node->right) + 1;
+	}
+
+	////////////////////// Rotate Left ////////////////////////
+	// <summary>
+	// Rotates the subtree at node to the left, making its right child the
+	// new subtree root.
+	// </summary>
+	static void rotateLeft(Node* &node)
+	{
+		Node* pivot = node->right;
+
+		node->right = pivot->left;
+		if (pivot->left != nullptr)
+		{
+			pivot->left->parent = node;
+		}
+		pivot->left = node;
+		pivot->parent = node->parent;
+		node->parent = pivot;
+		update(node);
+		update(pivot);
+		node = pivot;
+	}
+
+	////////////////////// Rotate Right ///////////////////////
+	// <summary>
+	// Rotates the subtree at node to the right, making its left child the
+	// new subtree root.
+	// </summary>
+	static void rotateRight(Node* &node)
+	{
+		Node* pivot = node->left;
+
+		node->left = pivot->right;
+		if (pivot->right != nullptr)
+		{
+			pivot->right->parent = node;
+		}
+		pivot->right = node;
+		pivot->parent = node->parent;
+		node->parent = pivot;
+		update(node);
+		update(pivot);
+		node = pivot;
+	}
+
+	/////////////////////// Rebalance /////////////////////////
+	// <summary>
+	// Restores the AVL property at node with a single or double rotation
+	// when its children differ in height by more than one.
+	// </summary>
+	static void rebalance(Node* &node)
+	{
+		int balance = height(node->left) - height(node->right);
+
+		if (balance > 1)						// left heavy
+		{
+			if (height(node->left->left) < height(node->left->right))
+			{
+				rotateLeft(node->left);			// left-right case
+			}
+			rotateRight(node);
+		}
+		else if (balance < -1)					// right heavy
+		{
+			if (height(node->right->right) < height(node->right->left))
+			{
+				rotateRight(node->right);		// right-left case
+			}
+			rotateLeft(node);
+		}
+	}
+
+	///////////////////////// Link To /////////////////////////
+	// <summary>
+	// Finds the pointer holding node: the matching child pointer of its
+	// parent, or top when node has no parent.
+	// </summary>
+	// <parameter = "top">
+	// Root pointer of the tree or standalone subtree that node belongs to.
+	// </parameter>
+	// <returns>
+	// Returns a reference to the link that points at node.
+	// </returns>
+	static Node* &linkTo(Node* node, Node* &top)
+	{
+		Node* parent = node->parent;
+
+		if (parent == nullptr)
+		{
+			return top;
+		}
+
+		return (parent->left == node) ? parent->left : parent->right;
+	}
+
+	///////////////////////// Replace /////////////////////////
+	// <summary>
+	// Puts replacement where node hangs in the tree rooted at top. Only the
+	// link and the parent pointer of replacement are changed.
+	// </summary>
+	static void replace(Node* node, Node* replacement, Node* &top)
+	{
+		linkTo(node, top) = replacement;
+
+		if (replacement != nullptr)
+		{
+			replacement->parent = node->parent;
+		}
+	}
+
+	///////////////////////// Retrace /////////////////////////
+	// <summary>
+	// Walks from node up to top, recomputing heights and sizes and, when
+	// balanced, rebalancing each subtree on the way.
+	// </summary>
+	static void retrace(Node* node, Node* &top, bool balanced)
+	{
+		while (node != nullptr)
+		{
+			Node* &link = linkTo(node, top);
+			update(node);
+
+			if (balanced)
+			{
+				rebalance(link);
+			}
+			node = link->parent;
+		}
+	}
+
+	///////////////////////// Unlink //////////////////////////
+	// <summary>
+	// Takes node out of the tree rooted at top, moving its in-order
+	// successor into its place when it has two children, then retraces from
+	// the lowest node whose subtree changed. node comes out with no links;
+	// freeing it and its data is left to the caller.
+	// </summary>
+	static void unlink(Node* node, Node* &top, bool balanced)
+	{
+		Node* start = node->parent;				// lowest changed subtree
+
+		if (node->left == nullptr)
+		{
+			replace(node, node->right, top);
+		}
+		else if (node->right == nullptr)
+		{
+			replace(node, node->left, top);
+		}
+		else
+		{
+			Node* next = node->right;			// the in-order successor
+
+			while (next->left != nullptr)
+			{
+				next = next->left;
+			}
+
+			if (next->parent != node)
+			{
+				start = next->parent;
+				replace(next, next->right, top);
+				next->right = node->right;
+				next->right->parent = next;
+			}
+			else
+			{
+				start = next;
+			}
+
+			replace(node, next, top);
+			next->left = node->left;
+			next->left->parent = next;
+		}
+
+		node->left = nullptr;
+		node->right = nullptr;
+		node->parent = nullptr;
+		retrace(start, top, balanced);
+	}
+};
+
+#endif
@@ -0,0 +1,935 @@
+// ---------------------------- basicbintree.h --------------------------------
+// Header file for the BasicBinTree class template. BasicBinTree is a binary
+// search tree over any key type, ordered by a pluggable comparator and
+// allocated through a pluggable allocator. Keys are stored inline in the
+// nodes, so there is no separate heap object per element and small keys
+// such as int or uint64_t keep each node compact.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Compare is a strict weak ordering. Two keys are duplicates when neither
+//   compares less than the other; duplicates are not inserted.
+// - Like BinTree, the tree is unbalanced unless constructed with balanced set
+//   to true, in which case insert and remove keep it AVL-balanced.
+// - Every node keeps its parent, subtree height and subtree size, so
+//   iteration, getHeight, size, rank and select need no extra walks.
+// - BinTree remains the owning NodeData* interface used by existing callers;
+//   BasicBinTree is the value-based tree for new code.
+// - Heights, sizes, rotations and unlinking come from AvlLinks, which
+//   BinTree uses as well.
+// ----------------------------------------------------------------------------
+
+#ifndef BASICBINTREE_H
+#define BASICBINTREE_H
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "avllinks.h"
+
+using namespace std;
+
+template <typename Key, typename Compare = less<Key>,
+	typename Alloc = allocator<Key>>
+class BasicBinTree
+{
+	struct Node;							// defined in the private section
+
+public:
+	typedef Key key_type;
+	typedef Key value_type;
+	typedef Compare key_compare;
+	typedef Alloc allocator_type;
+
+	/////////////////////// Constructor ///////////////////////
+	// <summary>
+	// Creates an empty tree. The tree AVL-balances itself on insert and
+	// remove when balanced is true.
+	// </summary>
+	explicit BasicBinTree(bool balanced = false, const Compare &comp = Compare(),
+		const Alloc &alloc = Alloc());
+
+	//////////////////// Copy Constructor /////////////////////
+	// <summary>
+	// Performs a deep copy, including the balancing mode and comparator.
+	// </summary>
+	BasicBinTree(const BasicBinTree &obj);
+
+	//////////////////// Move Constructor /////////////////////
+	// <summary>
+	// Takes over the nodes and allocator of obj, leaving obj empty. Costs
+	// O(1), and only throws if moving the comparator does.
+	// </summary>
+	BasicBinTree(BasicBinTree &&obj)
+		noexcept(is_nothrow_move_constructible<Compare>::value);
+
+	////////////////////// Destructor /////////////////////////
+	~BasicBinTree();
+
+	//////////////////////// = Operator ///////////////////////
+	// <summary>
+	// The allocator is replaced by obj's only when the allocator's
+	// propagate_on_container_copy_assignment or _move_assignment says so.
+	// A move takes over obj's nodes in O(1) when the allocator goes with
+	// them or the two allocators are equal; otherwise each key is moved into
+	// a node of this tree's allocator, and obj is left empty either way.
+	// </summary>
+	BasicBinTree& operator=(const BasicBinTree &obj);
+	BasicBinTree& operator=(BasicBinTree &&obj)
+		noexcept((allocator_traits<Alloc>::
+			propagate_on_container_move_assignment::value
+			|| allocator_traits<Alloc>::is_always_equal::value)
+			&& is_nothrow_move_assignable<Compare>::value);
+
+	/////////////////////// == Operator ///////////////////////
+	// <summary>
+	// Two trees are equal when they hold the same keys, regardless of shape.
+	// </summary>
+	bool operator==(const BasicBinTree &obj) const;
+	bool operator!=(const BasicBinTree &obj) const;
+
+	bool isEmpty() const;
+	bool isBalanced() const;
+
+	////////////////////////// Size ///////////////////////////
+	// <summary>
+	// Returns the number of keys in the tree, in O(1).
+	// </summary>
+	int size() const;
+
+	/////////////////////// Make Empty ////////////////////////
+	// <summary>
+	// Destroys every key and node. isEmpty returns true afterwards.
+	// </summary>
+	void makeEmpty();
+
+	//////////////////////// Insert ///////////////////////////
+	// <summary>
+	// Inserts key in its sorted position. Duplicates are not inserted.
+	// </summary>
+	// <returns>
+	// Returns true if the key was inserted, false if it was a duplicate.
+	// </returns>
+	bool insert(const Key &key);
+	bool insert(Key &&key);
+
+	///////////////////////// Remove ////////////////////////
+	// <summary>
+	// Removes and destroys the key equal to the passed key.
+	// </summary>
+	// <returns>
+	// Returns true if the key was found and removed, false otherwise.
+	// </returns>
+	bool remove(const Key &key);
+
+	//////////////////////// Retrieve /////////////////////////
+	// <summary>
+	// Searches for key, sets found to the stored key if found.
+	// </summary>
+	// <returns>
+	// Returns true if the key is found and set, false otherwise.
+	// </returns>
+	bool retrieve(const Key &key, const Key* &found) const;
+
+	/////////////////////// Get Height ////////////////////////
+	// <summary>
+	// Returns the height of the subtree at key, 0 if key is not found.
+	// </summary>
+	int getHeight(const Key &key) const;
+
+	////////////////// Lower and Upper Bound //////////////////
+	// <summary>
+	// Ordered queries, same meaning as on BinTree: lowerBound and ceiling
+	// find the smallest key >= key, upperBound the smallest key > key and
+	// floor the largest key <= key.
+	// </summary>
+	// <returns>
+	// Returns true if such a key exists and found is set, false otherwise.
+	// </returns>
+	bool lowerBound(const Key &key, const Key* &found) const;
+	bool upperBound(const Key &key, const Key* &found) const;
+	bool floor(const Key &key, const Key* &found) const;
+	bool ceiling(const Key &key, const Key* &found) const;
+
+	///////////////////// Rank and Select /////////////////////
+	// <summary>
+	// rank returns the number of keys less than key. select sets found to
+	// the key at position k of the sorted order, counting from 0. countRange
+	// returns the number of keys in [low, high].
+	// </summary>
+	int rank(const Key &key) const;
+	bool select(int k, const Key* &found) const;
+	int countRange(const Key &low, const Key &high) const;
+
+	//////////////////////// Iterator /////////////////////////
+	// <summary>
+	// Bidirectional iterator over the keys in sorted order. Steps along child
+	// and parent links without allocating. Keys are read-only.
+	// </summary>
+	class Iterator
+	{
+	public:
+		typedef bidirectional_iterator_tag iterator_category;
+		typedef Key value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const Key* pointer;
+		typedef const Key& reference;
+
+		Iterator() : node(nullptr), tree(nullptr) {}
+
+		reference operator*() const { return node->key; }
+		pointer operator->() const { return &node->key; }
+
+		Iterator& operator++()
+		{
+			node = successor(node);
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator previous = *this;
+			++(*this);
+			return previous;
+		}
+
+		Iterator& operator--()
+		{
+			node = (node == nullptr) ? rightmost(tree->root) : predecessor(node);
+			return *this;
+		}
+
+		Iterator operator--(int)
+		{
+			Iterator previous = *this;
+			--(*this);
+			return previous;
+		}
+
+		bool operator==(const Iterator &other) const { return node == other.node; }
+		bool operator!=(const Iterator &other) const { return node != other.node; }
+
+	private:
+		friend class BasicBinTree;
+
+		Iterator(Node* node, const BasicBinTree* tree) : node(node), tree(tree) {}
+
+		Node* node;							// current node, nullptr at end()
+		const BasicBinTree* tree;			// owning tree, used to step back from end()
+	};
+
+	typedef Iterator iterator;
+	typedef Iterator const_iterator;
+	typedef std::reverse_iterator<Iterator> reverse_iterator;
+	typedef std::reverse_iterator<Iterator> const_reverse_iterator;
+
+	Iterator begin() const { return Iterator(leftmost(root), this); }
+	Iterator end() const { return Iterator(nullptr, this); }
+	reverse_iterator rbegin() const { return reverse_iterator(end()); }
+	reverse_iterator rend() const { return reverse_iterator(begin()); }
+
+private:
+	struct Node {
+		template <typename... Args>
+		explicit Node(Args&&... args) : left(nullptr), right(nullptr),
+			parent(nullptr), height(1), size(1), key(std::forward<Args>(args)...) {}
+
+		Node* left;							// left subtree pointer
+		Node* right;						// right subtree pointer
+		Node* parent;						// parent pointer, nullptr for root
+		int height;							// height of subtree, 1 for a leaf
+		int size;							// nodes in subtree, 1 for a leaf
+		Key key;							// key stored inline
+	};
+	typedef AvlLinks<Node> Links;			// heights, rotations and unlinking
+
+	typedef typename allocator_traits<Alloc>::template rebind_alloc<Node> NodeAlloc;
+	typedef allocator_traits<NodeAlloc> NodeTraits;
+
+	Node* root;								// root of the tree
+	bool balanced;							// true to AVL-balance on insert/remove
+	Compare comp;							// key ordering
+	NodeAlloc nodeAlloc;					// allocator for the tree's nodes
+
+	////////////////////// Make Node //////////////////////////
+	// <summary>
+	// Allocates a node through the node allocator and constructs its key
+	// from args.
+	// </summary>
+	template <typename... Args>
+	Node* makeNode(Args&&... args);
+
+	/////////////////////// Free Node /////////////////////////
+	// <summary>
+	// Destroys the key of node and returns it to the node allocator.
+	// </summary>
+	void freeNode(Node* node);
+
+	//////////////////////// Assign ///////////////////////////
+	// <summary>
+	// Deep copies the tree at source with an explicit stack, moving each key
+	// out of source instead when moveKeys is true.
+	// </summary>
+	// <returns>
+	// Returns the root of the copy.
+	// </returns>
+	Node* assign(Node* source, bool moveKeys = false);
+
+	////////////////////// Insert Key /////////////////////////
+	// <summary>
+	// Shared body of both insert overloads. Descends to the empty link for
+	// key, links a new node there and retraces with parent pointers.
+	// </summary>
+	template <typename K>
+	bool insertKey(K &&key);
+
+	/////////////////////// Find Node /////////////////////////
+	// <summary>
+	// Finds the node holding key along one root-to-leaf path.
+	// </summary>
+	Node* findNode(const Key &key) const;
+
+	////////////////// Ceiling and Floor Node /////////////////
+	// <summary>
+	// Find the node with the smallest key greater than key (largest key less
+	// than key for floorNode), also accepting an equal key when inclusive.
+	// </summary>
+	Node* ceilingNode(const Key &key, bool inclusive) const;
+	Node* floorNode(const Key &key, bool inclusive) const;
+
+	////////////////////// Count Less /////////////////////////
+	// <summary>
+	// Counts keys less than key, or less than or equal when inclusive.
+	// </summary>
+	int countLess(const Key &key, bool inclusive) const;
+
+	static Node* leftmost(Node* node);
+	static Node* rightmost(Node* node);
+	static Node* successor(Node* node);
+	static Node* predecessor(Node* node);
+};
+
+////////////////////// Constructors ///////////////////////
+template <typename Key, typename Compare, typename Alloc>
+BasicBinTree<Key, Compare, Alloc>::BasicBinTree(bool balanced,
+	const Compare &comp, const Alloc &alloc)
+	: root(nullptr), balanced(balanced), comp(comp), nodeAlloc(alloc)
+{
+}
+
+template <typename Key, typename Compare, typename Alloc>
+BasicBinTree<Key, Compare, Alloc>::BasicBinTree(const BasicBinTree &obj)
+	: root(nullptr), balanced(obj.balanced), comp(obj.comp),
+	nodeAlloc(NodeTraits::select_on_container_copy_construction(obj.nodeAlloc))
+{
+	root = assign(obj.root);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+BasicBinTree<Key, Compare, Alloc>::BasicBinTree(BasicBinTree &&obj)
+	noexcept(is_nothrow_move_constructible<Compare>::value)
+	: root(obj.root), balanced(obj.balanced), comp(std::move(obj.comp)),
+	nodeAlloc(std::move(obj.nodeAlloc))
+{
+	obj.root = nullptr;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+BasicBinTree<Key, Compare, Alloc>::~BasicBinTree()
+{
+	makeEmpty();
+}
+
+/////////////////////// = Operators ///////////////////////
+template <typename Key, typename Compare, typename Alloc>
+BasicBinTree<Key, Compare, Alloc>&
+BasicBinTree<Key, Compare, Alloc>::operator=(const BasicBinTree &obj)
+{
+	if (this != &obj)
+	{
+		makeEmpty();
+		balanced = obj.balanced;
+		comp = obj.comp;
+
+		if constexpr (NodeTraits::propagate_on_container_copy_assignment::value)
+		{
+			nodeAlloc = obj.nodeAlloc;
+		}
+
+		root = assign(obj.root);
+	}
+
+	return *this;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+BasicBinTree<Key, Compare, Alloc>&
+BasicBinTree<Key, Compare, Alloc>::operator=(BasicBinTree &&obj)
+	noexcept((allocator_traits<Alloc>::
+		propagate_on_container_move_assignment::value
+		|| allocator_traits<Alloc>::is_always_equal::value)
+		&& is_nothrow_move_assignable<Compare>::value)
+{
+	if (this != &obj)
+	{
+		makeEmpty();
+		balanced = obj.balanced;
+		comp = std::move(obj.comp);
+
+		if constexpr (NodeTraits::propagate_on_container_move_assignment::value)
+		{
+			nodeAlloc = std::move(obj.nodeAlloc);
+		}
+		else if (nodeAlloc != obj.nodeAlloc)
+		{
+			// nodes must be freed by the allocator that made them
+			root = assign(obj.root, true);
+			obj.makeEmpty();
+			return *this;
+		}
+
+		root = obj.root;
+		obj.root = nullptr;
+	}
+
+	return *this;
+}
+
+////////////////// == and != Operators ////////////////////
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::operator==(const BasicBinTree &obj) const
+{
+	if (size() != obj.size())
+	{
+		return false;
+	}
+
+	for (Iterator left = begin(), right = obj.begin(); left != end(); ++left, ++right)
+	{
+		if (comp(*left, *right) || comp(*right, *left))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::operator!=(const BasicBinTree &obj) const
+{
+	return !(*this == obj);
+}
+
+//////////////////////// Accessors ////////////////////////
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::isEmpty() const
+{
+	return root == nullptr;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::isBalanced() const
+{
+	return balanced;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+int BasicBinTree<Key, Compare, Alloc>::size() const
+{
+	return Links::size(root);
+}
+
+/////////////////////// Make Empty ////////////////////////
+// <summary>
+// Frees every node with an explicit stack, so any tree shape is safe.
+// </summary>
+template <typename Key, typename Compare, typename Alloc>
+void BasicBinTree<Key, Compare, Alloc>::makeEmpty()
+{
+	vector<Node*> stack;
+
+	if (root != nullptr)
+	{
+		stack.push_back(root);
+	}
+
+	while (!stack.empty())
+	{
+		Node* node = stack.back();
+		stack.pop_back();
+
+		if (node->left != nullptr)
+		{
+			stack.push_back(node->left);
+		}
+		if (node->right != nullptr)
+		{
+			stack.push_back(node->right);
+		}
+		freeNode(node);
+	}
+
+	root = nullptr;
+}
+
+//////////////////////// Insert ///////////////////////////
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::insert(const Key &key)
+{
+	return insertKey(key);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::insert(Key &&key)
+{
+	return insertKey(std::move(key));
+}
+
+///////////////////////// Remove ////////////////////////
+// <summary>
+// Unlinks the node holding key, moving its in-order successor into its
+// place when it has two children, then retraces from the lowest changed
+// node to the root.
+// </summary>
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::remove(const Key &key)
+{
+	Node* node = findNode(key);
+
+	if (node == nullptr)
+	{
+		return false;
+	}
+
+	Links::unlink(node, root, balanced);
+	freeNode(node);
+
+	return true;
+}
+
+//////////////////////// Retrieve /////////////////////////
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::retrieve(const Key &key,
+	const Key* &found) const
+{
+	Node* node = findNode(key);
+
+	if (node == nullptr)
+	{
+		return false;
+	}
+
+	found = &node->key;
+	return true;
+}
+
+/////////////////////// Get Height ////////////////////////
+template <typename Key, typename Compare, typename Alloc>
+int BasicBinTree<Key, Compare, Alloc>::getHeight(const Key &key) const
+{
+	return Links::height(findNode(key));
+}
+
+////////////////// Lower and Upper Bound //////////////////
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::lowerBound(const Key &key,
+	const Key* &found) const
+{
+	Node* node = ceilingNode(key, true);
+
+	if (node == nullptr)
+	{
+		return false;
+	}
+
+	found = &node->key;
+	return true;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::upperBound(const Key &key,
+	const Key* &found) const
+{
+	Node* node = ceilingNode(key, false);
+
+	if (node == nullptr)
+	{
+		return false;
+	}
+
+	found = &node->key;
+	return true;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::floor(const Key &key,
+	const Key* &found) const
+{
+	Node* node = floorNode(key, true);
+
+	if (node == nullptr)
+	{
+		return false;
+	}
+
+	found = &node->key;
+	return true;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::ceiling(const Key &key,
+	const Key* &found) const
+{
+	return lowerBound(key, found);
+}
+
+///////////////////// Rank and Select /////////////////////
+template <typename Key, typename Compare, typename Alloc>
+int BasicBinTree<Key, Compare, Alloc>::rank(const Key &key) const
+{
+	return countLess(key, false);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+bool BasicBinTree<Key, Compare, Alloc>::select(int k, const Key* &found) const
+{
+	if (k < 0 || k >= size())
+	{
+		return false;
+	}
+
+	Node* node = root;
+
+	for (;;)
+	{
+		int leftSize = Links::size(node->left);
+
+		if (k < leftSize)
+		{
+			node = node->left;
+		}
+		else if (k == leftSize)
+		{
+			found = &node->key;
+			return true;
+		}
+		else
+		{
+			k -= leftSize + 1;
+			node = node->right;
+		}
+	}
+}
+
+template <typename Key, typename Compare, typename Alloc>
+int BasicBinTree<Key, Compare, Alloc>::countRange(const Key &low,
+	const Key &high) const
+{
+	if (comp(high, low))
+	{
+		return 0;
+	}
+
+	return countLess(high, true) - countLess(low, false);
+}
+
+//////////////////// Node Allocation //////////////////////
+template <typename Key, typename Compare, typename Alloc>
+template <typename... Args>
+typename BasicBinTree<Key, Compare, Alloc>::Node*
+BasicBinTree<Key, Compare, Alloc>::makeNode(Args&&... args)
+{
+	Node* node = NodeTraits::allocate(nodeAlloc, 1);
+
+	try
+	{
+		NodeTraits::construct(nodeAlloc, node, std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		NodeTraits::deallocate(nodeAlloc, node, 1);
+		throw;
+	}
+
+	return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+void BasicBinTree<Key, Compare, Alloc>::freeNode(Node* node)
+{
+	NodeTraits::destroy(nodeAlloc, node);
+	NodeTraits::deallocate(nodeAlloc, node, 1);
+}
+
+//////////////////////// Assign ///////////////////////////
+template <typename Key, typename Compare, typename Alloc>
+typename BasicBinTree<Key, Compare, Alloc>::Node*
+BasicBinTree<Key, Compare, Alloc>::assign(Node* source, bool moveKeys)
+{
+	struct CopyTask {
+		Node** link;						// link to fill with the copy
+		Node* parent;						// parent of the copy
+		Node* source;						// node to be copied
+	};
+	vector<CopyTask> stack;
+	Node* copyRoot = nullptr;
+
+	if (source != nullptr)
+	{
+		stack.push_back({ &copyRoot, nullptr, source });
+	}
+
+	while (!stack.empty())
+	{
+		CopyTask task = stack.back();
+		stack.pop_back();
+
+		Node* copy = moveKeys ? makeNode(std::move(task.source->key))
+			: makeNode(task.source->key);
+		copy->height = task.source->height;
+		copy->size = task.source->size;
+		copy->parent = task.parent;
+		*task.link = copy;
+
+		if (task.source->right != nullptr)
+		{
+			stack.push_back({ &copy->right, copy, task.source->right });
+		}
+		if (task.source->left != nullptr)
+		{
+			stack.push_back({ &copy->left, copy, task.source->left });
+		}
+	}
+
+	return copyRoot;
+}
+
+////////////////////// Insert Key /////////////////////////
+// <summary>
+// Descends to the empty link for key, links a new node there, then climbs
+// the parent pointers. Heights are recomputed (and rebalanced) until one
+// stops changing; above that only the sizes need incrementing.
+// </summary>
+template <typename Key, typename Compare, typename Alloc>
+template <typename K>
+bool BasicBinTree<Key, Compare, Alloc>::insertKey(K &&key)
+{
+	Node* parent = nullptr;
+	Node** link = &root;
+
+	while (*link != nullptr)
+	{
+		parent = *link;
+
+		if (comp(key, parent->key))
+		{
+			link = &parent->left;
+		}
+		else if (comp(parent->key, key))
+		{
+			link = &parent->right;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	Node* node = makeNode(std::forward<K>(key));
+	node->parent = parent;
+	*link = node;
+
+	bool heightChanged = true;
+	for (node = parent; node != nullptr; )
+	{
+		if (!heightChanged)
+		{
+			node->size++;					// only the size is affected
+			node = node->parent;
+			continue;
+		}
+
+		Node* &current = Links::linkTo(node, root);
+		int oldHeight = current->height;
+		Links::update(current);
+
+		if (balanced)
+		{
+			Links::rebalance(current);
+		}
+		heightChanged = (current->height != oldHeight);
+		node = current->parent;
+	}
+
+	return true;
+}
+
+/////////////////////// Find Node /////////////////////////
+template <typename Key, typename Compare, typename Alloc>
+typename BasicBinTree<Key, Compare, Alloc>::Node*
+BasicBinTree<Key, Compare, Alloc>::findNode(const Key &key) const
+{
+	Node* node = root;
+
+	while (node != nullptr)
+	{
+		if (comp(key, node->key))
+		{
+			node = node->left;
+		}
+		else if (comp(node->key, key))
+		{
+			node = node->right;
+		}
+		else
+		{
+			return node;
+		}
+	}
+
+	return nullptr;
+}
+
+////////////////// Ceiling and Floor Node /////////////////
+template <typename Key, typename Compare, typename Alloc>
+typename BasicBinTree<Key, Compare, Alloc>::Node*
+BasicBinTree<Key, Compare, Alloc>::ceilingNode(const Key &key,
+	bool inclusive) const
+{
+	Node* best = nullptr;
+	Node* node = root;
+
+	while (node != nullptr)
+	{
+		if (inclusive ? !comp(node->key, key) : comp(key, node->key))
+		{
+			best = node;					// candidate, look for a smaller one
+			node = node->left;
+		}
+		else
+		{
+			node = node->right;
+		}
+	}
+
+	return best;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+typename BasicBinTree<Key, Compare, Alloc>::Node*
+BasicBinTree<Key, Compare, Alloc>::floorNode(const Key &key,
+	bool inclusive) const
+{
+	Node* best = nullptr;
+	Node* node = root;
+
+	while (node != nullptr)
+	{
+		if (inclusive ? !comp(key, node->key) : comp(node->key, key))
+		{
+			best = node;					// candidate, look for a larger one
+			node = node->right;
+		}
+		else
+		{
+			node = node->left;
+		}
+	}
+
+	return best;
+}
+
+////////////////////// Count Less /////////////////////////
+template <typename Key, typename Compare, typename Alloc>
+int BasicBinTree<Key, Compare, Alloc>::countLess(const Key &key,
+	bool inclusive) const
+{
+	int less = 0;
+	Node* node = root;
+
+	while (node != nullptr)
+	{
+		if (inclusive ? !comp(key, node->key) : comp(node->key, key))
+		{
+			less += Links::size(node->left) + 1;	// node and its left subtree
+			node = node->right;
+		}
+		else
+		{
+			node = node->left;
+		}
+	}
+
+	return less;
+}
+
+//////////////////// Structure Helpers ////////////////////
+template <typename Key, typename Compare, typename Alloc>
+typename BasicBinTree<Key, Compare, Alloc>::Node*
+BasicBinTree<Key, Compare, Alloc>::leftmost(Node* node)
+{
+	while (node != nullptr && node->left != nullptr)
+	{
+		node = node->left;
+	}
+
+	return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+typename BasicBinTree<Key, Compare, Alloc>::Node*
+BasicBinTree<Key, Compare, Alloc>::rightmost(Node* node)
+{
+	while (node != nullptr && node->right != nullptr)
+	{
+		node = node->right;
+	}
+
+	return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+typename BasicBinTree<Key, Compare, Alloc>::Node*
+BasicBinTree<Key, Compare, Alloc>::successor(Node* node)
+{
+	if (node->right != nullptr)
+	{
+		return leftmost(node->right);
+	}
+
+	Node* child = node;
+	node = node->parent;
+	while (node != nullptr && child == node->right)
+	{
+		child = node;
+		node = node->parent;
+	}
+
+	return node;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+typename BasicBinTree<Key, Compare, Alloc>::Node*
+BasicBinTree<Key, Compare, Alloc>::predecessor(Node* node)
+{
+	if (node->left != nullptr)
+	{
+		return rightmost(node->left);
+	}
+
+	Node* child = node;
+	node = node->parent;
+	while (node != nullptr && child == node->left)
+	{
+		child = node;
+		node = node->parent;
+	}
+
+	return node;
+}
+
+#endif
@@ -10,13 +10,24 @@
 // ----------------------------------------------------------------------------
 // Assumptions: 
 // - Array to Binary Search Tree assumes that the array passed in is sorted.
+// - A BinTree is unbalanced unless constructed with balanced set to true, in
+//   which case every insert keeps the tree AVL-balanced.
+// - Iterators stay valid across insert and remove, since nodes are never
+//   moved; removing data invalidates only iterators to that data. They are
+//   all invalidated by makeEmpty, bstreeToArray and assignment.
 // ----------------------------------------------------------------------------
 
+#include <deque>
 #include <iostream>
+#include <utility>
+#include <vector>
 #include "bintree.h"
+#include "treewriter.h"
 
 using namespace std;
 
+atomic<int> BinTree::parallelism(0);
+
 ////////////////// Default Constructor ////////////////////
 // <summary>
 // Default constructor for class BinTree. Creates an empty tree.
@@ -24,6 +35,43 @@ using namespace std;
 BinTree::BinTree()
 {
 	root = nullptr;
+	balanced = false;
+	pool = make_shared<NodePool<Node>>();
+}
+
+/////////////////// Balanced Constructor //////////////////
+// <summary>
+// Constructor for class BinTree. Creates an empty tree that keeps itself
+// AVL-balanced on insert when balanced is true, so sorted input still gives
+// a tree of logarithmic height.
+// </summary>
+// <parameter = "balanced">
+// True to rebalance on insert, false for a plain binary search tree.
+// </parameter>
+BinTree::BinTree(bool balanced)
+{
+	root = nullptr;
+	this->balanced = balanced;
+	pool = make_shared<NodePool<Node>>();
+}
+
+///////////////////// Pool Constructor ////////////////////
+// <summary>
+// Constructor for class BinTree. Creates an empty tree that takes its
+// nodes from pool, so trees built and torn down together can share one
+// arena.
+// </summary>
+// <parameter = "balanced">
+// True to rebalance on insert, false for a plain binary search tree.
+// </parameter>
+// <parameter = "pool">
+// Pool to allocate nodes from, or nullptr for one of the tree's own.
+// </parameter>
+BinTree::BinTree(bool balanced, shared_ptr<Pool> pool)
+{
+	root = nullptr;
+	this->balanced = balanced;
+	this->pool = (pool != nullptr) ? pool : make_shared<Pool>();
 }
 
 //////////////////// Copy Constructor /////////////////////
@@ -35,6 +83,8 @@ BinTree::BinTree()
 // </parameter>
 BinTree::BinTree(const BinTree& obj)
 {
+	balanced = obj.balanced;
+	pool = make_shared<NodePool<Node>>();
 	assign(root, obj.root);
 }
 
@@ -67,39 +117,153 @@ bool BinTree::isEmpty() const
 	}
 }
 
+////////////////////// Is Balanced ////////////////////////
+// <summary>
+// Function that checks whether the current BinTree rebalances on insert.
+// </summary>
+// <returns>
+// Returns true if the BinTree was constructed in balanced mode.
+// </returns>
+bool BinTree::isBalanced() const
+{
+	return balanced;
+}
+
+//////////////////////// Get Pool /////////////////////////
+// <summary>
+// Function to get the pool BinTree takes its nodes from, for building
+// another tree on the same arena.
+// </summary>
+// <returns>
+// Returns the pool, never nullptr.
+// </returns>
+shared_ptr<BinTree::Pool> BinTree::getPool() const
+{
+	return pool;
+}
+
+///////////////////// Set Parallelism /////////////////////
+// <summary>
+// Sets the number of threads that copying, comparing and emptying a tree
+// of at least PARALLEL_CUTOFF nodes use, for every BinTree. 0 restores the
+// default of one per hardware thread; negative values are taken as 0.
+// </summary>
+void BinTree::setParallelism(int workers)
+{
+	parallelism = (workers > 0) ? workers : 0;
+}
+
+////////////////////////// Size ///////////////////////////
+// <summary>
+// Function to get the number of data stored in BinTree. Read from the
+// subtree size kept in the root, so it costs O(1) and can be used to size
+// an export buffer.
+// </summary>
+// <returns>
+// Returns the number of nodes in BinTree.
+// </returns>
+int BinTree::size() const
+{
+	return Links::size(root);
+}
+
 /////////////////////// Make Empty ////////////////////////
 // <summary>
 // Function that empties BinTree. Calls the makeEmpty helper function to
-// individually empty each node in BinTree. isEmpty returns true when called
-// on a BinTree directly after this function.
+// delete the data held by each node, then releases every node back to the
+// pool at once, or one at a time if another tree shares the pool. isEmpty
+// returns true when called on a BinTree directly after this function.
 // </summary>
 void BinTree::makeEmpty()
 {
+	Node* nodes = root;
 	makeEmpty(root);
+
+	if (pool.use_count() == 1)
+	{
+		pool->releaseAll();
+	}
+	else
+	{
+		preOrder(nodes, [this](Node* current)
+		{
+			pool->release(current);
+		});
+	}
 }
 
 /////////////////// Make Empty Helper /////////////////////
 // <summary>
-// Helper function for makeEmpty function. Individually empties each node in
-// BinTree if not already empty.
+// Helper function for makeEmpty function. Individually deletes the data of
+// each node in BinTree if not already empty. The nodes themselves are left
+// for the pool to reclaim in one step. Uses an explicit stack, so any tree
+// shape is safe. Large trees are split into subtrees that are emptied in
+// parallel.
 // </summary>
 // <parameter = "node">
 // Root node to start emptying BinTree.
 // </parameter>
 void BinTree::makeEmpty(Node* &node)
 {
+	int nodes = Links::size(node);
+	int workers = workerCount(nodes);
+	vector<Node*> stack;
+	vector<Node*> deferred;
+
 	if (node != nullptr)
 	{
-		makeEmpty(node->left);
-		makeEmpty(node->right);
+		stack.push_back(node);
+	}
+
+	if (workers == 1)
+	{
+		deleteSubtrees(stack, 0, nullptr);
+	}
+	else
+	{
+		deleteSubtrees(stack, grainSize(nodes, workers), &deferred);
+		runParallel(static_cast<int>(deferred.size()), workers,
+			[&deferred](int i, int)
+		{
+			vector<Node*> subtree(1, deferred[i]);
+			deleteSubtrees(subtree, 0, nullptr);
+		});
+	}
+
+	node = nullptr;
+}
+
+//////////////////// Delete Subtrees //////////////////////
+// <summary>
+// Helper function for makeEmpty. Deletes the data of the subtrees on
+// stack. When deferred is not nullptr, subtrees of at most grain nodes are
+// moved to it untouched so they can be handed to other threads.
+// </summary>
+void BinTree::deleteSubtrees(vector<Node*> &stack, int grain,
+	vector<Node*>* deferred)
+{
+	while (!stack.empty())
+	{
+		Node* node = stack.back();
+		stack.pop_back();
+
+		if (deferred != nullptr && node->size <= grain)
+		{
+			deferred->push_back(node);
+			continue;
+		}
 
-		if (node->data != nullptr) {
-			delete node->data;
-			node->data = nullptr;
+		if (node->right != nullptr)
+		{
+			stack.push_back(node->right);
+		}
+		if (node->left != nullptr)
+		{
+			stack.push_back(node->left);
 		}
 
-		delete node;
-		node = nullptr;
+		delete node->data;
+		node->data = nullptr;
 	}
 }
 
@@ -113,13 +277,15 @@ void BinTree::makeEmpty(Node* &node)
 // </parameter>
 // <returns>
 // Returns the preceding BinTree that has been modified to contain the same
-// nodes as the right side Bintree object.
+// nodes as the right side Bintree object. The balancing mode of the right
+// side BinTree is copied along with its nodes.
 // </returns>
 BinTree& BinTree::operator=(const BinTree &obj)
 {
-	if (*this != obj)
+	if (this != &obj)
 	{
 		makeEmpty();				// Delete contents of left tree
+		balanced = obj.balanced;
 		assign(root, obj.root);		// Assign left tree with contents of right tree
 	}
 
@@ -128,21 +294,87 @@ BinTree& BinTree::operator=(const BinTree &obj)
 
 //////////////////////// = Helper /////////////////////////
 // <summary>
-// Helper function for the = assignment operator.
+// Helper function for the = assignment operator. Copies the right tree
+// top-down with an explicit stack of pending copy tasks. Large trees are
+// split into subtrees that are copied in parallel, each thread into a pool
+// of its own that the tree's pool then adopts.
 // </summary>
 void BinTree::assign(Node* &leftNode, Node* rightNode)
 {
+	int nodes = Links::size(rightNode);
+	int workers = workerCount(nodes);
+	vector<CopyTask> stack;
+	vector<CopyTask> deferred;
+
+	leftNode = nullptr;
 	if (rightNode != nullptr)
 	{
-		leftNode = new Node();
-		leftNode->data = new NodeData(*rightNode->data);
+		stack.push_back({ &leftNode, nullptr, rightNode });
+	}
 
-		assign(leftNode->left, rightNode->left);
-		assign(leftNode->right, rightNode->right);
+	if (workers == 1)
+	{
+		copySubtrees(stack, *pool, 0, nullptr);
+		return;
 	}
-	else
+
+	copySubtrees(stack, *pool, grainSize(nodes, workers), &deferred);
+
+	// a deque, as pools cannot be moved; adopt needs equal block sizes
+	deque<Pool> pools;
+	for (int i = 0; i < workers; i++)
+	{
+		pools.emplace_back(pool->getBlockSize());
+	}
+
+	runParallel(static_cast<int>(deferred.size()), workers,
+		[&deferred, &pools](int i, int worker)
+	{
+		vector<CopyTask> subtree(1, deferred[i]);
+		copySubtrees(subtree, pools[worker], 0, nullptr);
+	});
+
+	for (Pool &workerPool : pools)
+	{
+		pool->adopt(workerPool);
+	}
+}
+
+///////////////////// Copy Subtrees ///////////////////////
+// <summary>
+// Helper function for assign. Copies the subtrees on stack with nodes
+// from nodes. When deferred is not nullptr, subtrees of at most grain
+// nodes are moved to it uncopied so they can be handed to other threads.
+// </summary>
+void BinTree::copySubtrees(vector<CopyTask> &stack, NodePool<Node> &nodes,
+	int grain, vector<CopyTask>* deferred)
+{
+	while (!stack.empty())
 	{
-		leftNode = nullptr;
+		CopyTask task = stack.back();
+		stack.pop_back();
+
+		if (deferred != nullptr && task.source->size <= grain)
+		{
+			deferred->push_back(task);
+			continue;
+		}
+
+		Node* copy = nodes.allocate();
+		copy->data = new NodeData(*task.source->data);
+		copy->height = task.source->height;
+		copy->size = task.source->size;
+		copy->parent = task.parent;
+		*task.link = copy;
+
+		if (task.source->right != nullptr)
+		{
+			stack.push_back({ &copy->right, copy, task.source->right });
+		}
+		if (task.source->left != nullptr)
+		{
+			stack.push_back({ &copy->left, copy, task.source->left });
+		}
 	}
 }
 
@@ -160,35 +392,99 @@ bool BinTree::operator==(const BinTree &obj) const
 
 //////////////////////// == Helper ////////////////////////
 // <summary>
-// Helper function for the overloaded == comparison operator.
+// Helper function for the overloaded == comparison operator. Walks both trees
+// in lockstep with an explicit stack and stops at the first difference.
+// Subtrees of different sizes differ without being walked. Large trees are
+// split into pairs of subtrees that are compared in parallel; the first
+// thread to find a difference tells the others to stop.
 // </summary>
 // <returns>
 // Returns true if the two BinTrees are identical, returns false otherwise.
 // </returns>
 bool BinTree::equal(Node* leftNode, Node* rightNode) const
 {
-	if (leftNode == nullptr && rightNode == nullptr)
+	int nodes = Links::size(leftNode);
+	int workers = workerCount(nodes);
+	vector<pair<Node*, Node*>> stack;
+	vector<pair<Node*, Node*>> deferred;
+
+	stack.push_back(make_pair(leftNode, rightNode));
+
+	if (workers == 1)
 	{
-		return true;
+		return equalSubtrees(stack, 0, nullptr, nullptr);
 	}
-	else if (leftNode == nullptr || rightNode == nullptr)
+
+	if (!equalSubtrees(stack, grainSize(nodes, workers), &deferred, nullptr))
 	{
 		return false;
 	}
-	else if (*(leftNode->data) == *(rightNode->data)
-			&& leftNode->left == nullptr
-			&& leftNode->right == nullptr
-			&& rightNode->left == nullptr
-			&& rightNode->right == nullptr)
+
+	atomic<bool> differ(false);
+	runParallel(static_cast<int>(deferred.size()), workers,
+		[&deferred, &differ](int i, int)
 	{
-		return true;
-	}
+		vector<pair<Node*, Node*>> subtrees(1, deferred[i]);
+
+		if (!differ.load(memory_order_relaxed)
+			&& !equalSubtrees(subtrees, 0, nullptr, &differ))
+		{
+			differ.store(true, memory_order_relaxed);
+		}
+	});
 
-	bool status = *(leftNode->data) == *(rightNode->data);
-	status &= equal(leftNode->left, rightNode->left);
-	status &= equal(leftNode->right, rightNode->right);;
+	return !differ.load();
+}
 
-	return status;
+//////////////////// Equal Subtrees ///////////////////////
+// <summary>
+// Helper function for equal. Compares the pairs of subtrees on stack.
+// When deferred is not nullptr, pairs of at most grain nodes are moved to
+// it unvisited. Gives up early once stop is set by another thread.
+// </summary>
+// <returns>
+// Returns false at the first difference found, true otherwise.
+// </returns>
+bool BinTree::equalSubtrees(vector<pair<Node*, Node*>> &stack, int grain,
+	vector<pair<Node*, Node*>>* deferred, const atomic<bool>* stop)
+{
+	while (!stack.empty())
+	{
+		Node* leftNode = stack.back().first;
+		Node* rightNode = stack.back().second;
+		stack.pop_back();
+
+		if (leftNode == nullptr && rightNode == nullptr)
+		{
+			continue;
+		}
+		else if (leftNode == nullptr || rightNode == nullptr)
+		{
+			return false;
+		}
+		else if (leftNode->size != rightNode->size)
+		{
+			return false;
+		}
+		else if (stop != nullptr && stop->load(memory_order_relaxed))
+		{
+			return false;
+		}
+		else if (deferred != nullptr && leftNode->size <= grain)
+		{
+			deferred->push_back(make_pair(leftNode, rightNode));
+			continue;
+		}
+		else if (*(leftNode->data) != *(rightNode->data))
+		{
+			return false;
+		}
+
+		stack.push_back(make_pair(leftNode->right, rightNode->right));
+		stack.push_back(make_pair(leftNode->left, rightNode->left));
+	}
+
+	return true;
 }
 
 /////////////////////// != Operator ///////////////////////
@@ -207,7 +503,7 @@ bool BinTree::operator!=(const BinTree &obj) const
 /////////////////////// << Operator ///////////////////////
 // <summary>
 // Function for the overloaded << operator. Prints the BinTree horizontally
-// using inOrder traversal.
+// to out using inOrder traversal, through a TreeWriter buffer.
 // </summary>
 // <returns>
 // Returns the output stream for the correctly formatted BinTree output to be
@@ -215,26 +511,11 @@ bool BinTree::operator!=(const BinTree &obj) const
 // </returns>
 ostream& operator<<(ostream& out, const BinTree& obj)
 {
-	obj.inOrderOut(obj.root);
-	out << endl;
+	TreeWriter writer(out, TreeWriter::IN_ORDER);
+	writer.write(obj);
 	return out;
 }
 
-//////////////////////// << Helper ////////////////////////
-// <summary>
-// Helper function for the overloaded << operator. Prints the BinTree horizontally
-// using inOrder traversal.
-// </summary>
-void BinTree::inOrderOut(Node* obj) const
-{
-	if (obj != nullptr)
-	{
-		inOrderOut(obj->left);
-		cout << *obj->data << " ";
-		inOrderOut(obj->right);
-	}
-}
-
 //////////////////////// Retrieve /////////////////////////
 // <summary>
 // Function to search for the passed data in the BinTree, sets it to
@@ -256,235 +537,1621 @@ bool BinTree::retrieve(const NodeData &data, NodeData* &retrieveData) const
 	return status;
 }
 
-/////////////////////// Get Height ////////////////////////
+///////////////////// Retrieve Batch //////////////////////
 // <summary>
-// Function to get the height of BinTree at the node containing the data
-// parameter.
+// Function to search for count data at once, sets results[i] to the data
+// matching keys[i], or nullptr if it is not in BinTree. Keeps up to 16
+// searches in flight. Each step of a search either prefetches the data of
+// a node it just reached or compares against data prefetched earlier, then
+// moves on to the next search; by the time a search comes around again its
+// load has usually landed. A finished search hands its slot to the next key.
 // </summary>
 // <returns>
-// Returns the integer height of BinTree at the data. Returns 0 if
-// data is not found in BinTree.
+// Returns the number of keys found.
 // </returns>
-int BinTree::getHeight(const NodeData &data) const
+int BinTree::retrieveBatch(const NodeData keys[], int count,
+	NodeData* results[]) const
 {
-	Node* foundPtr = findNode(data, root);
-	return (foundPtr != nullptr) ? getHeight(foundPtr) : 0;
-}
+	const int WIDTH = 16;
 
-//////////////////// Get Height Helper ////////////////////
-// <summary>
-// Helper function to get the height of BinTree at the node containing the data
-// parameter. Increases the return value by 1 for every level after finding the
-// data node.
-// </summary>
-// <returns>
-// Returns the integer height of BinTree at the data until reaching the bottom.
-// </returns>
-int BinTree::getHeight(Node* node) const
-{
-	if (node == nullptr)
+	struct Search
 	{
-		return 0;
+		const Node* node;					// node to read next
+		int key;							// index into keys and results
+		bool ready;							// node->data has been prefetched
+	};
+
+	Search searches[WIDTH];
+	int live = 0;
+	int next = 0;
+	int found = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		results[i] = nullptr;
 	}
 
-	int left = getHeight(node->left);		// search left
-	int right = getHeight(node->right);     // search right
+	if (root == nullptr)
+	{
+		return 0;
+	}
 
-	if (right > left)
+	while (live < WIDTH && next < count)
 	{
-		return right + 1;
+		prefetch(&keys[next]);
+		searches[live++] = Search{root, next++, false};
 	}
-	else
+
+	while (live > 0)
 	{
-		return left + 1;
+		for (int s = 0; s < live; s++)
+		{
+			Search &search = searches[s];
+
+			if (!search.ready)
+			{
+				prefetch(search.node->data);
+				search.ready = true;
+				continue;
+			}
+
+			int order = keys[search.key].compare(*(search.node->data));
+
+			if (order != 0)
+			{
+				search.node = (order < 0) ? search.node->left
+					: search.node->right;
+			}
+			else
+			{
+				results[search.key] = search.node->data;
+				found++;
+				search.node = nullptr;
+			}
+
+			if (search.node != nullptr)
+			{
+				prefetch(search.node);
+				search.ready = false;
+			}
+			else if (next < count)
+			{
+				prefetch(&keys[next]);
+				search = Search{root, next++, false};
+			}
+			else
+			{
+				searches[s--] = searches[--live];
+			}
+		}
 	}
+
+	return found;
 }
 
-//////////////////// Find Node Helper ////////////////////
+#if __cplusplus >= 202002L
+///////////////////// Retrieve Batch //////////////////////
 // <summary>
-// Helper function to find the node in BinTree containing the passed data.
-// Called by retrieve and getHeight.
+// Function to search for every data in keys at once, same as the array
+// version above.
 // </summary>
 // <returns>
-// Returns the found node in BinTree.
+// Returns the number of keys found, or -1 with nothing written if results
+// is shorter than keys.
 // </returns>
-BinTree::Node* BinTree::findNode(const NodeData &data, Node* node) const
+int BinTree::retrieveBatch(span<const NodeData> keys,
+	span<NodeData*> results) const
 {
-	if (node == nullptr)
-	{
-		return nullptr;
-	}
-	else if (data == *(node->data))
+	if (results.size() < keys.size())
 	{
-		return node;
+		return -1;
 	}
 
-	Node* leftPtr = findNode(data, node->left);		 // search left
-	Node* rightPtr = findNode(data, node->right);    // search right
-
-	return (leftPtr != nullptr) ? leftPtr : rightPtr;
+	return retrieveBatch(keys.data(), static_cast<int>(keys.size()),
+		results.data());
 }
+#endif
 
-/////////////// Binary Search Tree to Array ///////////////
+/////////////////////// Get Height ////////////////////////
 // <summary>
-// Converts BinTree to array.
+// Function to get the height of BinTree at the node containing the data
+// parameter. Each node stores the height of its subtree, kept up to date by
+// insert, so this costs one search and no walk of the subtree.
 // </summary>
-void BinTree::bstreeToArray(NodeData* arr[])
+// <returns>
+// Returns the integer height of BinTree at the data. Returns 0 if
+// data is not found in BinTree.
+// </returns>
+int BinTree::getHeight(const NodeData &data) const
 {
-	int index = 0;
-	inOrderBstArr(arr, root, index);
-	makeEmpty();
+	return Links::height(findNode(data, root));
 }
 
-/////////// Binary Search Tree to Array Helper ////////////
+//////////////////// Find Node Helper ////////////////////
 // <summary>
-// Helper function for bstreeToArray.
+// Helper function to find the node in BinTree containing the passed data.
+// Descends left or right by comparing against each node, so the search
+// costs the depth of the tree rather than its size. Called by retrieve and
+// getHeight.
 // </summary>
-void BinTree::inOrderBstArr(NodeData* arr[], Node* obj, int& index)
+// <returns>
+// Returns the found node in BinTree.
+// </returns>
+BinTree::Node* BinTree::findNode(const NodeData &data, Node* node) const
 {
-	if (obj != nullptr)
+	while (node != nullptr)
 	{
-		inOrderBstArr(arr, obj->left, index);
-		NodeData* newData = obj->data;
-		obj->data = nullptr;
-		arr[index++] = newData;
-		newData = nullptr;
-		inOrderBstArr(arr, obj->right, index);
+		int order = data.compare(*(node->data));
+
+		if (order == 0)
+		{
+			return node;
+		}
+
+		node = (order < 0) ? node->left : node->right;
 	}
+
+	return nullptr;
 }
 
-/////////////// Array to Binary Search Tree ///////////////
+////////////////////// Lower Bound ////////////////////////
 // <summary>
-// Converts array to BinTree.
+// Function to find the smallest data in BinTree that is not less than the
+// passed data, sets it to foundData if found. Follows the BST ordering, so
+// only a single root-to-leaf path is visited.
 // </summary>
-void BinTree::arrayToBSTree(NodeData* arr[])
+// <returns>
+// Returns true if such data exists and is set, false otherwise.
+// </returns>
+bool BinTree::lowerBound(const NodeData &data, NodeData* &foundData) const
 {
-	makeEmpty();
+	Node* foundPtr = ceilingNode(data, true);
 
-	int arrSize = 0;
-	for (arrSize = 0; arrSize < 100; arrSize++) {
-		if (arr[arrSize] == nullptr)
-			break;
+	if (foundPtr == nullptr)
+	{
+		return false;
 	}
 
-	inOrderArrBst(arr, 0, arrSize - 1);
+	foundData = foundPtr->data;
+	return true;
 }
 
-/////////// Array to Binary Search Tree Helper ////////////
+////////////////////// Upper Bound ////////////////////////
 // <summary>
-// Helper function for arrayToBSTree.
+// Function to find the smallest data in BinTree that is strictly greater
+// than the passed data, sets it to foundData if found.
 // </summary>
-void BinTree::inOrderArrBst(NodeData* arr[], int min, int max)
+// <returns>
+// Returns true if such data exists and is set, false otherwise.
+// </returns>
+bool BinTree::upperBound(const NodeData &data, NodeData* &foundData) const
 {
-	if (min > max)
+	Node* foundPtr = ceilingNode(data, false);
+
+	if (foundPtr == nullptr)
 	{
-		return;
+		return false;
 	}
 
-	int mid = (min + max) / 2;
-	insert(arr[mid]);
-	arr[mid] = nullptr;
-
-	inOrderArrBst(arr, min, mid - 1);
-	inOrderArrBst(arr, mid + 1, max);
+	foundData = foundPtr->data;
+	return true;
 }
 
-//////////////////////// Insert ///////////////////////////
+///////////////////////// Floor ///////////////////////////
 // <summary>
-// Inserts a node to BinTree in the appropriate location based on its NodeData.
-// Duplicate nodes are not inserted.
+// Function to find the largest data in BinTree that is less than or equal
+// to the passed data, sets it to foundData if found.
 // </summary>
 // <returns>
-// Returns the true if the insert was successful, false if unsuccessful.
+// Returns true if such data exists and is set, false otherwise.
 // </returns>
-bool BinTree::insert(NodeData* obj)
+bool BinTree::floor(const NodeData &data, NodeData* &foundData) const
 {
-	bool status = false;
+	Node* foundPtr = floorNode(data, true);
 
-	if (root == nullptr)
+	if (foundPtr == nullptr)
 	{
-		Node* newRoot = new Node();
-		newRoot->data = obj;
-		root = newRoot;
-		status = true;
-	}
-	else
-	{
-		status = insert(root, obj);
+		return false;
 	}
 
-	return status;
+	foundData = foundPtr->data;
+	return true;
 }
 
-///////////////////// Insert Helper ///////////////////////
+//////////////////////// Ceiling //////////////////////////
 // <summary>
-// Helper function for insert.
+// Function to find the smallest data in BinTree that is greater than or
+// equal to the passed data, sets it to foundData if found. Same result as
+// lowerBound.
 // </summary>
 // <returns>
-// Returns the true if the insert was successful, false if unsuccessful.
+// Returns true if such data exists and is set, false otherwise.
 // </returns>
-bool BinTree::insert(Node* node, NodeData* obj)
+bool BinTree::ceiling(const NodeData &data, NodeData* &foundData) const
 {
-	if (*obj <= *(node->data))
+	return lowerBound(data, foundData);
+}
+
+/////////////////// Ceiling Node Helper ///////////////////
+// <summary>
+// Helper function for lowerBound, upperBound and ceiling. Finds the node
+// with the smallest data greater than the passed data, or equal to it when
+// inclusive is true.
+// </summary>
+// <returns>
+// Returns the found node, nullptr if no such node exists.
+// </returns>
+BinTree::Node* BinTree::ceilingNode(const NodeData &data, bool inclusive) const
+{
+	Node* best = nullptr;
+	Node* node = root;
+
+	while (node != nullptr)
 	{
-		if (*obj == *(node->data))
-		{
-			return false;
-		}
-		else if (node->left == nullptr)
-		{
-			Node* newNode = new Node();
-			newNode->data = obj;
-			node->left = newNode;
+		int order = data.compare(*(node->data));
 
-			return true;
+		if (order < 0 || (inclusive && order == 0))
+		{
+			best = node;				// candidate, look for a smaller one
+			node = node->left;
 		}
 		else
 		{
-			return insert(node->left, obj);
+			node = node->right;
 		}
 	}
-	else
-	{
-		if (node->right == nullptr)
+
+	return best;
+}
+
+//////////////////// Floor Node Helper ////////////////////
+// <summary>
+// Helper function for floor. Finds the node with the largest data less than
+// the passed data, or equal to it when inclusive is true.
+// </summary>
+// <returns>
+// Returns the found node, nullptr if no such node exists.
+// </returns>
+BinTree::Node* BinTree::floorNode(const NodeData &data, bool inclusive) const
+{
+	Node* best = nullptr;
+	Node* node = root;
+
+	while (node != nullptr)
+	{
+		int order = data.compare(*(node->data));
+
+		if (order > 0 || (inclusive && order == 0))
+		{
+			best = node;				// candidate, look for a larger one
+			node = node->right;
+		}
+		else
 		{
-			Node* newNode = new Node();
-			newNode->data = obj;
-			node->right = newNode;
+			node = node->left;
+		}
+	}
+
+	return best;
+}
+
+////////////////////////// Rank ///////////////////////////
+// <summary>
+// Function to find the position the passed data has, or would have, in
+// the sorted order of BinTree. Uses the subtree sizes kept in each node,
+// so only one root-to-leaf path is visited.
+// </summary>
+// <returns>
+// Returns the number of data in BinTree less than the passed data.
+// </returns>
+int BinTree::rank(const NodeData &data) const
+{
+	return countLess(data, false);
+}
+
+///////////////////////// Select //////////////////////////
+// <summary>
+// Function to find the data at position k of the sorted order of BinTree,
+// counting from 0, sets it to foundData if found.
+// </summary>
+// <returns>
+// Returns true if 0 <= k < size() and the data is set, false otherwise.
+// </returns>
+bool BinTree::select(int k, NodeData* &foundData) const
+{
+	if (k < 0 || k >= size())
+	{
+		return false;
+	}
+
+	Node* node = root;
+
+	for (;;)
+	{
+		int leftSize = Links::size(node->left);
 
+		if (k < leftSize)
+		{
+			node = node->left;
+		}
+		else if (k == leftSize)
+		{
+			foundData = node->data;
 			return true;
 		}
 		else
 		{
-			return insert(node->right, obj);
+			k -= leftSize + 1;
+			node = node->right;
 		}
 	}
 }
 
-//------------------------- displaySideways ---------------------------------
-// Displays a binary tree as though you are viewing it from the side;
-// hard coded displaying to standard output.
-// Preconditions: NONE
-// Postconditions: BinTree remains unchanged.
-void BinTree::displaySideways() const {
-	sideways(root, 0);
+////////////////////// Count Range ////////////////////////
+// <summary>
+// Function to count the data in BinTree between low and high, inclusive,
+// without visiting them.
+// </summary>
+// <returns>
+// Returns the number of data d with low <= d <= high, 0 if high < low.
+// </returns>
+int BinTree::countRange(const NodeData &low, const NodeData &high) const
+{
+	if (high < low)
+	{
+		return 0;
+	}
+
+	return countLess(high, true) - countLess(low, false);
 }
 
-//---------------------------- Sideways -------------------------------------
-// Helper method for displaySideways
-// Preconditions: NONE
-// Postconditions: BinTree remains unchanged.
-void BinTree::sideways(Node* current, int level) const {
-	if (current != nullptr) {
-		level++;
-		sideways(current->right, level);
+/////////////// Binary Search Tree to Array ///////////////
+// <summary>
+// Converts BinTree to array.
+// </summary>
+void BinTree::bstreeToArray(NodeData* arr[])
+{
+	extractTo(arr);
+}
+
+/////////////// Binary Search Tree to Array ///////////////
+// <summary>
+// Bounded version of bstreeToArray. Moves the data of BinTree into arr in
+// sorted order and empties BinTree, but only if all of it fits.
+// </summary>
+// <parameter = "capacity">
+// Number of elements arr can hold.
+// </parameter>
+// <returns>
+// Returns the number of data moved into arr, or -1 if capacity is smaller
+// than size(), in which case BinTree and arr are left unchanged.
+// </returns>
+int BinTree::bstreeToArray(NodeData* arr[], int capacity)
+{
+	if (capacity < size())
+	{
+		return -1;
+	}
+
+	return static_cast<int>(extractTo(arr) - arr);
+}
+
+/////////////// Array to Binary Search Tree ///////////////
+// <summary>
+// Converts array to BinTree. Reads at most 100 elements, stopping at the
+// first nullptr.
+// </summary>
+void BinTree::arrayToBSTree(NodeData* arr[])
+{
+	int arrSize = 0;
+	for (arrSize = 0; arrSize < 100; arrSize++) {
+		if (arr[arrSize] == nullptr)
+			break;
+	}
+
+	arrayToBSTree(arr, arrSize);
+}
+
+/////////////// Array to Binary Search Tree ///////////////
+// <summary>
+// Converts the first arrSize elements of an array to BinTree, with no
+// limit on arrSize. BinTree takes ownership of the data, deleting repeated
+// data, and the array entries are set to nullptr. Sorted input is linked
+// by bulkLoad in O(n). Other input is inserted one midpoint at a time, in
+// the order the original build used, so the tree is always a valid BST.
+// </summary>
+void BinTree::arrayToBSTree(NodeData* arr[], int arrSize)
+{
+	if (bulkLoad(arr, arrSize, true) >= 0)
+	{
+		return;
+	}
 
-		// indent for readability, 4 spaces per depth level 
-		for (int i = level; i >= 0; i--) {
-			cout << "    ";
+	makeEmpty();
+
+	vector<pair<int, int>> ranges;
+	ranges.push_back(make_pair(0, arrSize - 1));
+
+	while (!ranges.empty())
+	{
+		int min = ranges.back().first;
+		int max = ranges.back().second;
+		ranges.pop_back();
+
+		if (min > max)
+		{
+			continue;
+		}
+
+		int mid = (min + max) / 2;
+		if (!insert(arr[mid]))
+		{
+			delete arr[mid];					// duplicate, not inserted
+		}
+		arr[mid] = nullptr;
+
+		ranges.push_back(make_pair(mid + 1, max));
+		ranges.push_back(make_pair(min, mid - 1));
+	}
+}
+
+//////////////////////// Bulk Load ////////////////////////
+// <summary>
+// Replaces the contents of BinTree with the first arrSize elements of a
+// sorted array, linking the nodes directly into a height-balanced shape in
+// O(n) with no comparisons. BinTree takes ownership of the data and the
+// array entries are set to nullptr.
+// </summary>
+// <parameter = "validate">
+// When true, the input is first checked to be in nondecreasing order, and
+// repeated data is deleted so each value is kept once. When false, the
+// input must already be strictly increasing.
+// </parameter>
+// <returns>
+// Returns the number of nodes in BinTree afterwards, or -1 if validate is
+// true and the input is out of order, in which case nothing is changed
+// and the caller keeps ownership of the data.
+// </returns>
+int BinTree::bulkLoad(NodeData* arr[], int arrSize, bool validate)
+{
+	if (validate)
+	{
+		for (int i = 1; i < arrSize; i++)
+		{
+			if (*arr[i] < *arr[i - 1])
+			{
+				return -1;
+			}
+		}
+
+		int kept = 0;
+		for (int i = 0; i < arrSize; i++)
+		{
+			if (kept > 0 && *arr[i] == *arr[kept - 1])
+			{
+				delete arr[i];					// duplicate, not inserted
+			}
+			else
+			{
+				arr[kept++] = arr[i];
+			}
+		}
+		for (int i = kept; i < arrSize; i++)
+		{
+			arr[i] = nullptr;
 		}
+		arrSize = kept;
+	}
+
+	makeEmpty();
+	root = inOrderArrBst(arr, 0, arrSize - 1, nullptr);
+
+	return size();
+}
 
-		cout << *current->data << endl;        // display information of object
-		sideways(current->left, level);
+/////////// Array to Binary Search Tree Helper ////////////
+// <summary>
+// Helper function for arrayToBSTree and bulkLoad. Links arr[low..high]
+// into a subtree rooted at the middle element and sets its heights and
+// parent pointers. Recursion depth is logarithmic in the array size.
+// </summary>
+// <returns>
+// Returns the root of the new subtree, nullptr if the range is empty.
+// </returns>
+BinTree::Node* BinTree::inOrderArrBst(NodeData* arr[], int min, int max,
+	Node* parent)
+{
+	if (min > max)
+	{
+		return nullptr;
+	}
+
+	int mid = min + (max - min) / 2;
+	Node* node = pool->allocate();
+	node->data = arr[mid];
+	node->parent = parent;
+	arr[mid] = nullptr;
+
+	node->left = inOrderArrBst(arr, min, mid - 1, node);
+	node->right = inOrderArrBst(arr, mid + 1, max, node);
+	Links::update(node);
+
+	return node;
+}
+
+///////////////////////// Remove ////////////////////////
+// <summary>
+// Removes the node containing the passed data from BinTree and deletes
+// its data. Rebalances on the way back up in balanced mode.
+// </summary>
+// <returns>
+// Returns true if the data was found and removed, false otherwise.
+// </returns>
+bool BinTree::remove(const NodeData &data)
+{
+	NodeData* removed = extract(data);
+
+	if (removed == nullptr)
+	{
+		return false;
+	}
+
+	delete removed;
+	return true;
+}
+
+///////////////////////// Extract ///////////////////////////
+// <summary>
+// Removes the node containing the passed data from BinTree without
+// deleting its data. Ownership of the data passes to the caller.
+// </summary>
+// <returns>
+// Returns the data that was in BinTree, nullptr if it was not found.
+// </returns>
+NodeData* BinTree::extract(const NodeData &data)
+{
+	Node* foundPtr = findNode(data, root);
+
+	if (foundPtr == nullptr)
+	{
+		return nullptr;
+	}
+
+	NodeData* removed = foundPtr->data;
+	Links::unlink(foundPtr, root, balanced);
+	pool->release(foundPtr);
+
+	return removed;
+}
+
+////////////////////// Remove Range ///////////////////////
+// <summary>
+// Removes and deletes all data between low and high, inclusive. The tree
+// is split around the range and the two outer pieces are joined back
+// together, so in balanced mode this costs O(log n + k) for k removed data.
+// </summary>
+// <returns>
+// Returns the number of data removed.
+// </returns>
+int BinTree::removeRange(const NodeData &low, const NodeData &high)
+{
+	if (high < low)
+	{
+		return 0;
+	}
+
+	Node* less = nullptr;
+	Node* rest = nullptr;
+	Node* middle = nullptr;
+	Node* greater = nullptr;
+
+	split(root, low, false, less, rest);
+	split(rest, high, true, middle, greater);
+
+	int removed = Links::size(middle);
+	preOrder(middle, [this](Node* current)
+	{
+		delete current->data;
+		pool->release(current);
+	});
+
+	root = join(less, greater);
+	return removed;
+}
+
+/////////////////////// Union With ////////////////////////
+// <summary>
+// Adds every data of other to BinTree and leaves other empty. Nodes of
+// other are relinked, not copied; where both trees hold equal data the
+// data already in BinTree is kept and other's is deleted. When both trees
+// are balanced this is join-based, costing O(m log(n/m + 1)) for sizes
+// m <= n, and large inputs are split across threads; otherwise the two
+// sorted sequences are merged in O(n + m).
+// </summary>
+// <parameter = "other">
+// Tree whose data is moved into BinTree.
+// </parameter>
+void BinTree::unionWith(BinTree &&other)
+{
+	setOperation(UNION, other);
+}
+
+///////////////////// Intersect With //////////////////////
+// <summary>
+// Keeps only the data of BinTree that other also holds, deletes the
+// rest, and leaves other empty. Same costs as unionWith.
+// </summary>
+void BinTree::intersectWith(BinTree &&other)
+{
+	setOperation(INTERSECTION, other);
+}
+
+///////////////////// Difference With /////////////////////
+// <summary>
+// Removes from BinTree every data that other holds and leaves other
+// empty. Same costs as unionWith.
+// </summary>
+void BinTree::differenceWith(BinTree &&other)
+{
+	setOperation(DIFFERENCE, other);
+}
+
+//////////////////////// Split Off ////////////////////////
+// <summary>
+// Moves every data not less than key from BinTree into greater, whose old
+// contents are deleted first. greater then shares BinTree's pool, since
+// the nodes it receives were allocated there.
+// </summary>
+// <parameter = "greater">
+// Tree that receives the data greater than or equal to key.
+// </parameter>
+void BinTree::splitOff(const NodeData &key, BinTree &greater)
+{
+	if (&greater == this)
+	{
+		return;
+	}
+
+	greater.makeEmpty();
+	greater.balanced = balanced;
+	greater.pool = pool;
+
+	Node* less = nullptr;
+	split(root, key, false, less, greater.root);
+	root = less;
+}
+
+//////////////////////// Join With ////////////////////////
+// <summary>
+// Appends the data of greater to BinTree and leaves greater empty. When
+// all of greater's data is larger than BinTree's this relinks the two
+// trees in O(log n) when balanced; otherwise it falls back to unionWith.
+// A plain greater joined into a balanced BinTree is first relinked into a
+// height-balanced shape in O(m), so the result stays AVL-balanced.
+// </summary>
+// <parameter = "greater">
+// Tree whose data is moved into BinTree.
+// </parameter>
+void BinTree::joinWith(BinTree &&greater)
+{
+	if (&greater == this || greater.root == nullptr)
+	{
+		return;
+	}
+
+	if (root != nullptr
+		&& *rightmost(root)->data >= *leftmost(greater.root)->data)
+	{
+		unionWith(move(greater));
+		return;
+	}
+
+	bool reshape = balanced && !greater.balanced;
+	Node* taken = takeNodes(greater);
+
+	if (reshape)
+	{
+		vector<Node*> nodes;
+		inOrder(taken, [&nodes](Node* current) { nodes.push_back(current); });
+		taken = linkSorted(nodes, 0, static_cast<int>(nodes.size()) - 1,
+			nullptr);
 	}
-};
\ No newline at end of file
+
+	root = join(root, taken);
+}
+
+//////////////////////// Insert ///////////////////////////
+// <summary>
+// Inserts a node to BinTree in the appropriate location based on its NodeData.
+// Duplicate nodes are not inserted.
+// </summary>
+// <returns>
+// Returns the true if the insert was successful, false if unsuccessful.
+// </returns>
+bool BinTree::insert(NodeData* obj)
+{
+	return insert(root, obj);
+}
+
+///////////////////// Insert Helper ///////////////////////
+// <summary>
+// Helper function for insert. Walks down from node recording each link on
+// the path, creates the node at the empty link it reaches, then walks the
+// path back up updating heights (rebalancing in balanced mode) until a
+// subtree height stops changing. Subtree sizes are incremented all the way
+// to the root.
+// </summary>
+// <returns>
+// Returns the true if the insert was successful, false if unsuccessful.
+// </returns>
+bool BinTree::insert(Node* &node, NodeData* obj)
+{
+	Node** link = &node;
+	insertPath.clear();
+
+	while (*link != nullptr)
+	{
+		Node* current = *link;
+
+		int order = obj->compare(*(current->data));
+
+		if (order == 0)
+		{
+			return false;
+		}
+
+		insertPath.push_back(link);
+		link = (order < 0) ? &current->left : &current->right;
+	}
+
+	*link = pool->allocate();
+	(*link)->data = obj;
+	(*link)->parent = insertPath.empty() ? nullptr : *insertPath.back();
+	(*link)->height = 1;
+	(*link)->size = 1;
+
+	bool heightChanged = true;
+	while (!insertPath.empty())
+	{
+		Node* &current = *insertPath.back();
+		insertPath.pop_back();
+
+		if (!heightChanged)
+		{
+			current->size++;					// only the size is affected
+			continue;
+		}
+
+		int oldHeight = current->height;
+		Links::update(current);
+
+		if (balanced)
+		{
+			Links::rebalance(current);
+		}
+		heightChanged = (current->height != oldHeight);
+	}
+
+	return true;
+}
+
+////////////////////// Worker Count ///////////////////////
+// <summary>
+// Helper function that picks the number of threads for a whole-tree job.
+// </summary>
+// <returns>
+// Returns 1 below PARALLEL_CUTOFF nodes, otherwise the number set by
+// setParallelism or, by default, the number of hardware threads.
+// </returns>
+int BinTree::workerCount(int nodes)
+{
+	if (nodes < PARALLEL_CUTOFF)
+	{
+		return 1;
+	}
+
+	int workers = parallelism;
+
+	if (workers > 0)
+	{
+		return workers;
+	}
+
+	unsigned int threads = thread::hardware_concurrency();
+	return (threads > 1) ? static_cast<int>(threads) : 1;
+}
+
+/////////////////////// Grain Size ////////////////////////
+// <summary>
+// Helper function that picks the largest subtree to hand out as one
+// piece of work, aiming at eight pieces per worker so that threads that
+// finish early can take more.
+// </summary>
+int BinTree::grainSize(int nodes, int workers)
+{
+	return nodes / (8 * workers) + 1;
+}
+
+//////////////////////// Prefetch /////////////////////////
+// <summary>
+// Helper function that hints the CPU to start loading address into cache.
+// Does nothing on compilers without the builtin.
+// </summary>
+void BinTree::prefetch(const void* address)
+{
+#if defined(__GNUC__)
+	__builtin_prefetch(address);
+#else
+	(void)address;
+#endif
+}
+
+////////////////////// Leftmost Node //////////////////////
+// <summary>
+// Helper function that finds the node with the smallest data in the
+// subtree at node.
+// </summary>
+// <returns>
+// Returns the leftmost node, nullptr for an empty subtree.
+// </returns>
+BinTree::Node* BinTree::leftmost(Node* node)
+{
+	while (node != nullptr && node->left != nullptr)
+	{
+		node = node->left;
+	}
+
+	return node;
+}
+
+///////////////////// Rightmost Node //////////////////////
+// <summary>
+// Helper function that finds the node with the largest data in the
+// subtree at node.
+// </summary>
+// <returns>
+// Returns the rightmost node, nullptr for an empty subtree.
+// </returns>
+BinTree::Node* BinTree::rightmost(Node* node)
+{
+	while (node != nullptr && node->right != nullptr)
+	{
+		node = node->right;
+	}
+
+	return node;
+}
+
+////////////////////// Count Less /////////////////////////
+// <summary>
+// Helper function for rank and countRange. Counts the data in BinTree
+// less than the passed data, or less than or equal to it when inclusive
+// is true, by summing left subtree sizes along one root-to-leaf path.
+// </summary>
+// <returns>
+// Returns the number of such data.
+// </returns>
+int BinTree::countLess(const NodeData &data, bool inclusive) const
+{
+	int less = 0;
+	Node* node = root;
+
+	while (node != nullptr)
+	{
+		int order = node->data->compare(data);
+
+		if (order < 0 || (inclusive && order == 0))
+		{
+			less += Links::size(node->left) + 1;	// node and its left subtree
+			node = node->right;
+		}
+		else
+		{
+			node = node->left;
+		}
+	}
+
+	return less;
+}
+
+////////////////////////// Join ///////////////////////////
+// <summary>
+// Helper function that joins two standalone trees and a middle node into
+// one tree, given every data in left < mid < every data in right. In
+// balanced mode mid is hung on the spine of the taller tree at the height
+// of the shorter one and rebalanced, costing O(|height difference| + 1);
+// otherwise mid simply becomes the root.
+// </summary>
+// <returns>
+// Returns the root of the joined tree.
+// </returns>
+BinTree::Node* BinTree::join(Node* left, Node* mid, Node* right)
+{
+	int leftHeight = Links::height(left);
+	int rightHeight = Links::height(right);
+	Node* top = nullptr;
+	Node* parent = nullptr;
+
+	if (balanced && leftHeight > rightHeight + 1)
+	{
+		top = left;								// descend the right spine of left
+		while (Links::height(left) > rightHeight + 1)
+		{
+			parent = left;
+			left = left->right;
+		}
+	}
+	else if (balanced && rightHeight > leftHeight + 1)
+	{
+		top = right;							// descend the left spine of right
+		while (Links::height(right) > leftHeight + 1)
+		{
+			parent = right;
+			right = right->left;
+		}
+	}
+
+	mid->left = left;
+	mid->right = right;
+	mid->parent = parent;
+	if (left != nullptr)
+	{
+		left->parent = mid;
+	}
+	if (right != nullptr)
+	{
+		right->parent = mid;
+	}
+	Links::update(mid);
+
+	if (parent == nullptr)
+	{
+		return mid;
+	}
+
+	if (leftHeight > rightHeight)				// mid hangs off the right spine
+	{
+		parent->right = mid;
+	}
+	else
+	{
+		parent->left = mid;
+	}
+	Links::retrace(parent, top, balanced);
+
+	return top;
+}
+
+///////////////////////// Join Two ////////////////////////
+// <summary>
+// Helper function that joins two standalone trees with every data in left
+// less than every data in right, using the smallest node of right as the
+// middle node.
+// </summary>
+// <returns>
+// Returns the root of the joined tree.
+// </returns>
+BinTree::Node* BinTree::join(Node* left, Node* right)
+{
+	if (right == nullptr)
+	{
+		return left;
+	}
+
+	Node* mid = leftmost(right);
+	Links::unlink(mid, right, balanced);
+
+	return join(left, mid, right);
+}
+
+////////////////////////// Split //////////////////////////
+// <summary>
+// Helper function that splits the standalone tree at node into the data
+// less than key (also equal to it when inclusive is true) and the rest.
+// Walks one path down and joins the pieces back up it, so in balanced
+// mode this costs O(log n). The tree at node is consumed.
+// </summary>
+void BinTree::split(Node* node, const NodeData &key, bool inclusive,
+	Node* &left, Node* &right)
+{
+	vector<Node*> path;
+
+	while (node != nullptr)
+	{
+		path.push_back(node);
+		int order = node->data->compare(key);
+		node = (order < 0 || (inclusive && order == 0)) ? node->right : node->left;
+	}
+
+	left = nullptr;
+	right = nullptr;
+
+	while (!path.empty())
+	{
+		node = path.back();
+		path.pop_back();
+
+		// the child on the path has already been split into left and right;
+		// the other child is still whole and becomes a standalone tree
+		int order = node->data->compare(key);
+
+		if (order < 0 || (inclusive && order == 0))
+		{
+			Node* leftChild = node->left;
+			if (leftChild != nullptr)
+			{
+				leftChild->parent = nullptr;
+			}
+			left = join(leftChild, node, left);
+		}
+		else
+		{
+			Node* rightChild = node->right;
+			if (rightChild != nullptr)
+			{
+				rightChild->parent = nullptr;
+			}
+			right = join(right, node, rightChild);
+		}
+	}
+
+	if (left != nullptr)
+	{
+		left->parent = nullptr;
+	}
+	if (right != nullptr)
+	{
+		right->parent = nullptr;
+	}
+}
+
+//////////////////////// Set Helper ///////////////////////
+// <summary>
+// Helper function for the set operations. Takes the data of other into
+// BinTree's pool, then combines the two trees with operation and makes
+// the result the new root. Nodes dropped along the way are released once
+// every thread is done, since the pool is not thread-safe.
+// </summary>
+void BinTree::setOperation(SetOperation operation, BinTree &other)
+{
+	if (&other == this)
+	{
+		if (operation == DIFFERENCE)
+		{
+			makeEmpty();
+		}
+		return;
+	}
+
+	bool joinBased = balanced && other.balanced;
+	Node* b = takeNodes(other);
+	vector<Node*> dropped;
+	int workers = workerCount(Links::size(root) + Links::size(b));
+	int forks = 0;
+
+	while ((1 << forks) < workers)
+	{
+		forks++;
+	}
+
+	root = joinBased ? combine(operation, root, b, dropped, forks)
+		: mergeLinear(operation, root, b, dropped);
+
+	for (Node* node : dropped)
+	{
+		pool->release(node);
+	}
+}
+
+//////////////////////// Take Nodes ///////////////////////
+// <summary>
+// Helper function that empties other and makes its nodes BinTree's. The
+// nodes keep their addresses when other's pool can be adopted whole, and
+// are moved to BinTree's pool one at a time when another tree or caller
+// holds it or its block size differs.
+// </summary>
+// <returns>
+// Returns the root of other's former nodes.
+// </returns>
+BinTree::Node* BinTree::takeNodes(BinTree &other)
+{
+	Node* taken = other.root;
+	other.root = nullptr;
+
+	if (other.pool == pool)
+	{
+		return taken;
+	}
+
+	if (other.pool.use_count() == 1
+		&& other.pool->getBlockSize() == pool->getBlockSize())
+	{
+		pool->adopt(*other.pool);
+		return taken;
+	}
+
+	vector<CopyTask> stack;
+	Node* moved = nullptr;
+
+	if (taken != nullptr)
+	{
+		stack.push_back({ &moved, nullptr, taken });
+	}
+
+	while (!stack.empty())
+	{
+		CopyTask task = stack.back();
+		stack.pop_back();
+
+		Node* copy = pool->allocate();
+		*copy = *task.source;
+		copy->parent = task.parent;
+		*task.link = copy;
+		other.pool->release(task.source);
+
+		if (copy->right != nullptr)
+		{
+			stack.push_back({ &copy->right, copy, copy->right });
+		}
+		if (copy->left != nullptr)
+		{
+			stack.push_back({ &copy->left, copy, copy->left });
+		}
+	}
+
+	return moved;
+}
+
+///////////////////////// Combine /////////////////////////
+// <summary>
+// Helper function for the set operations on two standalone balanced
+// trees. Splits a around the root of b, combines the two pairs of halves
+// (on a new thread for one of them while forks is above 0 and the input
+// is large), and joins the results around b's root or its equal in a.
+// Recursion depth is the height of b. Nodes no longer needed are added to
+// dropped with their data already deleted or moved.
+// </summary>
+// <returns>
+// Returns the root of the combined tree.
+// </returns>
+BinTree::Node* BinTree::combine(SetOperation operation, Node* a, Node* b,
+	vector<Node*> &dropped, int forks)
+{
+	if (b == nullptr)
+	{
+		if (operation != INTERSECTION)
+		{
+			return a;
+		}
+		discard(a, dropped);
+		return nullptr;
+	}
+
+	if (a == nullptr)
+	{
+		if (operation == UNION)
+		{
+			return b;
+		}
+		discard(b, dropped);
+		return nullptr;
+	}
+
+	Node* mid = b;
+	Node* bLeft = b->left;
+	Node* bRight = b->right;
+
+	if (bLeft != nullptr)
+	{
+		bLeft->parent = nullptr;
+	}
+	if (bRight != nullptr)
+	{
+		bRight->parent = nullptr;
+	}
+	mid->left = nullptr;
+	mid->right = nullptr;
+
+	Node* aLeft = nullptr;
+	Node* aRight = nullptr;
+	Node* equal = splitAround(a, *mid->data, aLeft, aRight);
+	Node* left = nullptr;
+	Node* right = nullptr;
+
+	if (forks > 0 && Links::size(aLeft) + Links::size(bLeft)
+		+ Links::size(aRight) + Links::size(bRight) >= PARALLEL_CUTOFF)
+	{
+		vector<Node*> leftDropped;
+		thread worker([&]()
+		{
+			left = combine(operation, aLeft, bLeft, leftDropped, forks - 1);
+		});
+
+		right = combine(operation, aRight, bRight, dropped, forks - 1);
+		worker.join();
+		dropped.insert(dropped.end(), leftDropped.begin(), leftDropped.end());
+	}
+	else
+	{
+		left = combine(operation, aLeft, bLeft, dropped, forks);
+		right = combine(operation, aRight, bRight, dropped, forks);
+	}
+
+	if (operation == UNION)
+	{
+		if (equal != nullptr)
+		{
+			delete mid->data;				// keep the data already in BinTree
+			mid->data = equal->data;
+			dropped.push_back(equal);
+		}
+		return join(left, mid, right);
+	}
+
+	delete mid->data;
+	dropped.push_back(mid);
+
+	if (operation == INTERSECTION && equal != nullptr)
+	{
+		return join(left, equal, right);
+	}
+
+	if (equal != nullptr)
+	{
+		delete equal->data;
+		dropped.push_back(equal);
+	}
+	return join(left, right);
+}
+
+////////////////////// Merge Linear ///////////////////////
+// <summary>
+// Helper function for the set operations on trees that are not both
+// balanced, where combine could recurse too deep. Merges the two sorted
+// node sequences in O(n + m) and relinks the kept nodes into a
+// height-balanced shape.
+// </summary>
+// <returns>
+// Returns the root of the combined tree.
+// </returns>
+BinTree::Node* BinTree::mergeLinear(SetOperation operation, Node* a, Node* b,
+	vector<Node*> &dropped)
+{
+	vector<Node*> first;
+	vector<Node*> second;
+	vector<Node*> kept;
+
+	inOrder(a, [&first](Node* current) { first.push_back(current); });
+	inOrder(b, [&second](Node* current) { second.push_back(current); });
+
+	size_t i = 0;
+	size_t j = 0;
+
+	while (i < first.size() || j < second.size())
+	{
+		int order = (i == first.size()) ? 1 : (j == second.size()) ? -1
+			: first[i]->data->compare(*second[j]->data);
+		Node* keep = nullptr;
+
+		if (order < 0)
+		{
+			keep = (operation != INTERSECTION) ? first[i] : nullptr;
+			if (keep == nullptr)
+			{
+				delete first[i]->data;
+				dropped.push_back(first[i]);
+			}
+			i++;
+		}
+		else if (order > 0)
+		{
+			keep = (operation == UNION) ? second[j] : nullptr;
+			if (keep == nullptr)
+			{
+				delete second[j]->data;
+				dropped.push_back(second[j]);
+			}
+			j++;
+		}
+		else
+		{
+			keep = (operation != DIFFERENCE) ? first[i] : nullptr;
+			if (keep == nullptr)
+			{
+				delete first[i]->data;
+				dropped.push_back(first[i]);
+			}
+			delete second[j]->data;
+			dropped.push_back(second[j]);
+			i++;
+			j++;
+		}
+
+		if (keep != nullptr)
+		{
+			kept.push_back(keep);
+		}
+	}
+
+	return linkSorted(kept, 0, static_cast<int>(kept.size()) - 1, nullptr);
+}
+
+/////////////////////// Link Sorted ///////////////////////
+// <summary>
+// Helper function for mergeLinear and joinWith. Links nodes[low..high]
+// into a subtree rooted at the middle node, like inOrderArrBst but reusing
+// the nodes.
+// Recursion depth is logarithmic.
+// </summary>
+// <returns>
+// Returns the root of the subtree, nullptr if the range is empty.
+// </returns>
+BinTree::Node* BinTree::linkSorted(vector<Node*> &nodes, int low, int high,
+	Node* parent)
+{
+	if (low > high)
+	{
+		return nullptr;
+	}
+
+	int middle = low + (high - low) / 2;
+	Node* node = nodes[middle];
+
+	node->parent = parent;
+	node->left = linkSorted(nodes, low, middle - 1, node);
+	node->right = linkSorted(nodes, middle + 1, high, node);
+	Links::update(node);
+
+	return node;
+}
+
+///////////////////////// Discard /////////////////////////
+// <summary>
+// Helper function that deletes the data of the subtree at node and adds
+// its nodes to dropped.
+// </summary>
+void BinTree::discard(Node* node, vector<Node*> &dropped)
+{
+	preOrder(node, [&dropped](Node* current)
+	{
+		delete current->data;
+		current->data = nullptr;
+		dropped.push_back(current);
+	});
+}
+
+/////////////////////// Split Around //////////////////////
+// <summary>
+// Helper function that splits the standalone tree at node into the data
+// less than key and the data greater than key. The equal data, if any, is
+// the smallest of the upper part and is detached from it.
+// </summary>
+// <returns>
+// Returns the node holding data equal to key, taken out of both halves,
+// or nullptr if there is none.
+// </returns>
+BinTree::Node* BinTree::splitAround(Node* node, const NodeData &key,
+	Node* &left, Node* &right)
+{
+	split(node, key, false, left, right);
+
+	Node* first = leftmost(right);
+
+	if (first == nullptr || *first->data != key)
+	{
+		return nullptr;
+	}
+
+	Links::unlink(first, right, balanced);
+	return first;
+}
+
+///////////////////////// Begin ///////////////////////////
+// <summary>
+// Function to get an iterator to the smallest data in BinTree.
+// </summary>
+// <returns>
+// Returns an iterator to the smallest data, end() if BinTree is empty.
+// </returns>
+BinTree::Iterator BinTree::begin() const
+{
+	return Iterator(leftmost(root), this);
+}
+
+////////////////////////// End ////////////////////////////
+// <summary>
+// Function to get the past-the-end iterator of BinTree.
+// </summary>
+// <returns>
+// Returns the iterator one past the largest data.
+// </returns>
+BinTree::Iterator BinTree::end() const
+{
+	return Iterator(nullptr, this);
+}
+
+//////////////////////// R Begin //////////////////////////
+// <summary>
+// Function to get a reverse iterator to the largest data in BinTree.
+// </summary>
+// <returns>
+// Returns a reverse iterator to the largest data.
+// </returns>
+BinTree::reverse_iterator BinTree::rbegin() const
+{
+	return reverse_iterator(end());
+}
+
+///////////////////////// R End ///////////////////////////
+// <summary>
+// Function to get the past-the-end reverse iterator of BinTree.
+// </summary>
+// <returns>
+// Returns the reverse iterator one before the smallest data.
+// </returns>
+BinTree::reverse_iterator BinTree::rend() const
+{
+	return reverse_iterator(begin());
+}
+
+///////////////////////// Range ///////////////////////////
+// <summary>
+// Function to get a view of the data d with low <= d <= high. The view
+// runs from the ceiling of low up to, not including, the smallest data
+// greater than high, so iterating it never compares against the bounds.
+// </summary>
+// <returns>
+// Returns the view, empty if high < low or no data lies between them.
+// </returns>
+BinTree::Range BinTree::range(const NodeData &low,
+	const NodeData &high) const
+{
+	if (high < low)
+	{
+		return Range(end(), end());
+	}
+
+	return Range(Iterator(ceilingNode(low, true), this),
+		Iterator(ceilingNode(high, false), this));
+}
+
+////////////////////////// Range //////////////////////////
+// <summary>
+// Lazy view of the data of a BinTree between two bounds, in sorted order.
+// </summary>
+BinTree::Range::Range(Iterator first, Iterator last)
+{
+	this->first = first;
+	this->last = last;
+}
+
+BinTree::Iterator BinTree::Range::begin() const
+{
+	return first;
+}
+
+BinTree::Iterator BinTree::Range::end() const
+{
+	return last;
+}
+
+bool BinTree::Range::empty() const
+{
+	return first == last;
+}
+
+//////////////////////// Iterator /////////////////////////
+// <summary>
+// Bidirectional iterator over the data of a BinTree in sorted order. Steps
+// by following child and parent links, so ++ and -- never allocate and
+// cost amortized O(1).
+// </summary>
+BinTree::Iterator::Iterator()
+{
+	node = nullptr;
+	tree = nullptr;
+}
+
+BinTree::Iterator::Iterator(const Node* node, const BinTree* tree)
+{
+	this->node = node;
+	this->tree = tree;
+}
+
+BinTree::Iterator::reference BinTree::Iterator::operator*() const
+{
+	return *node->data;
+}
+
+BinTree::Iterator::pointer BinTree::Iterator::operator->() const
+{
+	return node->data;
+}
+
+// <summary>
+// Moves to the leftmost node of the right subtree if there is one, otherwise
+// climbs until arriving from a left child.
+// </summary>
+BinTree::Iterator& BinTree::Iterator::operator++()
+{
+	if (node->right != nullptr)
+	{
+		node = leftmost(node->right);
+	}
+	else
+	{
+		const Node* child = node;
+		node = node->parent;
+
+		while (node != nullptr && child == node->right)
+		{
+			child = node;
+			node = node->parent;
+		}
+	}
+
+	return *this;
+}
+
+BinTree::Iterator BinTree::Iterator::operator++(int)
+{
+	Iterator previous = *this;
+	++(*this);
+	return previous;
+}
+
+// <summary>
+// Mirror image of ++. Stepping back from end() lands on the largest data.
+// </summary>
+BinTree::Iterator& BinTree::Iterator::operator--()
+{
+	if (node == nullptr)
+	{
+		node = rightmost(tree->root);
+	}
+	else if (node->left != nullptr)
+	{
+		node = rightmost(node->left);
+	}
+	else
+	{
+		const Node* child = node;
+		node = node->parent;
+
+		while (node != nullptr && child == node->left)
+		{
+			child = node;
+			node = node->parent;
+		}
+	}
+
+	return *this;
+}
+
+BinTree::Iterator BinTree::Iterator::operator--(int)
+{
+	Iterator previous = *this;
+	--(*this);
+	return previous;
+}
+
+bool BinTree::Iterator::operator==(const Iterator &other) const
+{
+	return node == other.node;
+}
+
+bool BinTree::Iterator::operator!=(const Iterator &other) const
+{
+	return node != other.node;
+}
+
+//------------------------- displaySideways ---------------------------------
+// Displays a binary tree as though you are viewing it from the side;
+// hard coded displaying to standard output. TreeWriter's SIDEWAYS format
+// writes the same layout to any stream.
+// Preconditions: NONE
+// Postconditions: BinTree remains unchanged.
+void BinTree::displaySideways() const {
+	TreeWriter writer(cout, TreeWriter::SIDEWAYS);
+	writer.write(*this);
+}
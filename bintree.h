@@ -10,22 +10,80 @@
 // ----------------------------------------------------------------------------
 // Assumptions: 
 // - Array to Binary Search Tree assumes that the array passed in is sorted.
+// - A BinTree is unbalanced unless constructed with balanced set to true, in
+//   which case every insert keeps the tree AVL-balanced.
+// - Iterators stay valid across insert and remove, since nodes are never
+//   moved; removing data invalidates only iterators to that data. They are
+//   all invalidated by makeEmpty, bstreeToArray and assignment.
+// - Copying, comparing and emptying a tree of at least PARALLEL_CUTOFF nodes
+//   spreads the work over all hardware threads, or as many as set with
+//   setParallelism. A BinTree is still not safe to use from several threads
+//   at once.
+// - The set operations relink nodes between trees instead of copying them.
+//   Trees that have exchanged nodes may end up sharing one node pool, as do
+//   trees constructed with the same pool, and must then not be changed from
+//   different threads at the same time.
+// - makeEmpty drops all nodes in one step only while no other tree or caller
+//   holds the tree's pool; otherwise it releases them one at a time.
 // ----------------------------------------------------------------------------
 
+#ifndef BINTREE_H
+#define BINTREE_H
+
+#include <atomic>
+#include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+#include "avllinks.h"
 #include "nodedata.h"
+#include "nodepool.h"
 
 using namespace std;
 
 class BinTree
 {
+	struct Node;							// defined in the private section
+
 public:
+	typedef NodePool<Node> Pool;			// allocator for the nodes of a tree
+
 	////////////////// Default Constructor ////////////////////
 	// <summary>
 	// Default constructor for class BinTree. Creates an empty tree.
 	// </summary>
 	BinTree();
 
+	/////////////////// Balanced Constructor //////////////////
+	// <summary>
+	// Constructor for class BinTree. Creates an empty tree that keeps itself
+	// AVL-balanced on insert when balanced is true, so sorted input still gives
+	// a tree of logarithmic height.
+	// </summary>
+	// <parameter = "balanced">
+	// True to rebalance on insert, false for a plain binary search tree.
+	// </parameter>
+	explicit BinTree(bool balanced);
+
+	///////////////////// Pool Constructor ////////////////////
+	// <summary>
+	// Constructor for class BinTree. Creates an empty tree that takes its
+	// nodes from pool, so trees built and torn down together can share one
+	// arena.
+	// </summary>
+	// <parameter = "balanced">
+	// True to rebalance on insert, false for a plain binary search tree.
+	// </parameter>
+	// <parameter = "pool">
+	// Pool to allocate nodes from, or nullptr for one of the tree's own.
+	// </parameter>
+	BinTree(bool balanced, shared_ptr<Pool> pool);
+
 	//////////////////// Copy Constructor /////////////////////
 	// <summary>
 	// Copy constructor for class BinTree. Performs a deep copy.
@@ -51,11 +109,53 @@ public:
 	// </returns>
 	bool isEmpty() const;
 
+	////////////////////// Is Balanced ////////////////////////
+	// <summary>
+	// Function that checks whether the current BinTree rebalances on insert.
+	// </summary>
+	// <returns>
+	// Returns true if the BinTree was constructed in balanced mode.
+	// </returns>
+	bool isBalanced() const;
+
+	//////////////////////// Get Pool /////////////////////////
+	// <summary>
+	// Function to get the pool BinTree takes its nodes from, for building
+	// another tree on the same arena.
+	// </summary>
+	// <returns>
+	// Returns the pool, never nullptr.
+	// </returns>
+	shared_ptr<Pool> getPool() const;
+
+	///////////////////// Set Parallelism /////////////////////
+	// <summary>
+	// Sets the number of threads that copying, comparing and emptying a tree
+	// of at least PARALLEL_CUTOFF nodes use, for every BinTree. Meant for
+	// benchmarks and for leaving cores to other work.
+	// </summary>
+	// <parameter = "workers">
+	// Threads to use, or 0, the default, for one per hardware thread.
+	// </parameter>
+	static void setParallelism(int workers);
+
+	////////////////////////// Size ///////////////////////////
+	// <summary>
+	// Function to get the number of data stored in BinTree. Read from the
+	// subtree size kept in the root, so it costs O(1) and can be used to size
+	// an export buffer.
+	// </summary>
+	// <returns>
+	// Returns the number of nodes in BinTree.
+	// </returns>
+	int size() const;
+
 	/////////////////////// Make Empty ////////////////////////
 	// <summary>
 	// Function that empties BinTree. Calls the makeEmpty helper function to
-	// individually empty each node in BinTree. isEmpty returns true when called
-	// on a BinTree directly after this function.
+	// delete the data held by each node, then releases every node back to the
+	// pool at once. isEmpty returns true when called on a BinTree directly
+	// after this function.
 	// </summary>
 	void makeEmpty();
 
@@ -69,7 +169,8 @@ public:
 	// </parameter>
 	// <returns>
 	// Returns the preceding BinTree that has been modified to contain the same
-	// nodes as the right side Bintree object.
+	// nodes as the right side Bintree object. The balancing mode of the right
+	// side BinTree is copied along with its nodes.
 	// </returns>
 	BinTree& operator=(const BinTree &obj);
 
@@ -95,13 +196,14 @@ public:
 	/////////////////////// << Operator ///////////////////////
 	// <summary>
 	// Function for the overloaded << operator. Prints the BinTree horizontally
-	// using inOrder traversal.
+	// to out using inOrder traversal, through a TreeWriter buffer.
 	// </summary>
 	// <returns>
 	// Returns the output stream for the correctly formatted BinTree output to be
 	// printed in the console.
 	// </returns>
 	friend ostream& operator<<(ostream& out, const BinTree& obj);
+	friend class TreeWriter;				// walks the nodes to format them
 
 	//////////////////////// Retrieve /////////////////////////
 	// <summary>
@@ -113,10 +215,41 @@ public:
 	// </returns>
 	bool retrieve(const NodeData &data, NodeData* &retrieveData) const;
 
+	///////////////////// Retrieve Batch //////////////////////
+	// <summary>
+	// Function to search for count data at once, sets results[i] to the data
+	// matching keys[i], or nullptr if it is not in BinTree. Up to 16 searches
+	// are in flight together; each one prefetches the next node it will read
+	// and then works on the others while that load completes, so the cache
+	// misses of different searches overlap instead of queuing.
+	// </summary>
+	// <parameter = "results">
+	// Array of at least count pointers, filled in order of keys.
+	// </parameter>
+	// <returns>
+	// Returns the number of keys found.
+	// </returns>
+	int retrieveBatch(const NodeData keys[], int count,
+		NodeData* results[]) const;
+
+#if __cplusplus >= 202002L
+	///////////////////// Retrieve Batch //////////////////////
+	// <summary>
+	// Function to search for every data in keys at once, same as the array
+	// version above.
+	// </summary>
+	// <returns>
+	// Returns the number of keys found, or -1 with nothing written if results
+	// is shorter than keys.
+	// </returns>
+	int retrieveBatch(span<const NodeData> keys, span<NodeData*> results) const;
+#endif
+
 	/////////////////////// Get Height ////////////////////////
 	// <summary>
 	// Function to get the height of BinTree at the node containing the data
-	// parameter.
+	// parameter. Each node stores the height of its subtree, kept up to date by
+	// insert, so this costs one search and no walk of the subtree.
 	// </summary>
 	// <returns>
 	// Returns the integer height of BinTree at the data. Returns 0 if
@@ -124,18 +257,256 @@ public:
 	// </returns>
 	int getHeight(const NodeData &data) const;
 
+	////////////////////// Lower Bound ////////////////////////
+	// <summary>
+	// Function to find the smallest data in BinTree that is not less than the
+	// passed data, sets it to foundData if found. Follows the BST ordering, so
+	// only a single root-to-leaf path is visited.
+	// </summary>
+	// <returns>
+	// Returns true if such data exists and is set, false otherwise.
+	// </returns>
+	bool lowerBound(const NodeData &data, NodeData* &foundData) const;
+
+	////////////////////// Upper Bound ////////////////////////
+	// <summary>
+	// Function to find the smallest data in BinTree that is strictly greater
+	// than the passed data, sets it to foundData if found.
+	// </summary>
+	// <returns>
+	// Returns true if such data exists and is set, false otherwise.
+	// </returns>
+	bool upperBound(const NodeData &data, NodeData* &foundData) const;
+
+	///////////////////////// Floor ///////////////////////////
+	// <summary>
+	// Function to find the largest data in BinTree that is less than or equal
+	// to the passed data, sets it to foundData if found.
+	// </summary>
+	// <returns>
+	// Returns true if such data exists and is set, false otherwise.
+	// </returns>
+	bool floor(const NodeData &data, NodeData* &foundData) const;
+
+	//////////////////////// Ceiling //////////////////////////
+	// <summary>
+	// Function to find the smallest data in BinTree that is greater than or
+	// equal to the passed data, sets it to foundData if found. Same result as
+	// lowerBound.
+	// </summary>
+	// <returns>
+	// Returns true if such data exists and is set, false otherwise.
+	// </returns>
+	bool ceiling(const NodeData &data, NodeData* &foundData) const;
+
+	////////////////////////// Rank ///////////////////////////
+	// <summary>
+	// Function to find the position the passed data has, or would have, in
+	// the sorted order of BinTree. Uses the subtree sizes kept in each node,
+	// so only one root-to-leaf path is visited.
+	// </summary>
+	// <returns>
+	// Returns the number of data in BinTree less than the passed data.
+	// </returns>
+	int rank(const NodeData &data) const;
+
+	///////////////////////// Select //////////////////////////
+	// <summary>
+	// Function to find the data at position k of the sorted order of BinTree,
+	// counting from 0, sets it to foundData if found.
+	// </summary>
+	// <returns>
+	// Returns true if 0 <= k < size() and the data is set, false otherwise.
+	// </returns>
+	bool select(int k, NodeData* &foundData) const;
+
+	////////////////////// Count Range ////////////////////////
+	// <summary>
+	// Function to count the data in BinTree between low and high, inclusive,
+	// without visiting them.
+	// </summary>
+	// <returns>
+	// Returns the number of data d with low <= d <= high, 0 if high < low.
+	// </returns>
+	int countRange(const NodeData &low, const NodeData &high) const;
+
 	/////////////// Binary Search Tree to Array ///////////////
 	// <summary>
 	// Converts BinTree to array.
 	// </summary>
 	void bstreeToArray(NodeData* arr[]);
 
+	/////////////// Binary Search Tree to Array ///////////////
+	// <summary>
+	// Bounded version of bstreeToArray. Moves the data of BinTree into arr in
+	// sorted order and empties BinTree, but only if all of it fits.
+	// </summary>
+	// <parameter = "capacity">
+	// Number of elements arr can hold.
+	// </parameter>
+	// <returns>
+	// Returns the number of data moved into arr, or -1 if capacity is smaller
+	// than size(), in which case BinTree and arr are left unchanged.
+	// </returns>
+	int bstreeToArray(NodeData* arr[], int capacity);
+
 	/////////////// Array to Binary Search Tree ///////////////
 	// <summary>
-	// Converts array to BinTree.
+	// Converts array to BinTree. Reads at most 100 elements, stopping at the
+	// first nullptr.
 	// </summary>
 	void arrayToBSTree(NodeData* arr[]);
 
+	/////////////// Array to Binary Search Tree ///////////////
+	// <summary>
+	// Converts the first arrSize elements of an array to BinTree, with no
+	// limit on arrSize. BinTree takes ownership of the data, deleting repeated
+	// data, and the array entries are set to nullptr. Sorted input is linked
+	// by bulkLoad in O(n). Other input is inserted one midpoint at a time, in
+	// the order the original build used, so the tree is always a valid BST.
+	// </summary>
+	void arrayToBSTree(NodeData* arr[], int arrSize);
+
+	//////////////////////// Bulk Load ////////////////////////
+	// <summary>
+	// Replaces the contents of BinTree with the first arrSize elements of a
+	// sorted array, linking the nodes directly into a height-balanced shape in
+	// O(n) with no comparisons. BinTree takes ownership of the data and the
+	// array entries are set to nullptr.
+	// </summary>
+	// <parameter = "validate">
+	// When true, the input is first checked to be in nondecreasing order, and
+	// repeated data is deleted so each value is kept once. When false, the
+	// input must already be strictly increasing.
+	// </parameter>
+	// <returns>
+	// Returns the number of nodes in BinTree afterwards, or -1 if validate is
+	// true and the input is out of order, in which case nothing is changed
+	// and the caller keeps ownership of the data.
+	// </returns>
+	int bulkLoad(NodeData* arr[], int arrSize, bool validate = false);
+
+	//////////////////////// Bulk Load ////////////////////////
+	// <summary>
+	// Range version of bulkLoad for any sequence of NodeData*, such as a
+	// vector. Same ordering, ownership and validate rules as above.
+	// </summary>
+	template <typename InputIt>
+	int bulkLoad(InputIt first, InputIt last, bool validate = false);
+
+	//////////////////////// Export To ////////////////////////
+	// <summary>
+	// Snapshot export. Writes a copy of each data in BinTree to out in sorted
+	// order and leaves BinTree unchanged. Exactly size() elements are written.
+	// </summary>
+	// <parameter = "out">
+	// Output iterator that accepts a const NodeData&, e.g. a back_inserter of
+	// a vector of NodeData or a pointer into a buffer of size() elements.
+	// </parameter>
+	// <returns>
+	// Returns out advanced past the last element written.
+	// </returns>
+	template <typename OutputIt>
+	OutputIt exportTo(OutputIt out) const;
+
+	//////////////////////// Extract To ///////////////////////
+	// <summary>
+	// Move export. Hands the NodeData* of each node to out in sorted order,
+	// then empties BinTree. The caller owns the written pointers. Exactly
+	// size() elements are written.
+	// </summary>
+	// <parameter = "out">
+	// Output iterator that accepts a NodeData*.
+	// </parameter>
+	// <returns>
+	// Returns out advanced past the last element written.
+	// </returns>
+	template <typename OutputIt>
+	OutputIt extractTo(OutputIt out);
+
+	///////////////////////// Remove ////////////////////////
+	// <summary>
+	// Removes the node containing the passed data from BinTree and deletes
+	// its data. Rebalances on the way back up in balanced mode.
+	// </summary>
+	// <returns>
+	// Returns true if the data was found and removed, false otherwise.
+	// </returns>
+	bool remove(const NodeData &data);
+
+	///////////////////////// Extract ///////////////////////////
+	// <summary>
+	// Removes the node containing the passed data from BinTree without
+	// deleting its data. Ownership of the data passes to the caller.
+	// </summary>
+	// <returns>
+	// Returns the data that was in BinTree, nullptr if it was not found.
+	// </returns>
+	NodeData* extract(const NodeData &data);
+
+	////////////////////// Remove Range ///////////////////////
+	// <summary>
+	// Removes and deletes all data between low and high, inclusive. The tree
+	// is split around the range and the two outer pieces are joined back
+	// together, so in balanced mode this costs O(log n + k) for k removed data.
+	// </summary>
+	// <returns>
+	// Returns the number of data removed.
+	// </returns>
+	int removeRange(const NodeData &low, const NodeData &high);
+
+	/////////////////////// Union With ////////////////////////
+	// <summary>
+	// Adds every data of other to BinTree and leaves other empty. Nodes of
+	// other are relinked, not copied; where both trees hold equal data the
+	// data already in BinTree is kept and other's is deleted. When both trees
+	// are balanced this is join-based, costing O(m log(n/m + 1)) for sizes
+	// m <= n, and large inputs are split across threads; otherwise the two
+	// sorted sequences are merged in O(n + m).
+	// </summary>
+	// <parameter = "other">
+	// Tree whose data is moved into BinTree.
+	// </parameter>
+	void unionWith(BinTree &&other);
+
+	///////////////////// Intersect With //////////////////////
+	// <summary>
+	// Keeps only the data of BinTree that other also holds, deletes the
+	// rest, and leaves other empty. Same costs as unionWith.
+	// </summary>
+	void intersectWith(BinTree &&other);
+
+	///////////////////// Difference With /////////////////////
+	// <summary>
+	// Removes from BinTree every data that other holds and leaves other
+	// empty. Same costs as unionWith.
+	// </summary>
+	void differenceWith(BinTree &&other);
+
+	//////////////////////// Split Off ////////////////////////
+	// <summary>
+	// Moves every data not less than key from BinTree into greater, whose old
+	// contents are deleted first. Nodes are relinked in O(log n) when
+	// balanced, and greater takes on the balancing mode of BinTree.
+	// </summary>
+	// <parameter = "greater">
+	// Tree that receives the data greater than or equal to key.
+	// </parameter>
+	void splitOff(const NodeData &key, BinTree &greater);
+
+	//////////////////////// Join With ////////////////////////
+	// <summary>
+	// Appends the data of greater to BinTree and leaves greater empty. When
+	// all of greater's data is larger than BinTree's this relinks the two
+	// trees in O(log n) when balanced; otherwise it falls back to unionWith.
+	// A plain greater joined into a balanced BinTree is first relinked into a
+	// height-balanced shape in O(m), so the result stays AVL-balanced.
+	// </summary>
+	// <parameter = "greater">
+	// Tree whose data is moved into BinTree.
+	// </parameter>
+	void joinWith(BinTree &&greater);
+
 	//////////////////////// Insert ///////////////////////////
 	// <summary>
 	// Inserts a node to BinTree in the appropriate location based on its NodeData.
@@ -148,96 +519,699 @@ public:
 
 	//------------------------- displaySideways ---------------------------------
 	// Displays a binary tree as though you are viewing it from the side;
-	// hard coded displaying to standard output.
+	// hard coded displaying to standard output. TreeWriter's SIDEWAYS format
+	// writes the same layout to any stream.
 	// Preconditions: NONE
 	// Postconditions: BinTree remains unchanged.
 	void displaySideways() const;
 
+	//////////////////////// Iterator /////////////////////////
+	// <summary>
+	// Bidirectional iterator over the data of a BinTree in sorted order. Steps
+	// by following child and parent links, so ++ and -- never allocate and
+	// cost amortized O(1). Data is read-only, since changing it would break
+	// the tree ordering.
+	// </summary>
+	class Iterator
+	{
+	public:
+		typedef bidirectional_iterator_tag iterator_category;
+		typedef NodeData value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const NodeData* pointer;
+		typedef const NodeData& reference;
+
+		// <summary>
+		// Default constructor. Creates an iterator that belongs to no tree.
+		// </summary>
+		Iterator();
+
+		reference operator*() const;
+		pointer operator->() const;
+
+		// <summary>
+		// Moves to the next larger data; end() after the largest.
+		// </summary>
+		Iterator& operator++();
+		Iterator operator++(int);
+
+		// <summary>
+		// Moves to the next smaller data; from end() to the largest.
+		// </summary>
+		Iterator& operator--();
+		Iterator operator--(int);
+
+		bool operator==(const Iterator &other) const;
+		bool operator!=(const Iterator &other) const;
+
+	private:
+		friend class BinTree;
+
+		Iterator(const Node* node, const BinTree* tree);
+
+		const Node* node;					// current node, nullptr at end()
+		const BinTree* tree;				// owning tree, used to step back from end()
+	};
+
+	typedef Iterator iterator;
+	typedef Iterator const_iterator;
+	typedef std::reverse_iterator<Iterator> reverse_iterator;
+	typedef std::reverse_iterator<Iterator> const_reverse_iterator;
+
+	///////////////////////// Begin ///////////////////////////
+	// <summary>
+	// Function to get an iterator to the smallest data in BinTree.
+	// </summary>
+	// <returns>
+	// Returns an iterator to the smallest data, end() if BinTree is empty.
+	// </returns>
+	Iterator begin() const;
+
+	////////////////////////// End ////////////////////////////
+	// <summary>
+	// Function to get the past-the-end iterator of BinTree.
+	// </summary>
+	// <returns>
+	// Returns the iterator one past the largest data.
+	// </returns>
+	Iterator end() const;
+
+	//////////////////////// R Begin //////////////////////////
+	// <summary>
+	// Function to get a reverse iterator to the largest data in BinTree.
+	// </summary>
+	// <returns>
+	// Returns a reverse iterator to the largest data.
+	// </returns>
+	reverse_iterator rbegin() const;
+
+	///////////////////////// R End ///////////////////////////
+	// <summary>
+	// Function to get the past-the-end reverse iterator of BinTree.
+	// </summary>
+	// <returns>
+	// Returns the reverse iterator one before the smallest data.
+	// </returns>
+	reverse_iterator rend() const;
+
+	////////////////////////// Range //////////////////////////
+	// <summary>
+	// Lazy view of the data of a BinTree between two bounds, in sorted order.
+	// Both ends are found when the view is made; nothing outside the range is
+	// visited while iterating it. Like any iterator, a view is invalidated
+	// by changes to the tree.
+	// </summary>
+	class Range
+	{
+	public:
+		Iterator begin() const;
+		Iterator end() const;
+
+		// <summary>
+		// Returns true if no data lies in the range, false otherwise.
+		// </summary>
+		bool empty() const;
+
+	private:
+		friend class BinTree;
+
+		Range(Iterator first, Iterator last);
+
+		Iterator first;						// smallest data >= low
+		Iterator last;						// smallest data > high, or end()
+	};
+
+	///////////////////////// Range ///////////////////////////
+	// <summary>
+	// Function to get a view of the data d with low <= d <= high. Costs two
+	// root-to-leaf searches; stepping through the k data in it costs O(k)
+	// more, following the same links as Iterator.
+	// </summary>
+	// <returns>
+	// Returns the view, empty if high < low or no data lies between them.
+	// </returns>
+	Range range(const NodeData &low, const NodeData &high) const;
+
+	//////////////////// For Each In Range ////////////////////
+	// <summary>
+	// Function to call visit(data) for each data between low and high,
+	// inclusive, in sorted order, in O(log n + k) for k data visited.
+	// Subtrees wholly outside the range are never entered.
+	// </summary>
+	// <parameter = "visit">
+	// Callable taking a const NodeData&. It must not change BinTree.
+	// </parameter>
+	template <typename Visit>
+	void forEachInRange(const NodeData &low, const NodeData &high,
+		Visit visit) const;
+
 private:
 	struct Node {
 		NodeData* data;						// pointer to data object
 		Node* left;							// left subtree pointer
 		Node* right;						// right subtree pointer
+		Node* parent;						// parent pointer, nullptr for root
+		int height;							// height of subtree, 1 for a leaf
+		int size;							// nodes in subtree, 1 for a leaf
 	};
+	typedef AvlLinks<Node> Links;			// heights, rotations and unlinking
 	Node* root;								// root of the tree
+	shared_ptr<NodePool<Node>> pool;		// allocator for the tree's nodes, may
+											// be shared with trees split from it
+	bool balanced;							// true to AVL-balance on insert
+	vector<Node**> insertPath;				// scratch stack of links for insert
+
+	/////////////////////// In Order //////////////////////////
+	// <summary>
+	// Traversal core shared by the helpers below. Visits every node of the
+	// subtree in sorted order using an explicit stack instead of recursion, so a
+	// degenerate tree of any depth cannot overflow the call stack. The right
+	// child is read before visit is called, so visit may clear the node's data.
+	// </summary>
+	template <typename Visit>
+	static void inOrder(Node* node, Visit visit);
+
+	/////////////////////// Pre Order /////////////////////////
+	// <summary>
+	// Traversal core for helpers that do not need sorted order. Visits each node
+	// before its children using an explicit stack.
+	// </summary>
+	template <typename Visit>
+	static void preOrder(Node* node, Visit visit);
+
+	/////////////////////// Sideways //////////////////////////
+	// <summary>
+	// Traversal core for displaySideways. Visits the right subtree, the node,
+	// then the left subtree using an explicit stack, calling visit(node,
+	// level) with level 1 at the starting node.
+	// </summary>
+	template <typename Visit>
+	static void sideways(Node* node, Visit visit);
+
+	static const int PARALLEL_CUTOFF = 1 << 16;	// nodes before work is split
+	static atomic<int> parallelism;			// set by setParallelism, 0 for all
+
+	// <summary>
+	// A subtree still to be copied: the link to fill, the parent of the copy
+	// and the node to copy.
+	// </summary>
+	struct CopyTask {
+		Node** link;
+		Node* parent;
+		Node* source;
+	};
 
 	/////////////////// Make Empty Helper /////////////////////
 	// <summary>
-	// Helper function for makeEmpty function. Individually empties each node in
-	// BinTree if not already empty.
+	// Helper function for makeEmpty function. Individually deletes the data of
+	// each node in BinTree if not already empty. The nodes themselves are left
+	// for the pool to reclaim in one step. Uses an explicit stack, so any tree
+	// shape is safe. Large trees are split into subtrees that are emptied in
+	// parallel.
 	// </summary>
 	// <parameter = "node">
 	// Root node to start emptying BinTree.
 	// </parameter>
 	void makeEmpty(Node* &node);
 
+	//////////////////// Delete Subtrees //////////////////////
+	// <summary>
+	// Helper function for makeEmpty. Deletes the data of the subtrees on
+	// stack. When deferred is not nullptr, subtrees of at most grain nodes are
+	// moved to it untouched so they can be handed to other threads.
+	// </summary>
+	static void deleteSubtrees(vector<Node*> &stack, int grain,
+		vector<Node*>* deferred);
+
 	//////////////////////// = Helper /////////////////////////
 	// <summary>
-	// Helper function for the = assignment operator.
+	// Helper function for the = assignment operator. Copies the right tree
+	// top-down with an explicit stack of pending copy tasks. Large trees are
+	// split into subtrees that are copied in parallel, each thread into a pool
+	// of its own that the tree's pool then adopts.
 	// </summary>
 	void assign(Node* &leftNode, Node* rightNode);
 
+	///////////////////// Copy Subtrees ///////////////////////
+	// <summary>
+	// Helper function for assign. Copies the subtrees on stack with nodes
+	// from nodes. When deferred is not nullptr, subtrees of at most grain
+	// nodes are moved to it uncopied so they can be handed to other threads.
+	// </summary>
+	static void copySubtrees(vector<CopyTask> &stack, NodePool<Node> &nodes,
+		int grain, vector<CopyTask>* deferred);
+
 	//////////////////////// == Helper ////////////////////////
 	// <summary>
-	// Helper function for the overloaded == comparison operator.
+	// Helper function for the overloaded == comparison operator. Walks both trees
+	// in lockstep with an explicit stack and stops at the first difference.
+	// Subtrees of different sizes differ without being walked. Large trees are
+	// split into pairs of subtrees that are compared in parallel.
 	// </summary>
 	// <returns>
 	// Returns true if the two BinTrees are identical, returns false otherwise.
 	// </returns>
 	bool equal(Node* leftNode, Node* rightNode) const;
 
-	//////////////////////// << Helper ////////////////////////
+	//////////////////// Equal Subtrees ///////////////////////
 	// <summary>
-	// Helper function for the overloaded << operator. Prints the BinTree horizontally
-	// using inOrder traversal.
+	// Helper function for equal. Compares the pairs of subtrees on stack.
+	// When deferred is not nullptr, pairs of at most grain nodes are moved to
+	// it unvisited. Gives up early once stop is set by another thread.
 	// </summary>
-	void inOrderOut(Node* node) const;
+	// <returns>
+	// Returns false at the first difference found, true otherwise.
+	// </returns>
+	static bool equalSubtrees(vector<pair<Node*, Node*>> &stack, int grain,
+		vector<pair<Node*, Node*>>* deferred, const atomic<bool>* stop);
 
-	//////////////////// Get Height Helper ////////////////////
+	////////////////////// Worker Count ///////////////////////
 	// <summary>
-	// Helper function to get the height of BinTree at the node containing the data
-	// parameter. Increases the return value by 1 for every level after finding the
-	// data node.
+	// Helper function that picks the number of threads for a whole-tree job.
 	// </summary>
 	// <returns>
-	// Returns the integer height of BinTree at the data until reaching the bottom.
+	// Returns 1 below PARALLEL_CUTOFF nodes, otherwise the number set by
+	// setParallelism or, by default, the number of hardware threads.
 	// </returns>
-	int getHeight(Node* node) const;
+	static int workerCount(int nodes);
+
+	/////////////////////// Grain Size ////////////////////////
+	// <summary>
+	// Helper function that picks the largest subtree to hand out as one
+	// piece of work, aiming at several pieces per worker so that threads that
+	// finish early can take more.
+	// </summary>
+	static int grainSize(int nodes, int workers);
+
+	////////////////////// Run Parallel ///////////////////////
+	// <summary>
+	// Calls work(i, worker) for every i in [0, count) on workers threads,
+	// the calling thread being worker 0. Each thread takes the next i from a
+	// shared counter, so uneven pieces balance out.
+	// </summary>
+	template <typename Work>
+	static void runParallel(int count, int workers, Work work);
 
 	//////////////////// Find Node Helper ////////////////////
 	// <summary>
 	// Helper function to find the node in BinTree containing the passed data.
-	// Called by retrieve and getHeight.
+	// Descends left or right by comparing against each node, so the search
+	// costs the depth of the tree rather than its size. Called by retrieve and
+	// getHeight.
 	// </summary>
 	// <returns>
 	// Returns the found node in BinTree.
 	// </returns>
 	Node* findNode(const NodeData &data, Node* node) const;
 
-	/////////// Binary Search Tree to Array Helper ////////////
+	/////////////////// Ceiling Node Helper ///////////////////
 	// <summary>
-	// Helper function for bstreeToArray.
+	// Helper function for lowerBound, upperBound and ceiling. Finds the node
+	// with the smallest data greater than the passed data, or equal to it when
+	// inclusive is true.
 	// </summary>
-	void inOrderBstArr(NodeData* arr[], Node* obj, int& index);
+	// <returns>
+	// Returns the found node, nullptr if no such node exists.
+	// </returns>
+	Node* ceilingNode(const NodeData &data, bool inclusive) const;
+
+	//////////////////// Floor Node Helper ////////////////////
+	// <summary>
+	// Helper function for floor. Finds the node with the largest data less than
+	// the passed data, or equal to it when inclusive is true.
+	// </summary>
+	// <returns>
+	// Returns the found node, nullptr if no such node exists.
+	// </returns>
+	Node* floorNode(const NodeData &data, bool inclusive) const;
 
 	/////////// Array to Binary Search Tree Helper ////////////
 	// <summary>
-	// Helper function for arrayToBSTree.
+	// Helper function for arrayToBSTree and bulkLoad. Links arr[low..high]
+	// into a subtree rooted at the middle element and sets its heights and
+	// parent pointers. Recursion depth is logarithmic in the array size.
 	// </summary>
-	void inOrderArrBst(NodeData* arr[], int low, int high);
+	// <returns>
+	// Returns the root of the new subtree, nullptr if the range is empty.
+	// </returns>
+	Node* inOrderArrBst(NodeData* arr[], int low, int high, Node* parent);
 
 	///////////////////// Insert Helper ///////////////////////
 	// <summary>
-	// Helper function for insert.
+	// Helper function for insert. Walks down from node recording each link on
+	// the path, creates the node at the empty link it reaches, then walks the
+	// path back up updating heights (rebalancing in balanced mode) until a
+	// subtree height stops changing. Subtree sizes are incremented all the way
+	// to the root.
 	// </summary>
 	// <returns>
 	// Returns the true if the insert was successful, false if unsuccessful.
 	// </returns>
-	bool insert(Node* node, NodeData* obj);
+	bool insert(Node* &node, NodeData* obj);
 
-	//---------------------------- Sideways -------------------------------------
-	// Helper method for displaySideways
-	// Preconditions: NONE
-	// Postconditions: BinTree remains unchanged.
-	void sideways(Node*, int) const;			// provided below, helper for displaySideways()
-};
\ No newline at end of file
+	//////////////////////// Prefetch /////////////////////////
+	// <summary>
+	// Helper function that hints the CPU to start loading address into cache.
+	// Does nothing on compilers without the builtin.
+	// </summary>
+	static void prefetch(const void* address);
+
+	////////////////////// Leftmost Node //////////////////////
+	// <summary>
+	// Helper function that finds the node with the smallest data in the
+	// subtree at node.
+	// </summary>
+	// <returns>
+	// Returns the leftmost node, nullptr for an empty subtree.
+	// </returns>
+	static Node* leftmost(Node* node);
+
+	///////////////////// Rightmost Node //////////////////////
+	// <summary>
+	// Helper function that finds the node with the largest data in the
+	// subtree at node.
+	// </summary>
+	// <returns>
+	// Returns the rightmost node, nullptr for an empty subtree.
+	// </returns>
+	static Node* rightmost(Node* node);
+
+	////////////////////// Count Less /////////////////////////
+	// <summary>
+	// Helper function for rank and countRange. Counts the data in BinTree
+	// less than the passed data, or less than or equal to it when inclusive
+	// is true, by summing left subtree sizes along one root-to-leaf path.
+	// </summary>
+	// <returns>
+	// Returns the number of such data.
+	// </returns>
+	int countLess(const NodeData &data, bool inclusive) const;
+
+	////////////////////////// Join ///////////////////////////
+	// <summary>
+	// Helper function that joins two standalone trees and a middle node into
+	// one tree, given every data in left < mid < every data in right. In
+	// balanced mode mid is hung on the spine of the taller tree at the height
+	// of the shorter one and rebalanced, costing O(|height difference| + 1);
+	// otherwise mid simply becomes the root.
+	// </summary>
+	// <returns>
+	// Returns the root of the joined tree.
+	// </returns>
+	Node* join(Node* left, Node* mid, Node* right);
+
+	///////////////////////// Join Two ////////////////////////
+	// <summary>
+	// Helper function that joins two standalone trees with every data in left
+	// less than every data in right, using the smallest node of right as the
+	// middle node.
+	// </summary>
+	// <returns>
+	// Returns the root of the joined tree.
+	// </returns>
+	Node* join(Node* left, Node* right);
+
+	////////////////////////// Split //////////////////////////
+	// <summary>
+	// Helper function that splits the standalone tree at node into the data
+	// less than key (also equal to it when inclusive is true) and the rest.
+	// Walks one path down and joins the pieces back up it, so in balanced
+	// mode this costs O(log n). The tree at node is consumed.
+	// </summary>
+	void split(Node* node, const NodeData &key, bool inclusive,
+		Node* &left, Node* &right);
+
+	// <summary>
+	// Set operations sharing the combine helper.
+	// </summary>
+	enum SetOperation { UNION, INTERSECTION, DIFFERENCE };
+
+	//////////////////////// Set Helper ///////////////////////
+	// <summary>
+	// Helper function for the set operations. Takes the data of other into
+	// BinTree's pool, then combines the two trees with operation and makes
+	// the result the new root.
+	// </summary>
+	void setOperation(SetOperation operation, BinTree &other);
+
+	//////////////////////// Take Nodes ///////////////////////
+	// <summary>
+	// Helper function that empties other and makes its nodes BinTree's. The
+	// nodes keep their addresses when other's pool can be adopted whole, and
+	// are moved to BinTree's pool one at a time when another tree or caller
+	// holds it or its block size differs.
+	// </summary>
+	// <returns>
+	// Returns the root of other's former nodes.
+	// </returns>
+	Node* takeNodes(BinTree &other);
+
+	///////////////////////// Combine /////////////////////////
+	// <summary>
+	// Helper function for the set operations on two standalone balanced
+	// trees. Splits a around the root of b, combines the two pairs of halves
+	// (on a new thread for one of them while forks is above 0 and the input
+	// is large), and joins the results around b's root or its equal in a.
+	// Recursion depth is the height of b. Nodes no longer needed are added to
+	// dropped with their data already deleted or moved.
+	// </summary>
+	// <returns>
+	// Returns the root of the combined tree.
+	// </returns>
+	Node* combine(SetOperation operation, Node* a, Node* b,
+		vector<Node*> &dropped, int forks);
+
+	////////////////////// Merge Linear ///////////////////////
+	// <summary>
+	// Helper function for the set operations on trees that are not both
+	// balanced, where combine could recurse too deep. Merges the two sorted
+	// node sequences in O(n + m) and relinks the kept nodes into a
+	// height-balanced shape.
+	// </summary>
+	// <returns>
+	// Returns the root of the combined tree.
+	// </returns>
+	Node* mergeLinear(SetOperation operation, Node* a, Node* b,
+		vector<Node*> &dropped);
+
+	/////////////////////// Link Sorted ///////////////////////
+	// <summary>
+	// Helper function for mergeLinear and joinWith. Links nodes[low..high]
+	// into a subtree rooted at the middle node, like inOrderArrBst but reusing
+	// the nodes.
+	// </summary>
+	// <returns>
+	// Returns the root of the subtree, nullptr if the range is empty.
+	// </returns>
+	static Node* linkSorted(vector<Node*> &nodes, int low, int high,
+		Node* parent);
+
+	///////////////////////// Discard /////////////////////////
+	// <summary>
+	// Helper function that deletes the data of the subtree at node and adds
+	// its nodes to dropped.
+	// </summary>
+	static void discard(Node* node, vector<Node*> &dropped);
+
+	/////////////////////// Split Around //////////////////////
+	// <summary>
+	// Helper function that splits the standalone tree at node into the data
+	// less than key and the data greater than key.
+	// </summary>
+	// <returns>
+	// Returns the node holding data equal to key, taken out of both halves,
+	// or nullptr if there is none.
+	// </returns>
+	Node* splitAround(Node* node, const NodeData &key, Node* &left,
+		Node* &right);
+};
+
+/////////////////////// In Order //////////////////////////
+// <summary>
+// Traversal core shared by the helpers below. Visits every node of the
+// subtree in sorted order using an explicit stack instead of recursion, so a
+// degenerate tree of any depth cannot overflow the call stack. The right
+// child is read before visit is called, so visit may clear the node's data.
+// </summary>
+template <typename Visit>
+void BinTree::inOrder(Node* node, Visit visit)
+{
+	vector<Node*> stack;
+
+	while (node != nullptr || !stack.empty())
+	{
+		while (node != nullptr)
+		{
+			stack.push_back(node);
+			node = node->left;
+		}
+
+		node = stack.back();
+		stack.pop_back();
+
+		Node* right = node->right;
+		visit(node);
+		node = right;
+	}
+}
+
+/////////////////////// Pre Order /////////////////////////
+// <summary>
+// Traversal core for helpers that do not need sorted order. Visits each node
+// before its children using an explicit stack.
+// </summary>
+template <typename Visit>
+void BinTree::preOrder(Node* node, Visit visit)
+{
+	vector<Node*> stack;
+
+	if (node != nullptr)
+	{
+		stack.push_back(node);
+	}
+
+	while (!stack.empty())
+	{
+		node = stack.back();
+		stack.pop_back();
+
+		if (node->right != nullptr)
+		{
+			stack.push_back(node->right);
+		}
+		if (node->left != nullptr)
+		{
+			stack.push_back(node->left);
+		}
+		visit(node);
+	}
+}
+
+/////////////////////// Sideways //////////////////////////
+// <summary>
+// Traversal core for displaySideways. Visits the right subtree, the node,
+// then the left subtree using an explicit stack, calling visit(node,
+// level) with level 1 at the starting node.
+// </summary>
+template <typename Visit>
+void BinTree::sideways(Node* node, Visit visit)
+{
+	vector<pair<Node*, int>> stack;
+	int level = 0;
+
+	while (node != nullptr || !stack.empty())
+	{
+		while (node != nullptr)
+		{
+			level++;
+			stack.push_back(make_pair(node, level));
+			node = node->right;
+		}
+
+		node = stack.back().first;
+		level = stack.back().second;
+		stack.pop_back();
+
+		visit(node, level);
+		node = node->left;
+	}
+}
+
+////////////////////// Run Parallel ///////////////////////
+// <summary>
+// Calls work(i, worker) for every i in [0, count) on workers threads,
+// the calling thread being worker 0. Each thread takes the next i from a
+// shared counter, so uneven pieces balance out.
+// </summary>
+template <typename Work>
+void BinTree::runParallel(int count, int workers, Work work)
+{
+	atomic<int> next(0);
+	vector<thread> threads;
+
+	auto run = [&](int worker)
+	{
+		for (int i = next++; i < count; i = next++)
+		{
+			work(i, worker);
+		}
+	};
+
+	for (int worker = 1; worker < workers; worker++)
+	{
+		threads.emplace_back(run, worker);
+	}
+
+	run(0);
+
+	for (thread &worker : threads)
+	{
+		worker.join();
+	}
+}
+
+//////////////////////// Bulk Load ////////////////////////
+// <summary>
+// Range version of bulkLoad for any sequence of NodeData*, such as a
+// vector. Same ordering, ownership and validate rules as the array version.
+// </summary>
+template <typename InputIt>
+int BinTree::bulkLoad(InputIt first, InputIt last, bool validate)
+{
+	vector<NodeData*> items(first, last);
+	return bulkLoad(items.data(), static_cast<int>(items.size()), validate);
+}
+
+//////////////////////// Export To ////////////////////////
+// <summary>
+// Snapshot export. Writes a copy of each data in BinTree to out in sorted
+// order and leaves BinTree unchanged. Exactly size() elements are written.
+// </summary>
+template <typename OutputIt>
+OutputIt BinTree::exportTo(OutputIt out) const
+{
+	inOrder(root, [&](Node* current)
+	{
+		*out = *current->data;
+		++out;
+	});
+
+	return out;
+}
+
+//////////////////////// Extract To ///////////////////////
+// <summary>
+// Move export. Hands the NodeData* of each node to out in sorted order,
+// then empties BinTree. The caller owns the written pointers.
+// </summary>
+template <typename OutputIt>
+OutputIt BinTree::extractTo(OutputIt out)
+{
+	inOrder(root, [&](Node* current)
+	{
+		*out = current->data;
+		++out;
+		current->data = nullptr;
+	});
+
+	makeEmpty();
+	return out;
+}
+
+//////////////////// For Each In Range ////////////////////
+// <summary>
+// Function to call visit(data) for each data between low and high,
+// inclusive, in sorted order. Walks the view returned by range, which
+// starts at the ceiling of low and stops at the first data past high.
+// </summary>
+template <typename Visit>
+void BinTree::forEachInRange(const NodeData &low, const NodeData &high,
+	Visit visit) const
+{
+	for (const NodeData &data : range(low, high))
+	{
+		visit(data);
+	}
+}
+
+#endif
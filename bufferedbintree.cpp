@@ -0,0 +1,324 @@
+// -------------------------- bufferedbintree.cpp -----------------------------
+// Implementation file for the BufferedBinTree class. A BinTree whose
+// inserts are buffered in sorted runs and merged into it in batches.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Runs are ordered oldest first, and merges only join the two newest, so
+//   on equal data the run nearer the front always holds the first insert.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <utility>
+#include "bufferedbintree.h"
+
+using namespace std;
+
+namespace
+{
+	// <summary>
+	// Orders data pointers by the data they point to.
+	// </summary>
+	bool lessData(const NodeData* left, const NodeData* right)
+	{
+		return left->compare(*right) < 0;
+	}
+}
+
+////////////////////// Constructor ////////////////////////
+// <summary>
+// Creates an empty tree.
+// </summary>
+BufferedBinTree::BufferedBinTree(bool balanced, int batchSize)
+	: tree(balanced), balanced(balanced),
+	batchSize((batchSize > 0) ? batchSize : 1), count(0)
+{
+	tail.reserve(TAIL_SIZE);
+}
+
+/////////////////////// Destructor ////////////////////////
+// <summary>
+// Deletes all data, buffered or in the tree.
+// </summary>
+BufferedBinTree::~BufferedBinTree()
+{
+	deleteBuffer();
+}
+
+///////////////////////// Insert //////////////////////////
+// <summary>
+// Function to buffer data for insertion. Appends to the tail, which is
+// sealed into a run once full. Flushes once batchSize data are buffered
+// and the buffer is as large as the tree, so a flush costs O(1) per data
+// however large the tree grows, and the tree about doubles each time.
+// </summary>
+void BufferedBinTree::insert(NodeData* data)
+{
+	tail.push_back(data);
+	count++;
+
+	if (static_cast<int>(tail.size()) == TAIL_SIZE)
+	{
+		sealTail();
+	}
+
+	if (count >= batchSize && count >= tree.size())
+	{
+		flush();
+	}
+}
+
+//////////////////////// Retrieve /////////////////////////
+// <summary>
+// Function to search for the passed data in the tree and the buffer,
+// sets it to retrieveData if found. Searches from oldest to newest, so
+// the data found first is the one that will be kept.
+// </summary>
+// <returns>
+// Returns true if the data is found and set, false otherwise.
+// </returns>
+bool BufferedBinTree::retrieve(const NodeData &data,
+	NodeData* &retrieveData) const
+{
+	if (tree.retrieve(data, retrieveData))
+	{
+		return true;
+	}
+
+	for (const vector<NodeData*> &run : runs)
+	{
+		if (findInRun(run, data, retrieveData))
+		{
+			return true;
+		}
+	}
+
+	for (NodeData* current : tail)
+	{
+		if (current->compare(data) == 0)
+		{
+			retrieveData = current;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//////////////////////// Is Empty /////////////////////////
+// <summary>
+// Returns true if nothing is in the tree or the buffer, false otherwise.
+// </summary>
+bool BufferedBinTree::isEmpty() const
+{
+	return count == 0 && tree.isEmpty();
+}
+
+////////////////////////// Size ///////////////////////////
+// <summary>
+// Flushes the buffer, then returns the number of data in the tree.
+// </summary>
+int BufferedBinTree::size()
+{
+	flush();
+	return tree.size();
+}
+
+//////////////////////// Buffered /////////////////////////
+// <summary>
+// Returns the number of data waiting in the buffer.
+// </summary>
+int BufferedBinTree::buffered() const
+{
+	return count;
+}
+
+////////////////////////// Flush //////////////////////////
+// <summary>
+// Merges everything buffered into the tree. The runs are merged into one
+// sorted array, linked into a batch tree in O(m) and joined with the tree
+// by unionWith, which keeps the tree's data on ties and deletes the
+// batch's.
+// </summary>
+void BufferedBinTree::flush()
+{
+	if (!tail.empty())
+	{
+		sealTail();
+	}
+
+	while (runs.size() > 1)
+	{
+		mergeRuns();
+	}
+
+	if (runs.empty())
+	{
+		return;
+	}
+
+	BinTree batch(balanced);
+	vector<NodeData*> &run = runs.back();
+
+	batch.bulkLoad(run.data(), static_cast<int>(run.size()));
+	runs.clear();
+	count = 0;
+	tree.unionWith(move(batch));
+}
+
+//////////////////////// Get Tree /////////////////////////
+// <summary>
+// Flushes the buffer and returns the tree.
+// </summary>
+BinTree& BufferedBinTree::getTree()
+{
+	flush();
+	return tree;
+}
+
+/////////////////////// Make Empty ////////////////////////
+// <summary>
+// Deletes all data, buffered or in the tree.
+// </summary>
+void BufferedBinTree::makeEmpty()
+{
+	deleteBuffer();
+	tree.makeEmpty();
+}
+
+/////////////////////// Seal Tail /////////////////////////
+// <summary>
+// Helper function that sorts the tail into a new run, deleting repeats
+// after the first, then merges the newest runs while the older of two is
+// no larger than the newer.
+// </summary>
+void BufferedBinTree::sealTail()
+{
+	stable_sort(tail.begin(), tail.end(), lessData);
+
+	vector<NodeData*> run;
+	run.reserve(tail.size());
+
+	for (NodeData* data : tail)
+	{
+		if (!run.empty() && run.back()->compare(*data) == 0)
+		{
+			delete data;					// a later insert of equal data
+			count--;
+		}
+		else
+		{
+			run.push_back(data);
+		}
+	}
+
+	tail.clear();
+	runs.push_back(move(run));
+
+	while (runs.size() > 1
+		&& runs[runs.size() - 2].size() <= runs.back().size())
+	{
+		mergeRuns();
+	}
+}
+
+/////////////////////// Merge Runs ////////////////////////
+// <summary>
+// Helper function that merges the two newest runs into one, deleting
+// the data of the newer run that the older run already holds.
+// </summary>
+void BufferedBinTree::mergeRuns()
+{
+	vector<NodeData*> &older = runs[runs.size() - 2];
+	vector<NodeData*> &newer = runs.back();
+	size_t i = 0;
+	size_t j = 0;
+
+	scratch.clear();
+	scratch.reserve(older.size() + newer.size());
+
+	while (i < older.size() && j < newer.size())
+	{
+		int order = older[i]->compare(*newer[j]);
+
+		if (order < 0)
+		{
+			scratch.push_back(older[i++]);
+		}
+		else if (order > 0)
+		{
+			scratch.push_back(newer[j++]);
+		}
+		else
+		{
+			scratch.push_back(older[i++]);
+			delete newer[j++];
+			count--;
+		}
+	}
+
+	scratch.insert(scratch.end(), older.begin() + i, older.end());
+	scratch.insert(scratch.end(), newer.begin() + j, newer.end());
+
+	older.swap(scratch);
+	runs.pop_back();
+}
+
+/////////////////////// Delete Buffer /////////////////////
+// <summary>
+// Helper function that deletes the data of the tail and the runs.
+// </summary>
+void BufferedBinTree::deleteBuffer()
+{
+	for (NodeData* data : tail)
+	{
+		delete data;
+	}
+
+	for (vector<NodeData*> &run : runs)
+	{
+		for (NodeData* data : run)
+		{
+			delete data;
+		}
+	}
+
+	tail.clear();
+	runs.clear();
+	count = 0;
+}
+
+/////////////////////// Find In Run ///////////////////////
+// <summary>
+// Helper function that binary searches a run for the passed data.
+// </summary>
+// <returns>
+// Returns true if the data is found and set, false otherwise.
+// </returns>
+bool BufferedBinTree::findInRun(const vector<NodeData*> &run,
+	const NodeData &data, NodeData* &found)
+{
+	size_t low = 0;
+	size_t high = run.size();
+
+	while (low < high)
+	{
+		size_t middle = low + (high - low) / 2;
+
+		if (run[middle]->compare(data) < 0)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	if (low == run.size() || run[low]->compare(data) != 0)
+	{
+		return false;
+	}
+
+	found = run[low];
+	return true;
+}
@@ -0,0 +1,163 @@
+// --------------------------- bufferedbintree.h ------------------------------
+// Header file for the BufferedBinTree class. BufferedBinTree is a BinTree
+// with a write-optimized insert for bursts of many inserts and few reads.
+//
+// An insert does not walk the tree. It appends the data to a short tail;
+// each full tail is sorted into a run, and runs of similar size are merged
+// like the levels of a log-structured merge tree, so the buffer stays a
+// handful of sorted arrays. Once the buffer holds at least batchSize data
+// and as many as the tree, it is merged into the tree in one pass with
+// BinTree::unionWith, which splits the tree around the sorted batch
+// instead of chasing one root-to-leaf path per data. Lookups search the
+// tree, the runs and the tail, so they see buffered data at once.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - insert cannot tell whether the data is a duplicate without the search
+//   it avoids, so it always takes ownership. As with buildTree, the first
+//   data inserted is kept and later equal data is deleted, when the runs
+//   are merged or when the batch reaches the tree.
+// - Pointers returned by retrieve stay valid until the data is removed or
+//   the tree is emptied; merging moves pointers, not data.
+// - Not thread-safe, like BinTree.
+// ----------------------------------------------------------------------------
+
+#ifndef BUFFEREDBINTREE_H
+#define BUFFEREDBINTREE_H
+
+#include <vector>
+#include "bintree.h"
+#include "nodedata.h"
+
+using namespace std;
+
+class BufferedBinTree
+{
+public:
+	static const int DEFAULT_BATCH = 1 << 16;	// data buffered per flush
+
+	////////////////////// Constructor ////////////////////////
+	// <summary>
+	// Creates an empty tree.
+	// </summary>
+	// <parameter = "balanced">
+	// Passed to the BinTree. Flushes into a balanced tree cost
+	// O(m log(n/m + 1)); into an unbalanced one they cost O(n + m).
+	// </parameter>
+	// <parameter = "batchSize">
+	// Smallest number of buffered data that triggers a flush. Larger trees
+	// wait for a buffer as large as themselves.
+	// </parameter>
+	explicit BufferedBinTree(bool balanced = true,
+		int batchSize = DEFAULT_BATCH);
+
+	/////////////////////// Destructor ////////////////////////
+	// <summary>
+	// Deletes all data, buffered or in the tree.
+	// </summary>
+	~BufferedBinTree();
+
+	BufferedBinTree(const BufferedBinTree&) = delete;
+	BufferedBinTree& operator=(const BufferedBinTree&) = delete;
+
+	///////////////////////// Insert //////////////////////////
+	// <summary>
+	// Function to buffer data for insertion. Takes ownership of data even
+	// when equal data is already present; the duplicate is deleted later.
+	// Amortized O(log b) for b buffered data, plus the share of a flush.
+	// </summary>
+	void insert(NodeData* data);
+
+	//////////////////////// Retrieve /////////////////////////
+	// <summary>
+	// Function to search for the passed data in the tree and the buffer,
+	// sets it to retrieveData if found. Where equal data was inserted more
+	// than once, the one that will be kept is returned. Costs a tree search,
+	// a binary search of each of the O(log b) runs and a scan of the tail.
+	// </summary>
+	// <returns>
+	// Returns true if the data is found and set, false otherwise.
+	// </returns>
+	bool retrieve(const NodeData &data, NodeData* &retrieveData) const;
+
+	//////////////////////// Is Empty /////////////////////////
+	// <summary>
+	// Returns true if nothing is in the tree or the buffer, false otherwise.
+	// </summary>
+	bool isEmpty() const;
+
+	////////////////////////// Size ///////////////////////////
+	// <summary>
+	// Flushes the buffer, then returns the number of data in the tree.
+	// </summary>
+	int size();
+
+	//////////////////////// Buffered /////////////////////////
+	// <summary>
+	// Returns the number of data waiting in the buffer, duplicates not yet
+	// found included.
+	// </summary>
+	int buffered() const;
+
+	////////////////////////// Flush //////////////////////////
+	// <summary>
+	// Merges everything buffered into the tree.
+	// </summary>
+	void flush();
+
+	//////////////////////// Get Tree /////////////////////////
+	// <summary>
+	// Flushes the buffer and returns the tree, for reads and changes that
+	// BufferedBinTree does not offer itself.
+	// </summary>
+	BinTree& getTree();
+
+	/////////////////////// Make Empty ////////////////////////
+	// <summary>
+	// Deletes all data, buffered or in the tree.
+	// </summary>
+	void makeEmpty();
+
+private:
+	static const int TAIL_SIZE = 64;		// unsorted inserts before a run
+
+	BinTree tree;
+	bool balanced;
+	int batchSize;
+	int count;								// data in tail and runs
+	vector<NodeData*> tail;					// newest inserts, unsorted
+	vector<vector<NodeData*>> runs;			// sorted, repeat-free, oldest first
+	vector<NodeData*> scratch;				// merge output, reused
+
+	/////////////////////// Seal Tail /////////////////////////
+	// <summary>
+	// Helper function that sorts the tail into a new run, then merges the
+	// newest runs while the older of two is no larger than the newer, which
+	// keeps run sizes shrinking geometrically from oldest to newest.
+	// </summary>
+	void sealTail();
+
+	/////////////////////// Merge Runs ////////////////////////
+	// <summary>
+	// Helper function that merges the two newest runs into one, deleting
+	// the data of the newer run that the older run already holds.
+	// </summary>
+	void mergeRuns();
+
+	/////////////////////// Delete Buffer /////////////////////
+	// <summary>
+	// Helper function that deletes the data of the tail and the runs.
+	// </summary>
+	void deleteBuffer();
+
+	/////////////////////// Find In Run ///////////////////////
+	// <summary>
+	// Helper function that binary searches a run for the passed data.
+	// </summary>
+	// <returns>
+	// Returns true if the data is found and set, false otherwise.
+	// </returns>
+	static bool findInRun(const vector<NodeData*> &run, const NodeData &data,
+		NodeData* &found);
+};
+
+#endif
@@ -0,0 +1,644 @@
+// ------------------------- concurrentbintree.cpp ----------------------------
+// Implementation file for the ConcurrentBinTree class. ConcurrentBinTree is
+// a binary search tree of NodeData with lock-free readers and one writer at
+// a time, using path copying and epoch-based reclamation.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Published nodes are never written again, so readers need no more than
+//   an acquire load of the root to see them fully built.
+// - A node retired during epoch e is freed when the epoch moves from e + 1
+//   to e + 2, which only happens once no reader registered under e is left.
+//   Readers registered under e + 1 or later loaded their root after the node
+//   was unlinked.
+// ----------------------------------------------------------------------------
+
+#include "concurrentbintree.h"
+
+using namespace std;
+
+////////////////// Default Constructor ////////////////////
+// <summary>
+// Creates an empty tree.
+// </summary>
+ConcurrentBinTree::ConcurrentBinTree() : root(nullptr), epoch(0)
+{
+	for (int i = 0; i < STRIPES; i++)
+	{
+		stripes[i].readers[0].store(0);
+		stripes[i].readers[1].store(0);
+	}
+
+	retiredSinceReclaim = 0;
+}
+
+/////////////////////// Destructor ////////////////////////
+// <summary>
+// Deletes all data, including data removed but not yet reclaimed. Nodes go
+// with the pool.
+// </summary>
+ConcurrentBinTree::~ConcurrentBinTree()
+{
+	vector<const Node*> stack;
+
+	if (root.load() != nullptr)
+	{
+		stack.push_back(root.load());
+	}
+
+	while (!stack.empty())
+	{
+		const Node* current = stack.back();
+		stack.pop_back();
+		delete current->data;
+
+		if (current->left != nullptr)
+		{
+			stack.push_back(current->left);
+		}
+
+		if (current->right != nullptr)
+		{
+			stack.push_back(current->right);
+		}
+	}
+
+	for (int parity = 0; parity < 2; parity++)
+	{
+		for (NodeData* data : retiredData[parity])
+		{
+			delete data;
+		}
+	}
+}
+
+//////////////////////// Is Empty /////////////////////////
+// <summary>
+// Returns true if the tree has no data, false otherwise.
+// </summary>
+bool ConcurrentBinTree::isEmpty() const
+{
+	return root.load(memory_order_acquire) == nullptr;
+}
+
+////////////////////////// Size ///////////////////////////
+// <summary>
+// Returns the number of data in the tree.
+// </summary>
+int ConcurrentBinTree::size() const
+{
+	Pin pin = enter();
+	int count = nodeSize(root.load(memory_order_acquire));
+	leave(pin);
+	return count;
+}
+
+//////////////////////// Retrieve /////////////////////////
+// <summary>
+// Function to search for the passed data in the tree, sets it to
+// retrieveData if found. Lock-free.
+// </summary>
+// <returns>
+// Returns true if the data is found and set, false otherwise.
+// </returns>
+bool ConcurrentBinTree::retrieve(const NodeData &data,
+	NodeData* &retrieveData) const
+{
+	Pin pin = enter();
+	const Node* found = findNode(data, root.load(memory_order_acquire));
+
+	if (found != nullptr)
+	{
+		retrieveData = found->data;
+	}
+
+	leave(pin);
+	return found != nullptr;
+}
+
+/////////////////////// Get Height ////////////////////////
+// <summary>
+// Function to get the height of the tree at the node containing the
+// data parameter. Lock-free.
+// </summary>
+// <returns>
+// Returns the height at the data, 0 if data is not found.
+// </returns>
+int ConcurrentBinTree::getHeight(const NodeData &data) const
+{
+	Pin pin = enter();
+	int height = nodeHeight(findNode(data, root.load(memory_order_acquire)));
+	leave(pin);
+	return height;
+}
+
+///////////////////////// Insert //////////////////////////
+// <summary>
+// Function to insert data into the tree. Copies the path to the new leaf,
+// rebalances the copies, and publishes the new root.
+// </summary>
+// <returns>
+// Returns true if inserted, false if equal data is already in the tree;
+// the tree then does not take ownership of data.
+// </returns>
+bool ConcurrentBinTree::insert(NodeData* data)
+{
+	lock_guard<mutex> guard(writeLock);
+	const Node* current = root.load(memory_order_relaxed);
+	const Node* updated = insert(current, data);
+
+	if (updated == current)
+	{
+		return false;
+	}
+
+	root.store(updated, memory_order_release);
+	reclaim();
+	return true;
+}
+
+///////////////////////// Remove //////////////////////////
+// <summary>
+// Function to remove the data equal to the passed data. The removed data
+// is deleted once no reader can still see it.
+// </summary>
+// <returns>
+// Returns true if the data was found and removed, false otherwise.
+// </returns>
+bool ConcurrentBinTree::remove(const NodeData &data)
+{
+	lock_guard<mutex> guard(writeLock);
+	NodeData* removed = nullptr;
+	const Node* updated = remove(root.load(memory_order_relaxed), data,
+		removed);
+
+	if (removed == nullptr)
+	{
+		return false;
+	}
+
+	root.store(updated, memory_order_release);
+	retiredData[epoch.load() & 1].push_back(removed);
+	reclaim();
+	return true;
+}
+
+//////////////////////// Snapshot /////////////////////////
+// <summary>
+// Pins tree and takes its current root. Everything reachable from that
+// root stays allocated until the Snapshot is destroyed.
+// </summary>
+ConcurrentBinTree::Snapshot::Snapshot(const ConcurrentBinTree &tree)
+	: tree(tree)
+{
+	pin = tree.enter();
+	root = tree.root.load(memory_order_acquire);
+}
+
+ConcurrentBinTree::Snapshot::~Snapshot()
+{
+	tree.leave(pin);
+}
+
+bool ConcurrentBinTree::Snapshot::isEmpty() const
+{
+	return root == nullptr;
+}
+
+int ConcurrentBinTree::Snapshot::size() const
+{
+	return nodeSize(root);
+}
+
+bool ConcurrentBinTree::Snapshot::retrieve(const NodeData &data,
+	NodeData* &retrieveData) const
+{
+	const Node* found = findNode(data, root);
+
+	if (found == nullptr)
+	{
+		return false;
+	}
+
+	retrieveData = found->data;
+	return true;
+}
+
+int ConcurrentBinTree::Snapshot::getHeight(const NodeData &data) const
+{
+	return nodeHeight(findNode(data, root));
+}
+
+ConcurrentBinTree::Snapshot::Iterator
+ConcurrentBinTree::Snapshot::begin() const
+{
+	Iterator first;
+	first.descend(root);
+	return first;
+}
+
+ConcurrentBinTree::Snapshot::Iterator ConcurrentBinTree::Snapshot::end() const
+{
+	return Iterator();
+}
+
+//////////////////////// Iterator /////////////////////////
+// <summary>
+// Forward iterator over a Snapshot. The top of path is the current node;
+// the nodes below it are ancestors whose data comes next.
+// </summary>
+ConcurrentBinTree::Snapshot::Iterator::Iterator()
+{
+}
+
+ConcurrentBinTree::Snapshot::Iterator::reference
+ConcurrentBinTree::Snapshot::Iterator::operator*() const
+{
+	return *path.back()->data;
+}
+
+ConcurrentBinTree::Snapshot::Iterator::pointer
+ConcurrentBinTree::Snapshot::Iterator::operator->() const
+{
+	return path.back()->data;
+}
+
+ConcurrentBinTree::Snapshot::Iterator&
+ConcurrentBinTree::Snapshot::Iterator::operator++()
+{
+	const Node* current = path.back();
+	path.pop_back();
+	descend(current->right);
+	return *this;
+}
+
+ConcurrentBinTree::Snapshot::Iterator
+ConcurrentBinTree::Snapshot::Iterator::operator++(int)
+{
+	Iterator previous = *this;
+	++(*this);
+	return previous;
+}
+
+bool ConcurrentBinTree::Snapshot::Iterator::operator==(
+	const Iterator &other) const
+{
+	if (path.empty() || other.path.empty())
+	{
+		return path.empty() == other.path.empty();
+	}
+
+	return path.back() == other.path.back();
+}
+
+bool ConcurrentBinTree::Snapshot::Iterator::operator!=(
+	const Iterator &other) const
+{
+	return !(*this == other);
+}
+
+// <summary>
+// Pushes node and its left spine, leaving the smallest data of the subtree
+// on top.
+// </summary>
+void ConcurrentBinTree::Snapshot::Iterator::descend(const Node* node)
+{
+	while (node != nullptr)
+	{
+		path.push_back(node);
+		node = node->left;
+	}
+}
+
+///////////////////////// Enter ///////////////////////////
+// <summary>
+// Registers the calling thread as a reader in the current epoch. The epoch
+// is checked again after registering; if it moved in between, the count
+// may have gone to an epoch a writer already found empty, so the reader
+// backs out and tries again.
+// </summary>
+ConcurrentBinTree::Pin ConcurrentBinTree::enter() const
+{
+	static atomic<int> nextStripe(0);
+	thread_local int stripe = nextStripe.fetch_add(1) % STRIPES;
+
+	for (;;)
+	{
+		uint64_t current = epoch.load();
+		int parity = static_cast<int>(current & 1);
+		stripes[stripe].readers[parity].fetch_add(1);
+
+		if (epoch.load() == current)
+		{
+			return Pin{stripe, parity};
+		}
+
+		stripes[stripe].readers[parity].fetch_sub(1);
+	}
+}
+
+////////////////////////// Leave //////////////////////////
+// <summary>
+// Ends a read registered by enter.
+// </summary>
+void ConcurrentBinTree::leave(Pin pin) const
+{
+	stripes[pin.stripe].readers[pin.parity].fetch_sub(1);
+}
+
+/////////////////////// Find Node /////////////////////////
+// <summary>
+// Helper function to find the node containing the passed data under node.
+// </summary>
+// <returns>
+// Returns the found node, nullptr if there is none.
+// </returns>
+const ConcurrentBinTree::Node* ConcurrentBinTree::findNode(
+	const NodeData &data, const Node* node)
+{
+	while (node != nullptr)
+	{
+		int order = data.compare(*(node->data));
+
+		if (order == 0)
+		{
+			return node;
+		}
+
+		node = (order < 0) ? node->left : node->right;
+	}
+
+	return nullptr;
+}
+
+////////////////////// Make Node //////////////////////////
+// <summary>
+// Helper function that allocates a node with the passed fields and
+// computes its height and size.
+// </summary>
+const ConcurrentBinTree::Node* ConcurrentBinTree::makeNode(NodeData* data,
+	const Node* left, const Node* right)
+{
+	Node* node = pool.allocate();
+	int leftHeight = nodeHeight(left);
+	int rightHeight = nodeHeight(right);
+
+	node->data = data;
+	node->left = left;
+	node->right = right;
+	node->height = 1 + ((leftHeight > rightHeight) ? leftHeight : rightHeight);
+	node->size = 1 + nodeSize(left) + nodeSize(right);
+	return node;
+}
+
+//////////////////////// Balance //////////////////////////
+// <summary>
+// Helper function that builds a node from data, left and right, rotating
+// once or twice when the heights differ by two. Nodes taken apart by a
+// rotation are retired and rebuilt.
+// </summary>
+// <returns>
+// Returns the root of the new, balanced subtree.
+// </returns>
+const ConcurrentBinTree::Node* ConcurrentBinTree::balance(NodeData* data,
+	const Node* left, const Node* right)
+{
+	int difference = nodeHeight(left) - nodeHeight(right);
+
+	if (difference > 1)
+	{
+		retire(left);
+
+		if (nodeHeight(left->left) >= nodeHeight(left->right))
+		{
+			return makeNode(left->data, left->left,
+				makeNode(data, left->right, right));
+		}
+
+		const Node* pivot = left->right;
+		retire(pivot);
+		return makeNode(pivot->data, makeNode(left->data, left->left, pivot->left),
+			makeNode(data, pivot->right, right));
+	}
+
+	if (difference < -1)
+	{
+		retire(right);
+
+		if (nodeHeight(right->right) >= nodeHeight(right->left))
+		{
+			return makeNode(right->data, makeNode(data, left, right->left),
+				right->right);
+		}
+
+		const Node* pivot = right->left;
+		retire(pivot);
+		return makeNode(pivot->data, makeNode(data, left, pivot->left),
+			makeNode(right->data, pivot->right, right->right));
+	}
+
+	return makeNode(data, left, right);
+}
+
+////////////////////// Insert Helper //////////////////////
+// <summary>
+// Helper function for insert. Recursion depth is the AVL height.
+// </summary>
+// <returns>
+// Returns the new root of the subtree, node itself if data was already
+// there.
+// </returns>
+const ConcurrentBinTree::Node* ConcurrentBinTree::insert(const Node* node,
+	NodeData* data)
+{
+	if (node == nullptr)
+	{
+		return makeNode(data, nullptr, nullptr);
+	}
+
+	int order = data->compare(*(node->data));
+
+	if (order == 0)
+	{
+		return node;
+	}
+
+	const Node* left = node->left;
+	const Node* right = node->right;
+
+	if (order < 0)
+	{
+		left = insert(left, data);
+
+		if (left == node->left)
+		{
+			return node;
+		}
+	}
+	else
+	{
+		right = insert(right, data);
+
+		if (right == node->right)
+		{
+			return node;
+		}
+	}
+
+	retire(node);
+	return balance(node->data, left, right);
+}
+
+////////////////////// Remove Helper //////////////////////
+// <summary>
+// Helper function for remove. Sets removed to the data taken out, leaves
+// it unchanged if there was none. A node with two children takes the
+// smallest data of its right subtree.
+// </summary>
+// <returns>
+// Returns the new root of the subtree.
+// </returns>
+const ConcurrentBinTree::Node* ConcurrentBinTree::remove(const Node* node,
+	const NodeData &data, NodeData* &removed)
+{
+	if (node == nullptr)
+	{
+		return nullptr;
+	}
+
+	int order = data.compare(*(node->data));
+
+	if (order == 0)
+	{
+		removed = node->data;
+		retire(node);
+
+		if (node->left == nullptr)
+		{
+			return node->right;
+		}
+
+		if (node->right == nullptr)
+		{
+			return node->left;
+		}
+
+		NodeData* successor = nullptr;
+		const Node* right = removeMin(node->right, successor);
+		return balance(successor, node->left, right);
+	}
+
+	const Node* left = node->left;
+	const Node* right = node->right;
+
+	if (order < 0)
+	{
+		left = remove(left, data, removed);
+	}
+	else
+	{
+		right = remove(right, data, removed);
+	}
+
+	if (removed == nullptr)
+	{
+		return node;
+	}
+
+	retire(node);
+	return balance(node->data, left, right);
+}
+
+//////////////////// Remove Min Helper ////////////////////
+// <summary>
+// Helper function for remove. Takes the smallest data out of the subtree
+// at node, which must not be empty, and sets it to removed.
+// </summary>
+// <returns>
+// Returns the new root of the subtree.
+// </returns>
+const ConcurrentBinTree::Node* ConcurrentBinTree::removeMin(const Node* node,
+	NodeData* &removed)
+{
+	retire(node);
+
+	if (node->left == nullptr)
+	{
+		removed = node->data;
+		return node->right;
+	}
+
+	const Node* left = removeMin(node->left, removed);
+	return balance(node->data, left, node->right);
+}
+
+///////////////////////// Retire //////////////////////////
+// <summary>
+// Helper function that queues node to be freed once no reader can still
+// reach it. Only the writer calls this, so a plain epoch read is enough.
+// </summary>
+void ConcurrentBinTree::retire(const Node* node)
+{
+	retiredNodes[epoch.load() & 1].push_back(node);
+	retiredSinceReclaim++;
+}
+
+//////////////////////// Reclaim //////////////////////////
+// <summary>
+// Helper function that advances the epoch from e to e + 1 if no reader is
+// left under e - 1, then frees what was retired during e - 1, which shares
+// a parity with e + 1 and is about to collect its retirements. Runs once
+// every RECLAIM_BATCH retirements and never waits; if readers are still
+// there it tries again after the next write.
+// </summary>
+void ConcurrentBinTree::reclaim()
+{
+	if (retiredSinceReclaim < RECLAIM_BATCH)
+	{
+		return;
+	}
+
+	uint64_t current = epoch.load();
+	int previous = static_cast<int>((current + 1) & 1);
+
+	for (int i = 0; i < STRIPES; i++)
+	{
+		if (stripes[i].readers[previous].load() != 0)
+		{
+			return;
+		}
+	}
+
+	epoch.store(current + 1);
+
+	for (const Node* node : retiredNodes[previous])
+	{
+		pool.release(const_cast<Node*>(node));
+	}
+
+	for (NodeData* data : retiredData[previous])
+	{
+		delete data;
+	}
+
+	retiredNodes[previous].clear();
+	retiredData[previous].clear();
+	retiredSinceReclaim = 0;
+}
+
+////////////////////// Node Height ////////////////////////
+// <summary>
+// Returns the stored height of node, 0 for an empty subtree.
+// </summary>
+int ConcurrentBinTree::nodeHeight(const Node* node)
+{
+	return (node == nullptr) ? 0 : node->height;
+}
+
+/////////////////////// Node Size /////////////////////////
+// <summary>
+// Returns the stored size of node, 0 for an empty subtree.
+// </summary>
+int ConcurrentBinTree::nodeSize(const Node* node)
+{
+	return (node == nullptr) ? 0 : node->size;
+}
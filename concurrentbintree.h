@@ -0,0 +1,322 @@
+// -------------------------- concurrentbintree.h -----------------------------
+// Header file for the ConcurrentBinTree class. ConcurrentBinTree is a binary
+// search tree of NodeData that any number of threads may read while another
+// thread writes. Readers take no locks and never wait.
+//
+// Writers never change a node that readers can see. An insert or remove
+// copies the nodes on the path it changes, then publishes the new root with
+// one atomic store, so each reader works on the whole tree as it was when
+// the reader started. The replaced nodes are retired, not freed, and are
+// reclaimed by epoch-based reclamation once no reader that might still hold
+// them is left.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - The tree is always AVL-balanced, so every path copied is O(log n) long.
+// - Writers are serialized by an internal mutex; one writer at a time runs
+//   alongside the readers.
+// - Data is owned by the tree, as in BinTree. Data found by retrieve may be
+//   reclaimed after a concurrent remove; use a Snapshot to keep it valid
+//   for as long as it is used.
+// - A Snapshot that is held for a long time delays reclamation, but never
+//   blocks writers or other readers.
+// - The tree must not be destroyed while any thread is still using it.
+// ----------------------------------------------------------------------------
+
+#ifndef CONCURRENTBINTREE_H
+#define CONCURRENTBINTREE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <vector>
+#include "nodedata.h"
+#include "nodepool.h"
+
+using namespace std;
+
+class ConcurrentBinTree
+{
+	struct Node
+	{
+		NodeData* data;
+		const Node* left;
+		const Node* right;
+		int height;					// height of the subtree, 1 for a leaf
+		int size;					// number of nodes in the subtree
+	};
+
+	// <summary>
+	// Stripe and parity a reader registered under.
+	// </summary>
+	struct Pin
+	{
+		int stripe;
+		int parity;
+	};
+
+public:
+	////////////////// Default Constructor ////////////////////
+	// <summary>
+	// Creates an empty tree.
+	// </summary>
+	ConcurrentBinTree();
+
+	/////////////////////// Destructor ////////////////////////
+	// <summary>
+	// Deletes all data and nodes, including retired ones.
+	// </summary>
+	~ConcurrentBinTree();
+
+	ConcurrentBinTree(const ConcurrentBinTree&) = delete;
+	ConcurrentBinTree& operator=(const ConcurrentBinTree&) = delete;
+
+	//////////////////////// Is Empty /////////////////////////
+	// <summary>
+	// Returns true if the tree has no data, false otherwise.
+	// </summary>
+	bool isEmpty() const;
+
+	////////////////////////// Size ///////////////////////////
+	// <summary>
+	// Returns the number of data in the tree.
+	// </summary>
+	int size() const;
+
+	//////////////////////// Retrieve /////////////////////////
+	// <summary>
+	// Function to search for the passed data in the tree, sets it to
+	// retrieveData if found. Lock-free.
+	// </summary>
+	// <returns>
+	// Returns true if the data is found and set, false otherwise.
+	// </returns>
+	bool retrieve(const NodeData &data, NodeData* &retrieveData) const;
+
+	/////////////////////// Get Height ////////////////////////
+	// <summary>
+	// Function to get the height of the tree at the node containing the
+	// data parameter. Lock-free.
+	// </summary>
+	// <returns>
+	// Returns the height at the data, 0 if data is not found.
+	// </returns>
+	int getHeight(const NodeData &data) const;
+
+	///////////////////////// Insert //////////////////////////
+	// <summary>
+	// Function to insert data into the tree. Copies the path to the new leaf,
+	// rebalances the copies, and publishes the new root.
+	// </summary>
+	// <returns>
+	// Returns true if inserted, false if equal data is already in the tree;
+	// the tree then does not take ownership of data.
+	// </returns>
+	bool insert(NodeData* data);
+
+	///////////////////////// Remove //////////////////////////
+	// <summary>
+	// Function to remove the data equal to the passed data. The removed data
+	// is deleted once no reader can still see it.
+	// </summary>
+	// <returns>
+	// Returns true if the data was found and removed, false otherwise.
+	// </returns>
+	bool remove(const NodeData &data);
+
+	//////////////////////// Snapshot /////////////////////////
+	// <summary>
+	// Read-only view of the tree as it was when the Snapshot was made. Holds
+	// off reclamation of everything it can reach, so data found through it
+	// stays valid until the Snapshot is destroyed. Use it on one thread.
+	// </summary>
+	class Snapshot
+	{
+	public:
+		class Iterator;
+
+		// <summary>
+		// Pins tree and takes its current root.
+		// </summary>
+		explicit Snapshot(const ConcurrentBinTree &tree);
+		~Snapshot();
+
+		Snapshot(const Snapshot&) = delete;
+		Snapshot& operator=(const Snapshot&) = delete;
+
+		bool isEmpty() const;
+		int size() const;
+		bool retrieve(const NodeData &data, NodeData* &retrieveData) const;
+		int getHeight(const NodeData &data) const;
+
+		// <summary>
+		// Forward iterators over the data of the Snapshot in sorted order.
+		// </summary>
+		Iterator begin() const;
+		Iterator end() const;
+
+		// <summary>
+		// Forward iterator over a Snapshot. Keeps the path from the root on
+		// an explicit stack, since nodes have no parent links.
+		// </summary>
+		class Iterator
+		{
+		public:
+			typedef forward_iterator_tag iterator_category;
+			typedef NodeData value_type;
+			typedef ptrdiff_t difference_type;
+			typedef const NodeData* pointer;
+			typedef const NodeData& reference;
+
+			Iterator();
+
+			reference operator*() const;
+			pointer operator->() const;
+
+			Iterator& operator++();
+			Iterator operator++(int);
+
+			bool operator==(const Iterator &other) const;
+			bool operator!=(const Iterator &other) const;
+
+		private:
+			friend class Snapshot;
+
+			// <summary>
+			// Pushes node and its left spine.
+			// </summary>
+			void descend(const Node* node);
+
+			vector<const Node*> path;		// ancestors still to visit, top is current
+		};
+
+	private:
+		const ConcurrentBinTree &tree;
+		const Node* root;
+		Pin pin;
+	};
+
+private:
+	static const int STRIPES = 64;			// reader counter stripes
+	static const int RECLAIM_BATCH = 64;	// retirements between reclaims
+
+	// <summary>
+	// Reader counts for the two epoch parities, one cache line per stripe so
+	// readers on different cores do not contend.
+	// </summary>
+	struct alignas(64) Stripe
+	{
+		atomic<int> readers[2];
+	};
+
+	atomic<const Node*> root;
+	mutable atomic<uint64_t> epoch;
+	mutable Stripe stripes[STRIPES];
+
+	mutex writeLock;						// serializes writers
+	NodePool<Node> pool;					// writer-only
+	vector<const Node*> retiredNodes[2];	// by parity of the retiring epoch
+	vector<NodeData*> retiredData[2];
+	int retiredSinceReclaim;
+
+	///////////////////////// Enter ///////////////////////////
+	// <summary>
+	// Registers the calling thread as a reader in the current epoch. The
+	// epoch is checked again after registering, so a reader never counts
+	// under an epoch that has already been closed.
+	// </summary>
+	Pin enter() const;
+
+	////////////////////////// Leave //////////////////////////
+	// <summary>
+	// Ends a read registered by enter.
+	// </summary>
+	void leave(Pin pin) const;
+
+	/////////////////////// Find Node /////////////////////////
+	// <summary>
+	// Helper function to find the node containing the passed data under node.
+	// </summary>
+	// <returns>
+	// Returns the found node, nullptr if there is none.
+	// </returns>
+	static const Node* findNode(const NodeData &data, const Node* node);
+
+	////////////////////// Make Node //////////////////////////
+	// <summary>
+	// Helper function that allocates a node with the passed fields and
+	// computes its height and size.
+	// </summary>
+	const Node* makeNode(NodeData* data, const Node* left, const Node* right);
+
+	//////////////////////// Balance //////////////////////////
+	// <summary>
+	// Helper function that builds a node from data, left and right, rotating
+	// once or twice when the heights differ by two. Nodes taken apart by a
+	// rotation are retired and rebuilt.
+	// </summary>
+	// <returns>
+	// Returns the root of the new, balanced subtree.
+	// </returns>
+	const Node* balance(NodeData* data, const Node* left, const Node* right);
+
+	////////////////////// Insert Helper //////////////////////
+	// <summary>
+	// Helper function for insert. Recursion depth is the AVL height.
+	// </summary>
+	// <returns>
+	// Returns the new root of the subtree, node itself if data was already
+	// there.
+	// </returns>
+	const Node* insert(const Node* node, NodeData* data);
+
+	////////////////////// Remove Helper //////////////////////
+	// <summary>
+	// Helper function for remove. Sets removed to the data taken out, leaves
+	// it unchanged if there was none.
+	// </summary>
+	// <returns>
+	// Returns the new root of the subtree.
+	// </returns>
+	const Node* remove(const Node* node, const NodeData &data,
+		NodeData* &removed);
+
+	//////////////////// Remove Min Helper ////////////////////
+	// <summary>
+	// Helper function for remove. Takes the smallest data out of the subtree
+	// at node, which must not be empty, and sets it to removed.
+	// </summary>
+	// <returns>
+	// Returns the new root of the subtree.
+	// </returns>
+	const Node* removeMin(const Node* node, NodeData* &removed);
+
+	///////////////////////// Retire //////////////////////////
+	// <summary>
+	// Helper function that queues node to be freed once no reader can still
+	// reach it.
+	// </summary>
+	void retire(const Node* node);
+
+	//////////////////////// Reclaim //////////////////////////
+	// <summary>
+	// Helper function that advances the epoch if no reader is left in the
+	// previous one, then frees what was retired two epochs ago. Never waits.
+	// </summary>
+	void reclaim();
+
+	////////////////////// Node Height ////////////////////////
+	// <summary>
+	// Returns the stored height of node, 0 for an empty subtree.
+	// </summary>
+	static int nodeHeight(const Node* node);
+
+	/////////////////////// Node Size /////////////////////////
+	// <summary>
+	// Returns the stored size of node, 0 for an empty subtree.
+	// </summary>
+	static int nodeSize(const Node* node);
+};
+
+#endif
@@ -0,0 +1,266 @@
+// ------------------------ concurrentinserttree.cpp --------------------------
+// Implementation file for the ConcurrentInsertTree class. An insert-only
+// binary search tree of NodeData with lock-free concurrent insert.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Child links go from nullptr to a node once and are never changed again,
+//   so a reader that has loaded a link with acquire order sees that node
+//   fully built and can keep using it.
+// ----------------------------------------------------------------------------
+
+#include "concurrentinserttree.h"
+
+using namespace std;
+
+////////////////// Default Constructor ////////////////////
+// <summary>
+// Creates an empty tree.
+// </summary>
+ConcurrentInsertTree::ConcurrentInsertTree() : root(nullptr)
+{
+	for (int i = 0; i < SHARDS; i++)
+	{
+		shards[i].count.store(0);
+	}
+}
+
+/////////////////////// Destructor ////////////////////////
+// <summary>
+// Deletes all data still in the tree.
+// </summary>
+ConcurrentInsertTree::~ConcurrentInsertTree()
+{
+	makeEmpty();
+}
+
+//////////////////////// Is Empty /////////////////////////
+// <summary>
+// Returns true if the tree has no data, false otherwise.
+// </summary>
+bool ConcurrentInsertTree::isEmpty() const
+{
+	return root.load(memory_order_acquire) == nullptr;
+}
+
+////////////////////////// Size ///////////////////////////
+// <summary>
+// Returns the number of data in the tree. While inserts are running the
+// result is only a momentary count.
+// </summary>
+int ConcurrentInsertTree::size() const
+{
+	int total = 0;
+
+	for (int i = 0; i < SHARDS; i++)
+	{
+		total += shards[i].count.load(memory_order_relaxed);
+	}
+
+	return total;
+}
+
+//////////////////////// Retrieve /////////////////////////
+// <summary>
+// Function to search for the passed data in the tree, sets it to
+// retrieveData if found. Lock-free.
+// </summary>
+// <returns>
+// Returns true if the data is found and set, false otherwise.
+// </returns>
+bool ConcurrentInsertTree::retrieve(const NodeData &data,
+	NodeData* &retrieveData) const
+{
+	Node* current = root.load(memory_order_acquire);
+
+	while (current != nullptr)
+	{
+		int order = data.compare(*(current->data));
+
+		if (order == 0)
+		{
+			retrieveData = current->data;
+			return true;
+		}
+
+		current = (order < 0) ? current->left.load(memory_order_acquire)
+			: current->right.load(memory_order_acquire);
+	}
+
+	return false;
+}
+
+///////////////////////// Insert //////////////////////////
+// <summary>
+// Function to insert data into the tree. Walks down to an empty child and
+// links a new node there with compare-and-swap. A failed swap leaves the
+// node that won in current, and the walk continues from it, which finds a
+// duplicate if the winner holds equal data. The node is only allocated once
+// an empty child is reached, and handed back if it is never linked.
+// </summary>
+// <returns>
+// Returns true if inserted, false if equal data is already in the tree;
+// the tree then does not take ownership of data.
+// </returns>
+bool ConcurrentInsertTree::insert(NodeData* data)
+{
+	int shard = shardIndex();
+	Node* node = nullptr;
+	atomic<Node*>* link = &root;
+	Node* current = link->load(memory_order_acquire);
+
+	for (;;)
+	{
+		if (current == nullptr)
+		{
+			if (node == nullptr)
+			{
+				node = allocate(data, shard);
+			}
+
+			if (link->compare_exchange_weak(current, node,
+				memory_order_release, memory_order_acquire))
+			{
+				return true;
+			}
+
+			continue;
+		}
+
+		int order = data->compare(*(current->data));
+
+		if (order == 0)
+		{
+			if (node != nullptr)
+			{
+				release(node, shard);
+			}
+
+			return false;
+		}
+
+		link = (order < 0) ? &current->left : &current->right;
+		current = link->load(memory_order_acquire);
+	}
+}
+
+///////////////////////// Move To /////////////////////////
+// <summary>
+// Replaces the contents of tree with all data in this tree, in O(n), and
+// leaves this tree empty. The data is already unique and comes out of the
+// in-order walk sorted, so it goes straight to BinTree::bulkLoad.
+// </summary>
+// <returns>
+// Returns the number of data moved.
+// </returns>
+int ConcurrentInsertTree::moveTo(BinTree &tree)
+{
+	vector<NodeData*> items;
+	items.reserve(size());
+	collect(items);
+	reset();
+	return tree.bulkLoad(items.data(), static_cast<int>(items.size()));
+}
+
+/////////////////////// Make Empty ////////////////////////
+// <summary>
+// Deletes all data in the tree.
+// </summary>
+void ConcurrentInsertTree::makeEmpty()
+{
+	vector<NodeData*> items;
+	collect(items);
+
+	for (NodeData* data : items)
+	{
+		delete data;
+	}
+
+	reset();
+}
+
+/////////////////////// Allocate //////////////////////////
+// <summary>
+// Helper function that takes a node holding data from the passed shard.
+// </summary>
+ConcurrentInsertTree::Node* ConcurrentInsertTree::allocate(NodeData* data,
+	int shard)
+{
+	Shard &owner = shards[shard];
+	Node* node;
+
+	{
+		lock_guard<mutex> guard(owner.lock);
+		node = owner.pool.allocate();
+	}
+
+	owner.count.fetch_add(1, memory_order_relaxed);
+	node->data = data;
+	node->left.store(nullptr, memory_order_relaxed);
+	node->right.store(nullptr, memory_order_relaxed);
+	return node;
+}
+
+//////////////////////// Release //////////////////////////
+// <summary>
+// Helper function that gives back a node that was never linked.
+// </summary>
+void ConcurrentInsertTree::release(Node* node, int shard)
+{
+	Shard &owner = shards[shard];
+	owner.count.fetch_sub(1, memory_order_relaxed);
+
+	lock_guard<mutex> guard(owner.lock);
+	owner.pool.release(node);
+}
+
+/////////////////////// Shard Index ///////////////////////
+// <summary>
+// Returns the shard of the calling thread, handed out round-robin the
+// first time each thread asks.
+// </summary>
+int ConcurrentInsertTree::shardIndex()
+{
+	static atomic<int> nextShard(0);
+	thread_local int shard = nextShard.fetch_add(1) % SHARDS;
+	return shard;
+}
+
+/////////////////////// Collect ///////////////////////////
+// <summary>
+// Helper function that appends the data of the tree to out in sorted
+// order, using an explicit stack.
+// </summary>
+void ConcurrentInsertTree::collect(vector<NodeData*> &out) const
+{
+	vector<Node*> stack;
+	Node* current = root.load(memory_order_acquire);
+
+	while (current != nullptr || !stack.empty())
+	{
+		while (current != nullptr)
+		{
+			stack.push_back(current);
+			current = current->left.load(memory_order_acquire);
+		}
+
+		current = stack.back();
+		stack.pop_back();
+		out.push_back(current->data);
+		current = current->right.load(memory_order_acquire);
+	}
+}
+
+////////////////////////// Reset //////////////////////////
+// <summary>
+// Helper function that drops every node without touching the data.
+// </summary>
+void ConcurrentInsertTree::reset()
+{
+	root.store(nullptr, memory_order_release);
+
+	for (int i = 0; i < SHARDS; i++)
+	{
+		shards[i].pool.releaseAll();
+		shards[i].count.store(0, memory_order_relaxed);
+	}
+}
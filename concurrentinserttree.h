@@ -0,0 +1,160 @@
+// ------------------------- concurrentinserttree.h ---------------------------
+// Header file for the ConcurrentInsertTree class. ConcurrentInsertTree is an
+// insert-only binary search tree of NodeData that many threads can insert
+// into at once, for loading data before handing it to a BinTree.
+//
+// Inserts are lock-free. Nodes are never removed or moved, so once a child
+// link is set it never changes again; an insert walks down the tree and
+// links its node with one compare-and-swap on the empty child it reaches.
+// If another thread won that link first, the insert carries on from the
+// winner, so two threads inserting equal data cannot both succeed.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - The tree is not balanced; the shape follows the insert order, so
+//   sorted input makes every insert walk the whole tree. Input in random
+//   order keeps the expected depth logarithmic.
+// - Like BinTree::insert, insert returns false for data that is already in
+//   the tree and the caller keeps ownership of it, so callers such as
+//   buildTree can delete the rejected data as before.
+// - retrieve may run alongside inserts. moveTo, makeEmpty and destruction
+//   may not.
+// ----------------------------------------------------------------------------
+
+#ifndef CONCURRENTINSERTTREE_H
+#define CONCURRENTINSERTTREE_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "bintree.h"
+#include "nodedata.h"
+#include "nodepool.h"
+
+using namespace std;
+
+class ConcurrentInsertTree
+{
+public:
+	////////////////// Default Constructor ////////////////////
+	// <summary>
+	// Creates an empty tree.
+	// </summary>
+	ConcurrentInsertTree();
+
+	/////////////////////// Destructor ////////////////////////
+	// <summary>
+	// Deletes all data still in the tree.
+	// </summary>
+	~ConcurrentInsertTree();
+
+	ConcurrentInsertTree(const ConcurrentInsertTree&) = delete;
+	ConcurrentInsertTree& operator=(const ConcurrentInsertTree&) = delete;
+
+	//////////////////////// Is Empty /////////////////////////
+	// <summary>
+	// Returns true if the tree has no data, false otherwise.
+	// </summary>
+	bool isEmpty() const;
+
+	////////////////////////// Size ///////////////////////////
+	// <summary>
+	// Returns the number of data in the tree. While inserts are running the
+	// result is only a momentary count.
+	// </summary>
+	int size() const;
+
+	//////////////////////// Retrieve /////////////////////////
+	// <summary>
+	// Function to search for the passed data in the tree, sets it to
+	// retrieveData if found. Lock-free.
+	// </summary>
+	// <returns>
+	// Returns true if the data is found and set, false otherwise.
+	// </returns>
+	bool retrieve(const NodeData &data, NodeData* &retrieveData) const;
+
+	///////////////////////// Insert //////////////////////////
+	// <summary>
+	// Function to insert data into the tree. Lock-free and safe to call from
+	// any number of threads at once.
+	// </summary>
+	// <returns>
+	// Returns true if inserted, false if equal data is already in the tree;
+	// the tree then does not take ownership of data.
+	// </returns>
+	bool insert(NodeData* data);
+
+	///////////////////////// Move To /////////////////////////
+	// <summary>
+	// Replaces the contents of tree with all data in this tree, in O(n), and
+	// leaves this tree empty. tree comes out height-balanced whatever the
+	// insert order was.
+	// </summary>
+	// <returns>
+	// Returns the number of data moved.
+	// </returns>
+	int moveTo(BinTree &tree);
+
+	/////////////////////// Make Empty ////////////////////////
+	// <summary>
+	// Deletes all data in the tree.
+	// </summary>
+	void makeEmpty();
+
+private:
+	struct Node
+	{
+		NodeData* data;
+		atomic<Node*> left;
+		atomic<Node*> right;
+	};
+
+	static const int SHARDS = 16;			// node pools
+
+	// <summary>
+	// A node pool and the count of nodes taken from it. Each thread sticks to
+	// one shard, so threads on different shards never share a lock.
+	// </summary>
+	struct alignas(64) Shard
+	{
+		mutex lock;
+		NodePool<Node> pool;
+		atomic<int> count;
+	};
+
+	atomic<Node*> root;
+	Shard shards[SHARDS];
+
+	/////////////////////// Allocate //////////////////////////
+	// <summary>
+	// Helper function that takes a node holding data from the passed shard.
+	// </summary>
+	Node* allocate(NodeData* data, int shard);
+
+	//////////////////////// Release //////////////////////////
+	// <summary>
+	// Helper function that gives back a node that was never linked.
+	// </summary>
+	void release(Node* node, int shard);
+
+	/////////////////////// Shard Index ///////////////////////
+	// <summary>
+	// Returns the shard of the calling thread.
+	// </summary>
+	static int shardIndex();
+
+	/////////////////////// Collect ///////////////////////////
+	// <summary>
+	// Helper function that appends the data of the tree to out in sorted
+	// order, using an explicit stack.
+	// </summary>
+	void collect(vector<NodeData*> &out) const;
+
+	////////////////////////// Reset //////////////////////////
+	// <summary>
+	// Helper function that drops every node without touching the data.
+	// </summary>
+	void reset();
+};
+
+#endif
@@ -0,0 +1,213 @@
+// -------------------------- eytzingerindex.cpp ------------------------------
+// Implementation file for the EytzingerIndex class. EytzingerIndex is a
+// read-only snapshot of a BinTree laid out for cache-friendly search.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - The index is a snapshot. Later changes to the source BinTree are not
+//   seen; build a new index to pick them up.
+// ----------------------------------------------------------------------------
+
+#include <iterator>
+#include "eytzingerindex.h"
+
+using namespace std;
+
+////////////////// Default Constructor ////////////////////
+// <summary>
+// Creates an empty index.
+// </summary>
+EytzingerIndex::EytzingerIndex()
+{
+	buildLayout();
+}
+
+///////////////////// Tree Constructor ////////////////////
+// <summary>
+// Builds an index from a snapshot of tree. Costs O(n) after the copy of
+// the data.
+// </summary>
+EytzingerIndex::EytzingerIndex(const BinTree &tree)
+{
+	keys.reserve(tree.size());
+	tree.exportTo(back_inserter(keys));
+	buildLayout();
+}
+
+////////////////////////// Size ///////////////////////////
+// <summary>
+// Returns the number of data in the index.
+// </summary>
+int EytzingerIndex::size() const
+{
+	return static_cast<int>(keys.size());
+}
+
+//////////////////////// Retrieve /////////////////////////
+// <summary>
+// Function to search for the passed data in the index, sets retrieveData
+// to the stored copy if found.
+// </summary>
+// <returns>
+// Returns true if the data is found and set, false otherwise.
+// </returns>
+bool EytzingerIndex::retrieve(const NodeData &data,
+	const NodeData* &retrieveData) const
+{
+	int position = search(data, true);
+
+	if (position == size() || keys[position] != data)
+	{
+		return false;
+	}
+
+	retrieveData = &keys[position];
+	return true;
+}
+
+////////////////////// Lower Bound ////////////////////////
+// <summary>
+// Finds the smallest data not less than the passed data, sets foundData
+// to it if found.
+// </summary>
+// <returns>
+// Returns true if such data exists and is set, false otherwise.
+// </returns>
+bool EytzingerIndex::lowerBound(const NodeData &data,
+	const NodeData* &foundData) const
+{
+	return select(search(data, true), foundData);
+}
+
+////////////////////// Upper Bound ////////////////////////
+// <summary>
+// Finds the smallest data strictly greater than the passed data, sets
+// foundData to it if found.
+// </summary>
+// <returns>
+// Returns true if such data exists and is set, false otherwise.
+// </returns>
+bool EytzingerIndex::upperBound(const NodeData &data,
+	const NodeData* &foundData) const
+{
+	return select(search(data, false), foundData);
+}
+
+////////////////////////// Rank ///////////////////////////
+// <summary>
+// Returns the number of data in the index less than the passed data.
+// </summary>
+int EytzingerIndex::rank(const NodeData &data) const
+{
+	return search(data, true);
+}
+
+///////////////////////// Select //////////////////////////
+// <summary>
+// Finds the data at position k of the sorted order, sets foundData to it
+// if 0 <= k < size().
+// </summary>
+// <returns>
+// Returns true if the data is set, false otherwise.
+// </returns>
+bool EytzingerIndex::select(int k, const NodeData* &foundData) const
+{
+	if (k < 0 || k >= size())
+	{
+		return false;
+	}
+
+	foundData = &keys[k];
+	return true;
+}
+
+////////////////////// Count Range ////////////////////////
+// <summary>
+// Returns the number of data d with low <= d <= high, 0 if high < low.
+// </summary>
+int EytzingerIndex::countRange(const NodeData &low, const NodeData &high) const
+{
+	if (high < low)
+	{
+		return 0;
+	}
+
+	return search(high, false) - search(low, true);
+}
+
+/////////////////////// Build Layout //////////////////////
+// <summary>
+// Fills prefixes and ranks from keys with an in-order walk of the implicit
+// tree in which slot k has children 2k and 2k + 1. Slot 0 is unused.
+// </summary>
+void EytzingerIndex::buildLayout()
+{
+	prefixes.assign(keys.size() + 1, 0);
+	ranks.assign(keys.size() + 1, 0);
+	buildLayout(1, 0);
+}
+
+//////////////////// Build Layout Helper //////////////////
+// <summary>
+// Helper function for buildLayout. Assigns sorted positions starting at
+// next to the subtree of slot k in order. Recursion depth is logarithmic.
+// </summary>
+// <returns>
+// Returns the next sorted position not yet assigned.
+// </returns>
+int EytzingerIndex::buildLayout(size_t k, int next)
+{
+	if (k > keys.size())
+	{
+		return next;
+	}
+
+	next = buildLayout(2 * k, next);
+	prefixes[k] = keys[next].getPrefix();
+	ranks[k] = next;
+	return buildLayout(2 * k + 1, next + 1);
+}
+
+//////////////////////// Search ///////////////////////////
+// <summary>
+// Descends the Eytzinger layout for the first position whose data is
+// greater than the passed data, or also equal to it when inclusive. The
+// eight slots three levels below k share one cache line and are prefetched
+// while the current level is compared. Keys are only read when prefixes
+// tie.
+// </summary>
+// <returns>
+// Returns the sorted position found, size() if there is none.
+// </returns>
+int EytzingerIndex::search(const NodeData &data, bool inclusive) const
+{
+	size_t n = keys.size();
+	uint64_t prefix = data.getPrefix();
+	size_t k = 1;
+
+	while (k <= n)
+	{
+#if defined(__GNUC__)
+		// deep levels would point past the end, which is undefined even
+		// without a read
+		if (8 * k < prefixes.size())
+		{
+			__builtin_prefetch(prefixes.data() + 8 * k);
+		}
+#endif
+		int order = (prefixes[k] < prefix) ? -1
+			: (prefixes[k] > prefix) ? 1
+			: keys[ranks[k]].compare(data);
+
+		k = 2 * k + ((order < 0 || (!inclusive && order == 0)) ? 1 : 0);
+	}
+
+	// undo the right turns taken after the last left turn; that slot is the
+	// answer, and 0 means every slot went right
+	while ((k & 1) != 0)
+	{
+		k >>= 1;
+	}
+	k >>= 1;
+
+	return (k == 0) ? static_cast<int>(n) : ranks[k];
+}
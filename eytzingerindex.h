@@ -0,0 +1,162 @@
+// --------------------------- eytzingerindex.h -------------------------------
+// Header file for the EytzingerIndex class. EytzingerIndex is a read-only
+// snapshot of a BinTree laid out for cache-friendly search. The cached key
+// prefixes are stored in Eytzinger (breadth-first) order in one contiguous
+// array, so the top levels of every search share the same few cache lines
+// and each later level is prefetched ahead of time. The keys themselves are
+// kept in sorted order for tie-breaks and sequential range scans.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - The index is a snapshot. Later changes to the source BinTree are not
+//   seen; build a new index to pick them up.
+// - Positions returned by rank and taken by select count from 0 in sorted
+//   order, the same as BinTree.
+// ----------------------------------------------------------------------------
+
+#ifndef EYTZINGERINDEX_H
+#define EYTZINGERINDEX_H
+
+#include <cstdint>
+#include <vector>
+#include "bintree.h"
+#include "nodedata.h"
+
+using namespace std;
+
+class EytzingerIndex
+{
+public:
+	////////////////// Default Constructor ////////////////////
+	// <summary>
+	// Creates an empty index.
+	// </summary>
+	EytzingerIndex();
+
+	///////////////////// Tree Constructor ////////////////////
+	// <summary>
+	// Builds an index from a snapshot of tree. Costs O(n) after the copy of
+	// the data.
+	// </summary>
+	// <parameter = "tree">
+	// BinTree whose data is copied into the index. It is left unchanged.
+	// </parameter>
+	explicit EytzingerIndex(const BinTree &tree);
+
+	////////////////////////// Size ///////////////////////////
+	// <summary>
+	// Returns the number of data in the index.
+	// </summary>
+	int size() const;
+
+	//////////////////////// Retrieve /////////////////////////
+	// <summary>
+	// Function to search for the passed data in the index, sets retrieveData
+	// to the stored copy if found.
+	// </summary>
+	// <returns>
+	// Returns true if the data is found and set, false otherwise.
+	// </returns>
+	bool retrieve(const NodeData &data, const NodeData* &retrieveData) const;
+
+	////////////////////// Lower Bound ////////////////////////
+	// <summary>
+	// Finds the smallest data not less than the passed data, sets foundData
+	// to it if found.
+	// </summary>
+	// <returns>
+	// Returns true if such data exists and is set, false otherwise.
+	// </returns>
+	bool lowerBound(const NodeData &data, const NodeData* &foundData) const;
+
+	////////////////////// Upper Bound ////////////////////////
+	// <summary>
+	// Finds the smallest data strictly greater than the passed data, sets
+	// foundData to it if found.
+	// </summary>
+	// <returns>
+	// Returns true if such data exists and is set, false otherwise.
+	// </returns>
+	bool upperBound(const NodeData &data, const NodeData* &foundData) const;
+
+	////////////////////////// Rank ///////////////////////////
+	// <summary>
+	// Returns the number of data in the index less than the passed data.
+	// </summary>
+	int rank(const NodeData &data) const;
+
+	///////////////////////// Select //////////////////////////
+	// <summary>
+	// Finds the data at position k of the sorted order, sets foundData to it
+	// if 0 <= k < size().
+	// </summary>
+	// <returns>
+	// Returns true if the data is set, false otherwise.
+	// </returns>
+	bool select(int k, const NodeData* &foundData) const;
+
+	////////////////////// Count Range ////////////////////////
+	// <summary>
+	// Returns the number of data d with low <= d <= high, 0 if high < low.
+	// </summary>
+	int countRange(const NodeData &low, const NodeData &high) const;
+
+	//////////////////// For Each In Range ////////////////////
+	// <summary>
+	// Calls visit on each data d with low <= d <= high, in sorted order. One
+	// search finds the start; the rest is a sequential scan.
+	// </summary>
+	template <typename Visit>
+	void forEachInRange(const NodeData &low, const NodeData &high,
+		Visit visit) const;
+
+private:
+	vector<NodeData> keys;					// data in sorted order
+	vector<uint64_t> prefixes;				// key prefixes, Eytzinger order from 1
+	vector<int> ranks;						// sorted position of each Eytzinger slot
+
+	/////////////////////// Build Layout //////////////////////
+	// <summary>
+	// Fills prefixes and ranks from keys with an in-order walk of the implicit
+	// tree in which slot k has children 2k and 2k + 1.
+	// </summary>
+	void buildLayout();
+
+	//////////////////// Build Layout Helper //////////////////
+	// <summary>
+	// Helper function for buildLayout. Assigns sorted positions starting at
+	// next to the subtree of slot k in order. Recursion depth is logarithmic.
+	// </summary>
+	// <returns>
+	// Returns the next sorted position not yet assigned.
+	// </returns>
+	int buildLayout(size_t k, int next);
+
+	//////////////////////// Search ///////////////////////////
+	// <summary>
+	// Descends the Eytzinger layout for the first position whose data is
+	// greater than the passed data, or also equal to it when inclusive.
+	// Compares on the prefixes and only reads a key when prefixes tie.
+	// </summary>
+	// <returns>
+	// Returns the sorted position found, size() if there is none.
+	// </returns>
+	int search(const NodeData &data, bool inclusive) const;
+};
+
+//////////////////// For Each In Range ////////////////////
+// <summary>
+// Calls visit on each data d with low <= d <= high, in sorted order.
+// </summary>
+template <typename Visit>
+void EytzingerIndex::forEachInRange(const NodeData &low, const NodeData &high,
+	Visit visit) const
+{
+	int end = search(high, false);
+
+	for (int i = search(low, true); i < end; i++)
+	{
+		visit(keys[i]);
+	}
+}
+
+#endif
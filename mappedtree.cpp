@@ -0,0 +1,495 @@
+// ------------------------------ mappedtree.cpp ------------------------------
+// Implementation file for the MappedTree class. Saves BinTree data to a
+// compact binary file and queries such files in place through mmap.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - The header is 40 bytes, so the prefix and offset tables that follow it
+//   stay 8-byte aligned in the mapping, which starts on a page.
+// - mmap is used on POSIX systems; elsewhere the file is read into memory.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "mappedtree.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPEDTREE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+	const char MAGIC[8] = "BINTREE";
+	const uint64_t FNV_OFFSET = 14695981039346656037ull;
+	const uint64_t FNV_PRIME = 1099511628211ull;
+	const size_t WRITE_BLOCK = 1 << 16;		// bytes gathered per file write
+}
+
+////////////////// Default Constructor ////////////////////
+// <summary>
+// Creates a tree with no file open.
+// </summary>
+MappedTree::MappedTree()
+	: base(nullptr), length(0), mapped(false), count(0), prefixes(nullptr),
+	offsets(nullptr), keys(nullptr)
+{
+}
+
+/////////////////////// Destructor ////////////////////////
+// <summary>
+// Closes the file, if any.
+// </summary>
+MappedTree::~MappedTree()
+{
+	close();
+}
+
+////////////////////////// Save ///////////////////////////
+// <summary>
+// Writes the data of tree to the file at path in the binary format. The
+// sections are gathered into large blocks and hashed as they are written;
+// the header, which holds the checksum, is written last.
+// </summary>
+// <returns>
+// Returns true if the file was written, false otherwise.
+// </returns>
+bool MappedTree::save(const BinTree &tree, const string &path)
+{
+	static_assert(sizeof(Header) == 40, "header layout");
+
+	vector<const NodeData*> items;
+	Header header = {};
+
+	items.reserve(tree.size());
+	for (const NodeData &data : tree)
+	{
+		items.push_back(&data);
+		header.keyBytes += data.getData().size();
+	}
+
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.byteOrder = BYTE_ORDER_MARK;
+	header.count = items.size();
+
+	string temporary = path + ".tmp";
+	ofstream out(temporary, ios::binary | ios::trunc);
+
+	if (!out)
+	{
+		return false;
+	}
+
+	uint64_t hash = FNV_OFFSET;
+	string block;
+	block.reserve(WRITE_BLOCK);
+
+	auto emit = [&](const void* bytes, size_t size)
+	{
+		if (block.size() + size > WRITE_BLOCK)
+		{
+			hash = checksum(hash, block.data(), block.size());
+			out.write(block.data(), static_cast<streamsize>(block.size()));
+			block.clear();
+		}
+		block.append(static_cast<const char*>(bytes), size);
+	};
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	for (const NodeData* data : items)
+	{
+		uint64_t prefix = data->getPrefix();
+		emit(&prefix, sizeof(prefix));
+	}
+
+	uint64_t offset = 0;
+
+	for (const NodeData* data : items)
+	{
+		emit(&offset, sizeof(offset));
+		offset += data->getData().size();
+	}
+	emit(&offset, sizeof(offset));
+
+	for (const NodeData* data : items)
+	{
+		emit(data->getData().data(), data->getData().size());
+	}
+
+	hash = checksum(hash, block.data(), block.size());
+	out.write(block.data(), static_cast<streamsize>(block.size()));
+
+	header.checksum = hash;
+	out.seekp(0);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.close();
+
+	if (!out || rename(temporary.c_str(), path.c_str()) != 0)
+	{
+		remove(temporary.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+////////////////////////// Open ///////////////////////////
+// <summary>
+// Maps the file at path, closing any file already open, and checks its
+// header, sizes, offset table and, when verify is true, its checksum.
+// </summary>
+// <returns>
+// Returns true if the file is open for queries, false otherwise.
+// </returns>
+bool MappedTree::open(const string &path, bool verify)
+{
+	close();
+
+	if (!readFile(path))
+	{
+		return false;
+	}
+
+	Header header;
+	bool valid = length >= sizeof(Header);
+
+	if (valid)
+	{
+		memcpy(&header, base, sizeof(Header));
+		valid = memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+			&& header.version == VERSION
+			&& header.byteOrder == BYTE_ORDER_MARK
+			&& header.count <= static_cast<uint64_t>(INT_MAX);
+	}
+
+	if (valid)
+	{
+		uint64_t tableBytes = (2 * header.count + 1) * sizeof(uint64_t);
+		uint64_t bodyBytes = length - sizeof(Header);
+		valid = bodyBytes >= tableBytes
+			&& bodyBytes - tableBytes == header.keyBytes;
+	}
+
+	if (valid)
+	{
+		count = static_cast<int>(header.count);
+		prefixes = reinterpret_cast<const uint64_t*>(base + sizeof(Header));
+		offsets = prefixes + count;
+		keys = reinterpret_cast<const char*>(offsets + count + 1);
+		valid = offsets[0] == 0 && offsets[count] == header.keyBytes;
+
+		// queries read keys through the offsets, so a damaged table is
+		// caught here even when the checksum is skipped
+		for (int i = 0; valid && i < count; i++)
+		{
+			valid = offsets[i] <= offsets[i + 1];
+		}
+	}
+
+	if (valid && verify)
+	{
+		valid = checksum(FNV_OFFSET, base + sizeof(Header),
+			length - sizeof(Header)) == header.checksum;
+	}
+
+	if (!valid)
+	{
+		close();
+	}
+
+	return valid;
+}
+
+////////////////////////// Close //////////////////////////
+// <summary>
+// Unmaps the file, if any, leaving the tree empty.
+// </summary>
+void MappedTree::close()
+{
+#ifdef MAPPEDTREE_MMAP
+	if (mapped)
+	{
+		munmap(const_cast<unsigned char*>(base), length);
+	}
+#endif
+
+	copy.clear();
+	copy.shrink_to_fit();
+	base = nullptr;
+	length = 0;
+	mapped = false;
+	count = 0;
+	prefixes = nullptr;
+	offsets = nullptr;
+	keys = nullptr;
+}
+
+//////////////////////// Is Open //////////////////////////
+// <summary>
+// Returns true if a file is open, false otherwise.
+// </summary>
+bool MappedTree::isOpen() const
+{
+	return base != nullptr;
+}
+
+////////////////////////// Size ///////////////////////////
+// <summary>
+// Returns the number of data in the file, 0 if none is open.
+// </summary>
+int MappedTree::size() const
+{
+	return count;
+}
+
+//////////////////////// Retrieve /////////////////////////
+// <summary>
+// Function to search for the passed data in the file, sets retrieveData
+// to its bytes in the mapping if found.
+// </summary>
+// <returns>
+// Returns true if the data is found and set, false otherwise.
+// </returns>
+bool MappedTree::retrieve(const NodeData &data,
+	string_view &retrieveData) const
+{
+	int i = lowerIndex(data);
+
+	if (i == count || key(i) != data.getData())
+	{
+		return false;
+	}
+
+	retrieveData = key(i);
+	return true;
+}
+
+////////////////////// Lower Bound ////////////////////////
+// <summary>
+// Finds the smallest data not less than the passed data, sets foundData
+// to it if found.
+// </summary>
+// <returns>
+// Returns true if such data exists and is set, false otherwise.
+// </returns>
+bool MappedTree::lowerBound(const NodeData &data, string_view &foundData) const
+{
+	return select(lowerIndex(data), foundData);
+}
+
+////////////////////////// Rank ///////////////////////////
+// <summary>
+// Returns the number of data in the file less than the passed data.
+// </summary>
+int MappedTree::rank(const NodeData &data) const
+{
+	return lowerIndex(data);
+}
+
+///////////////////////// Select //////////////////////////
+// <summary>
+// Finds the data at position k in sorted order, counting from 0, sets
+// foundData to it if found.
+// </summary>
+// <returns>
+// Returns true if 0 <= k < size() and the data is set, false otherwise.
+// </returns>
+bool MappedTree::select(int k, string_view &foundData) const
+{
+	if (k < 0 || k >= count)
+	{
+		return false;
+	}
+
+	foundData = key(k);
+	return true;
+}
+
+////////////////////// Count Range ////////////////////////
+// <summary>
+// Returns the number of data between low and high, both inclusive.
+// </summary>
+int MappedTree::countRange(const NodeData &low, const NodeData &high) const
+{
+	if (high < low)
+	{
+		return 0;
+	}
+
+	int last = lowerIndex(high);
+
+	if (last < count && key(last) == high.getData())
+	{
+		last++;
+	}
+
+	return last - lowerIndex(low);
+}
+
+//////////////////////// Load Into ////////////////////////
+// <summary>
+// Replaces the contents of tree with copies of the data in the file, in
+// O(n). bulkLoad checks the order, since a file opened without its
+// checksum may not be sorted.
+// </summary>
+// <returns>
+// Returns the number of data loaded, or -1 if the file is out of order,
+// in which case tree is left unchanged.
+// </returns>
+int MappedTree::loadInto(BinTree &tree) const
+{
+	vector<NodeData*> items;
+	items.reserve(count);
+
+	for (int i = 0; i < count; i++)
+	{
+		items.push_back(new NodeData(string(key(i))));
+	}
+
+	int loaded = tree.bulkLoad(items.data(), count, true);
+
+	if (loaded < 0)
+	{
+		for (NodeData* data : items)
+		{
+			delete data;
+		}
+	}
+
+	return loaded;
+}
+
+////////////////////////// Key ////////////////////////////
+// <summary>
+// Returns the bytes of the data at position i.
+// </summary>
+string_view MappedTree::key(int i) const
+{
+	return string_view(keys + offsets[i], offsets[i + 1] - offsets[i]);
+}
+
+////////////////////// Lower Index ////////////////////////
+// <summary>
+// Helper function that finds the first position whose data is not less
+// than data. Prefixes order the same way as NodeData::compare, so a binary
+// search over them narrows the answer to the run of equal prefixes, which
+// is then searched on the key bytes.
+// </summary>
+// <returns>
+// Returns the position, size() if every data is less.
+// </returns>
+int MappedTree::lowerIndex(const NodeData &data) const
+{
+	uint64_t prefix = data.getPrefix();
+	const uint64_t* first = lower_bound(prefixes, prefixes + count, prefix);
+	const uint64_t* last = upper_bound(first, prefixes + count, prefix);
+	int low = static_cast<int>(first - prefixes);
+	int high = static_cast<int>(last - prefixes);
+	string_view target(data.getData());
+
+	while (low < high)
+	{
+		int middle = low + (high - low) / 2;
+
+		if (key(middle) < target)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+//////////////////////// Read File ////////////////////////
+// <summary>
+// Helper function for open that maps the file at path, or reads it into
+// copy where mmap is not available.
+// </summary>
+// <returns>
+// Returns true if the file is in memory, false otherwise.
+// </returns>
+bool MappedTree::readFile(const string &path)
+{
+#ifdef MAPPEDTREE_MMAP
+	int descriptor = ::open(path.c_str(), O_RDONLY);
+
+	if (descriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	void* address = MAP_FAILED;
+
+	if (fstat(descriptor, &info) == 0 && info.st_size > 0)
+	{
+		address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+			MAP_PRIVATE, descriptor, 0);
+	}
+	::close(descriptor);
+
+	if (address == MAP_FAILED)
+	{
+		return false;
+	}
+
+	base = static_cast<const unsigned char*>(address);
+	length = static_cast<size_t>(info.st_size);
+	mapped = true;
+	return true;
+#else
+	ifstream in(path, ios::binary | ios::ate);
+	streamoff size = in ? static_cast<streamoff>(in.tellg()) : -1;
+
+	if (size <= 0)
+	{
+		return false;
+	}
+
+	copy.resize((static_cast<size_t>(size) + sizeof(uint64_t) - 1)
+		/ sizeof(uint64_t));
+	in.seekg(0);
+
+	if (!in.read(reinterpret_cast<char*>(copy.data()), size))
+	{
+		copy.clear();
+		return false;
+	}
+
+	base = reinterpret_cast<const unsigned char*>(copy.data());
+	length = static_cast<size_t>(size);
+	return true;
+#endif
+}
+
+//////////////////////// Checksum /////////////////////////
+// <summary>
+// Helper function that continues a 64-bit FNV-1a hash over length bytes.
+// </summary>
+// <returns>
+// Returns the updated hash.
+// </returns>
+uint64_t MappedTree::checksum(uint64_t hash, const void* bytes, size_t length)
+{
+	const unsigned char* current = static_cast<const unsigned char*>(bytes);
+
+	for (size_t i = 0; i < length; i++)
+	{
+		hash = (hash ^ current[i]) * FNV_PRIME;
+	}
+
+	return hash;
+}
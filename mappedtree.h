@@ -0,0 +1,217 @@
+// ------------------------------ mappedtree.h --------------------------------
+// Header file for the MappedTree class. MappedTree saves the data of a
+// BinTree to a compact binary file and opens such files for read-only
+// queries. An opened file is memory-mapped and searched where it lies: no
+// data is parsed, copied or allocated on open or per query, so start-up
+// costs one mapping instead of one insert per data.
+//
+// File layout, integers in the byte order of the writer:
+//   header    magic "BINTREE", version, byte order mark, count, key bytes
+//             and a checksum of everything after the header
+//   prefixes  count 64-bit cached NodeData prefixes; searched first
+//   offsets   count + 1 64-bit offsets of each data into the key block
+//   keys      the data of every NodeData, back to back in sorted order
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Files are read on machines of the writer's byte order; open rejects
+//   the others, as well as other versions and files that fail the checks.
+// - open verifies the checksum by default, which reads the whole file once.
+//   Skipping it leaves the size and offset table checks, which keep every
+//   query inside the file but cannot tell whether the data is right, so
+//   only skip it for files this program wrote itself.
+// - Views returned by queries point into the mapping and stay valid until
+//   close, a later open or destruction.
+// - Where mmap is not available the file is read into memory instead; the
+//   queries are the same.
+// ----------------------------------------------------------------------------
+
+#ifndef MAPPEDTREE_H
+#define MAPPEDTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "bintree.h"
+#include "nodedata.h"
+
+using namespace std;
+
+class MappedTree
+{
+public:
+	static const uint32_t VERSION = 1;		// format written by save
+
+	////////////////// Default Constructor ////////////////////
+	// <summary>
+	// Creates a tree with no file open.
+	// </summary>
+	MappedTree();
+
+	/////////////////////// Destructor ////////////////////////
+	// <summary>
+	// Closes the file, if any.
+	// </summary>
+	~MappedTree();
+
+	MappedTree(const MappedTree&) = delete;
+	MappedTree& operator=(const MappedTree&) = delete;
+
+	////////////////////////// Save ///////////////////////////
+	// <summary>
+	// Writes the data of tree to the file at path in the binary format. The
+	// file is written under a temporary name and renamed into place, so a
+	// reader never sees it half written.
+	// </summary>
+	// <returns>
+	// Returns true if the file was written, false otherwise.
+	// </returns>
+	static bool save(const BinTree &tree, const string &path);
+
+	////////////////////////// Open ///////////////////////////
+	// <summary>
+	// Maps the file at path, closing any file already open, and checks its
+	// header, sizes, offset table and, when verify is true, its checksum.
+	// </summary>
+	// <returns>
+	// Returns true if the file is open for queries, false if it could not be
+	// read or is not a valid tree file; the tree is then left closed.
+	// </returns>
+	bool open(const string &path, bool verify = true);
+
+	////////////////////////// Close //////////////////////////
+	// <summary>
+	// Unmaps the file, if any, leaving the tree empty.
+	// </summary>
+	void close();
+
+	//////////////////////// Is Open //////////////////////////
+	// <summary>
+	// Returns true if a file is open, false otherwise.
+	// </summary>
+	bool isOpen() const;
+
+	////////////////////////// Size ///////////////////////////
+	// <summary>
+	// Returns the number of data in the file, 0 if none is open.
+	// </summary>
+	int size() const;
+
+	//////////////////////// Retrieve /////////////////////////
+	// <summary>
+	// Function to search for the passed data in the file, sets retrieveData
+	// to its bytes in the mapping if found.
+	// </summary>
+	// <returns>
+	// Returns true if the data is found and set, false otherwise.
+	// </returns>
+	bool retrieve(const NodeData &data, string_view &retrieveData) const;
+
+	////////////////////// Lower Bound ////////////////////////
+	// <summary>
+	// Finds the smallest data not less than the passed data, sets foundData
+	// to it if found.
+	// </summary>
+	// <returns>
+	// Returns true if such data exists and is set, false otherwise.
+	// </returns>
+	bool lowerBound(const NodeData &data, string_view &foundData) const;
+
+	////////////////////////// Rank ///////////////////////////
+	// <summary>
+	// Returns the number of data in the file less than the passed data.
+	// </summary>
+	int rank(const NodeData &data) const;
+
+	///////////////////////// Select //////////////////////////
+	// <summary>
+	// Finds the data at position k in sorted order, counting from 0, sets
+	// foundData to it if found.
+	// </summary>
+	// <returns>
+	// Returns true if 0 <= k < size() and the data is set, false otherwise.
+	// </returns>
+	bool select(int k, string_view &foundData) const;
+
+	////////////////////// Count Range ////////////////////////
+	// <summary>
+	// Returns the number of data between low and high, both inclusive.
+	// </summary>
+	int countRange(const NodeData &low, const NodeData &high) const;
+
+	//////////////////////// Load Into ////////////////////////
+	// <summary>
+	// Replaces the contents of tree with copies of the data in the file, in
+	// O(n). The data is written sorted and unique, so it goes straight to
+	// BinTree::bulkLoad, which still checks the order.
+	// </summary>
+	// <returns>
+	// Returns the number of data loaded, or -1 if the file is out of order,
+	// in which case tree is left unchanged.
+	// </returns>
+	int loadInto(BinTree &tree) const;
+
+private:
+	// <summary>
+	// Fixed-size start of every file.
+	// </summary>
+	struct Header
+	{
+		char magic[8];						// "BINTREE" and a terminating 0
+		uint32_t version;					// VERSION when written
+		uint32_t byteOrder;					// BYTE_ORDER_MARK in the writer's order
+		uint64_t count;						// number of data
+		uint64_t keyBytes;					// size of the key block
+		uint64_t checksum;					// of every byte after the header
+	};
+
+	static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+	const unsigned char* base;				// start of the file in memory
+	size_t length;							// bytes of the file
+	bool mapped;							// base came from mmap
+	vector<uint64_t> copy;					// the file when it could not be mapped
+	int count;
+	const uint64_t* prefixes;
+	const uint64_t* offsets;
+	const char* keys;
+
+	////////////////////////// Key ////////////////////////////
+	// <summary>
+	// Returns the bytes of the data at position i.
+	// </summary>
+	string_view key(int i) const;
+
+	////////////////////// Lower Index ////////////////////////
+	// <summary>
+	// Helper function that finds the first position whose data is not less
+	// than data. Searches the prefixes and only reads key bytes among the
+	// positions whose prefix matches.
+	// </summary>
+	// <returns>
+	// Returns the position, size() if every data is less.
+	// </returns>
+	int lowerIndex(const NodeData &data) const;
+
+	//////////////////////// Read File ////////////////////////
+	// <summary>
+	// Helper function for open that maps the file at path, or reads it into
+	// copy where mmap is not available.
+	// </summary>
+	// <returns>
+	// Returns true if the file is in memory, false otherwise.
+	// </returns>
+	bool readFile(const string &path);
+
+	//////////////////////// Checksum /////////////////////////
+	// <summary>
+	// Helper function that continues a 64-bit FNV-1a hash over length bytes.
+	// </summary>
+	// <returns>
+	// Returns the updated hash.
+	// </returns>
+	static uint64_t checksum(uint64_t hash, const void* bytes, size_t length);
+};
+
+#endif
@@ -0,0 +1,195 @@
+// ------------------------------ nodepool.h ----------------------------------
+// Header file for the NodePool class template. NodePool is a slab allocator
+// that hands out fixed-size objects from contiguous blocks instead of making
+// one heap allocation per object. Objects can be returned one at a time to a
+// free list, or the whole pool can be reset at once.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - T is trivially destructible, so releasing an object never needs to run
+//   a destructor and releaseAll can drop every object without visiting them.
+// - Blocks are kept after releaseAll so the next batch reuses them; memory is
+//   only returned to the system when the pool is destroyed.
+// - A pool is used by one thread at a time. Threads that need to allocate in
+//   parallel fill pools of their own, which one pool then adopts.
+// ----------------------------------------------------------------------------
+
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <new>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+template <typename T>
+class NodePool
+{
+	static_assert(is_trivially_destructible<T>::value,
+		"NodePool only holds trivially destructible objects");
+
+public:
+	////////////////////// Constructor ////////////////////////
+	// <summary>
+	// Constructor for class NodePool. Creates an empty pool that grows by
+	// blockSize objects at a time.
+	// </summary>
+	// <parameter = "blockSize">
+	// Number of objects allocated together in one contiguous block.
+	// </parameter>
+	explicit NodePool(int blockSize = 512)
+	{
+		this->blockSize = (blockSize > 0) ? blockSize : 1;
+		freeList = nullptr;
+		cursor = nullptr;
+		end = nullptr;
+		next = 0;
+	}
+
+	////////////////////// Destructor /////////////////////////
+	// <summary>
+	// Destructor for class NodePool. Returns every block to the system.
+	// </summary>
+	~NodePool()
+	{
+		for (Slot* block : blocks)
+		{
+			delete[] block;
+		}
+	}
+
+	NodePool(const NodePool&) = delete;
+	NodePool& operator=(const NodePool&) = delete;
+
+	///////////////////// Get Block Size //////////////////////
+	// <summary>
+	// Returns the number of objects allocated together in one block.
+	// </summary>
+	int getBlockSize() const
+	{
+		return blockSize;
+	}
+
+	/////////////////////// Allocate //////////////////////////
+	// <summary>
+	// Hands out one value-initialized object, reusing a released slot when
+	// one is available and otherwise taking the next slot of the current
+	// block.
+	// </summary>
+	// <returns>
+	// Returns a pointer to the new object.
+	// </returns>
+	T* allocate()
+	{
+		Slot* slot = freeList;
+
+		if (slot != nullptr)
+		{
+			freeList = slot->next;
+		}
+		else
+		{
+			if (cursor == end)
+			{
+				nextBlock();
+			}
+			slot = cursor++;
+		}
+
+		return new (slot->storage) T();
+	}
+
+	//////////////////////// Release //////////////////////////
+	// <summary>
+	// Returns one object to the pool so a later allocate can reuse its slot.
+	// </summary>
+	// <parameter = "obj">
+	// Object previously handed out by this pool.
+	// </parameter>
+	void release(T* obj)
+	{
+		Slot* slot = reinterpret_cast<Slot*>(obj);
+		slot->next = freeList;
+		freeList = slot;
+	}
+
+	////////////////////// Release All ////////////////////////
+	// <summary>
+	// Releases every object handed out by the pool at once. Costs nothing
+	// per object; the blocks stay allocated for reuse.
+	// </summary>
+	void releaseAll()
+	{
+		freeList = nullptr;
+		cursor = nullptr;
+		end = nullptr;
+		next = 0;
+	}
+
+	///////////////////////// Adopt /////////////////////////
+	// <summary>
+	// Takes over every object handed out by other, which is left empty with
+	// only its unused blocks. Objects keep their addresses, so pointers to
+	// them stay valid, and from then on belong to this pool: they can be
+	// released here and go with this pool's releaseAll. Slots other had free
+	// are kept free here.
+	// </summary>
+	// <parameter = "other">
+	// Pool whose objects are taken, typically one filled on another thread.
+	// It must have the same block size as this pool.
+	// </parameter>
+	void adopt(NodePool &other)
+	{
+		blocks.insert(blocks.begin() + next, other.blocks.begin(),
+			other.blocks.begin() + other.next);
+		next += other.next;
+		other.blocks.erase(other.blocks.begin(),
+			other.blocks.begin() + other.next);
+
+		if (other.freeList != nullptr)
+		{
+			Slot* tail = other.freeList;
+
+			while (tail->next != nullptr)
+			{
+				tail = tail->next;
+			}
+
+			tail->next = freeList;
+			freeList = other.freeList;
+		}
+
+		other.releaseAll();
+	}
+
+private:
+	union Slot {
+		Slot* next;							// next free slot
+		alignas(T) unsigned char storage[sizeof(T)];	// object storage
+	};
+
+	vector<Slot*> blocks;					// every block owned by the pool
+	size_t next;							// index of the next block to fill
+	Slot* cursor;							// next unused slot in current block
+	Slot* end;								// one past the current block
+	int blockSize;							// slots per block
+	Slot* freeList;							// released slots, most recent first
+
+	////////////////////// Next Block /////////////////////////
+	// <summary>
+	// Moves allocation on to the next block, reusing a block kept from before
+	// the last releaseAll or allocating a new one.
+	// </summary>
+	void nextBlock()
+	{
+		if (next == blocks.size())
+		{
+			blocks.push_back(new Slot[blockSize]);
+		}
+
+		cursor = blocks[next++];
+		end = cursor + blockSize;
+	}
+};
+
+#endif
@@ -0,0 +1,609 @@
+// ------------------------- persistentbintree.cpp ----------------------------
+// Implementation file for the PersistentBinTree class. A binary search tree
+// of NodeData whose versions share reference-counted, immutable nodes.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Every helper that returns a node returns a reference the caller owns,
+//   and balance takes over the references passed to it, so each path stays
+//   balanced between acquire and release without extra bookkeeping.
+// ----------------------------------------------------------------------------
+
+#include <utility>
+#include "persistentbintree.h"
+
+using namespace std;
+
+////////////////// Default Constructor ////////////////////
+// <summary>
+// Creates an empty tree.
+// </summary>
+PersistentBinTree::PersistentBinTree()
+{
+	root = nullptr;
+}
+
+///////////////////// Tree Constructor ////////////////////
+// <summary>
+// Builds a balanced tree from a copy of the data in tree, in O(n).
+// </summary>
+PersistentBinTree::PersistentBinTree(const BinTree &tree)
+{
+	vector<NodeData> items;
+	items.reserve(tree.size());
+	tree.exportTo(back_inserter(items));
+	root = build(items, 0, static_cast<int>(items.size()) - 1);
+}
+
+//////////////////// Copy Constructor /////////////////////
+// <summary>
+// Creates a version that shares every node with obj. O(1).
+// </summary>
+PersistentBinTree::PersistentBinTree(const PersistentBinTree &obj)
+{
+	root = acquire(obj.root);
+}
+
+//////////////////// Move Constructor /////////////////////
+// <summary>
+// Takes the nodes of obj, which is left empty.
+// </summary>
+PersistentBinTree::PersistentBinTree(PersistentBinTree &&obj) noexcept
+{
+	root = obj.root;
+	obj.root = nullptr;
+}
+
+////////////////////// Destructor /////////////////////////
+// <summary>
+// Drops this version's reference to its nodes, freeing those no other
+// version shares.
+// </summary>
+PersistentBinTree::~PersistentBinTree()
+{
+	release(root);
+}
+
+//////////////////////// = Operator ///////////////////////
+// <summary>
+// Makes this tree share every node with obj. The new root is acquired
+// before the old one is released, so self-assignment is safe.
+// </summary>
+PersistentBinTree& PersistentBinTree::operator=(const PersistentBinTree &obj)
+{
+	const Node* previous = root;
+	root = acquire(obj.root);
+	release(previous);
+	return *this;
+}
+
+PersistentBinTree& PersistentBinTree::operator=(PersistentBinTree &&obj) noexcept
+{
+	swap(root, obj.root);
+	return *this;
+}
+
+/////////////////////// == Operator ///////////////////////
+// <summary>
+// Compares the data of two trees in sorted order. Versions that still
+// share their root compare equal in O(1).
+// </summary>
+// <returns>
+// Returns true if both trees hold equal data, false otherwise.
+// </returns>
+bool PersistentBinTree::operator==(const PersistentBinTree &obj) const
+{
+	if (root == obj.root)
+	{
+		return true;
+	}
+
+	if (size() != obj.size())
+	{
+		return false;
+	}
+
+	Iterator left = begin();
+
+	for (Iterator right = obj.begin(); right != obj.end(); ++right, ++left)
+	{
+		if (*left != *right)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool PersistentBinTree::operator!=(const PersistentBinTree &obj) const
+{
+	return !(*this == obj);
+}
+
+//////////////////////// Is Empty /////////////////////////
+// <summary>
+// Returns true if the tree has no data, false otherwise.
+// </summary>
+bool PersistentBinTree::isEmpty() const
+{
+	return root == nullptr;
+}
+
+////////////////////////// Size ///////////////////////////
+// <summary>
+// Returns the number of data in the tree.
+// </summary>
+int PersistentBinTree::size() const
+{
+	return nodeSize(root);
+}
+
+//////////////////////// Retrieve /////////////////////////
+// <summary>
+// Function to search for the passed data in the tree, sets retrieveData
+// to the stored copy if found.
+// </summary>
+// <returns>
+// Returns true if the data is found and set, false otherwise.
+// </returns>
+bool PersistentBinTree::retrieve(const NodeData &data,
+	const NodeData* &retrieveData) const
+{
+	const Node* found = findNode(data, root);
+
+	if (found == nullptr)
+	{
+		return false;
+	}
+
+	retrieveData = &found->data;
+	return true;
+}
+
+/////////////////////// Get Height ////////////////////////
+// <summary>
+// Function to get the height of the tree at the node containing the
+// data parameter.
+// </summary>
+// <returns>
+// Returns the height at the data, 0 if data is not found.
+// </returns>
+int PersistentBinTree::getHeight(const NodeData &data) const
+{
+	return nodeHeight(findNode(data, root));
+}
+
+///////////////////////// Insert //////////////////////////
+// <summary>
+// Function to insert a copy of data. Copies the path to the new leaf and
+// leaves other versions unchanged.
+// </summary>
+// <returns>
+// Returns true if inserted, false if equal data is already in the tree.
+// </returns>
+bool PersistentBinTree::insert(const NodeData &data)
+{
+	bool inserted = false;
+	const Node* updated = insert(root, data, inserted);
+	release(root);
+	root = updated;
+	return inserted;
+}
+
+///////////////////////// Remove //////////////////////////
+// <summary>
+// Function to remove the data equal to the passed data. Copies the path
+// to it and leaves other versions unchanged.
+// </summary>
+// <returns>
+// Returns true if the data was found and removed, false otherwise.
+// </returns>
+bool PersistentBinTree::remove(const NodeData &data)
+{
+	bool removed = false;
+	const Node* updated = remove(root, data, removed);
+	release(root);
+	root = updated;
+	return removed;
+}
+
+/////////////////////// Make Empty ////////////////////////
+// <summary>
+// Empties this version. Other versions keep their data.
+// </summary>
+void PersistentBinTree::makeEmpty()
+{
+	release(root);
+	root = nullptr;
+}
+
+///////////////////////// Begin ///////////////////////////
+// <summary>
+// Function to get an iterator to the smallest data in the tree.
+// </summary>
+PersistentBinTree::Iterator PersistentBinTree::begin() const
+{
+	Iterator first;
+	first.descend(root);
+	return first;
+}
+
+////////////////////////// End ////////////////////////////
+// <summary>
+// Function to get the past-the-end iterator of the tree.
+// </summary>
+PersistentBinTree::Iterator PersistentBinTree::end() const
+{
+	return Iterator();
+}
+
+//////////////////////// Iterator /////////////////////////
+// <summary>
+// Forward iterator over the data of a version in sorted order. The top of
+// path is the current node; the nodes below it are ancestors whose data
+// comes next.
+// </summary>
+PersistentBinTree::Iterator::Iterator()
+{
+}
+
+PersistentBinTree::Iterator::reference
+PersistentBinTree::Iterator::operator*() const
+{
+	return path.back()->data;
+}
+
+PersistentBinTree::Iterator::pointer
+PersistentBinTree::Iterator::operator->() const
+{
+	return &path.back()->data;
+}
+
+PersistentBinTree::Iterator& PersistentBinTree::Iterator::operator++()
+{
+	const Node* current = path.back();
+	path.pop_back();
+	descend(current->right);
+	return *this;
+}
+
+PersistentBinTree::Iterator PersistentBinTree::Iterator::operator++(int)
+{
+	Iterator previous = *this;
+	++(*this);
+	return previous;
+}
+
+bool PersistentBinTree::Iterator::operator==(const Iterator &other) const
+{
+	if (path.empty() || other.path.empty())
+	{
+		return path.empty() == other.path.empty();
+	}
+
+	return path.back() == other.path.back();
+}
+
+bool PersistentBinTree::Iterator::operator!=(const Iterator &other) const
+{
+	return !(*this == other);
+}
+
+// <summary>
+// Pushes node and its left spine, leaving the smallest data of the subtree
+// on top.
+// </summary>
+void PersistentBinTree::Iterator::descend(const Node* node)
+{
+	while (node != nullptr)
+	{
+		path.push_back(node);
+		node = node->left;
+	}
+}
+
+////////////////////////// Node ///////////////////////////
+// <summary>
+// Builds a node holding one reference, taking over the references to left
+// and right, and computes its height and size.
+// </summary>
+PersistentBinTree::Node::Node(const NodeData &data, const Node* left,
+	const Node* right) : data(data), left(left), right(right), refs(1)
+{
+	int leftHeight = nodeHeight(left);
+	int rightHeight = nodeHeight(right);
+
+	height = 1 + ((leftHeight > rightHeight) ? leftHeight : rightHeight);
+	size = 1 + nodeSize(left) + nodeSize(right);
+}
+
+/////////////////////// Find Node /////////////////////////
+// <summary>
+// Helper function to find the node containing the passed data under node.
+// </summary>
+// <returns>
+// Returns the found node, nullptr if there is none.
+// </returns>
+const PersistentBinTree::Node* PersistentBinTree::findNode(
+	const NodeData &data, const Node* node)
+{
+	while (node != nullptr)
+	{
+		int order = data.compare(node->data);
+
+		if (order == 0)
+		{
+			return node;
+		}
+
+		node = (order < 0) ? node->left : node->right;
+	}
+
+	return nullptr;
+}
+
+///////////////////////// Acquire /////////////////////////
+// <summary>
+// Helper function that adds a reference to node, if any.
+// </summary>
+// <returns>
+// Returns node.
+// </returns>
+const PersistentBinTree::Node* PersistentBinTree::acquire(const Node* node)
+{
+	if (node != nullptr)
+	{
+		node->refs.fetch_add(1, memory_order_relaxed);
+	}
+
+	return node;
+}
+
+///////////////////////// Release /////////////////////////
+// <summary>
+// Helper function that drops a reference to node, freeing it and then
+// any children it held the last reference to. Uses an explicit stack, so
+// freeing a whole version never recurses.
+// </summary>
+void PersistentBinTree::release(const Node* node)
+{
+	vector<const Node*> stack;
+
+	if (node != nullptr)
+	{
+		stack.push_back(node);
+	}
+
+	while (!stack.empty())
+	{
+		node = stack.back();
+		stack.pop_back();
+
+		if (node->refs.fetch_sub(1, memory_order_acq_rel) != 1)
+		{
+			continue;
+		}
+
+		if (node->left != nullptr)
+		{
+			stack.push_back(node->left);
+		}
+		if (node->right != nullptr)
+		{
+			stack.push_back(node->right);
+		}
+
+		delete node;
+	}
+}
+
+//////////////////////// Balance //////////////////////////
+// <summary>
+// Helper function that builds a node from data, left and right, rotating
+// once or twice when the heights differ by two. The child taken apart by a
+// rotation is released after its own children have been acquired for the
+// new nodes.
+// </summary>
+// <returns>
+// Returns a new reference to the root of the balanced subtree.
+// </returns>
+const PersistentBinTree::Node* PersistentBinTree::balance(
+	const NodeData &data, const Node* left, const Node* right)
+{
+	int difference = nodeHeight(left) - nodeHeight(right);
+	const Node* result;
+
+	if (difference > 1)
+	{
+		if (nodeHeight(left->left) >= nodeHeight(left->right))
+		{
+			result = new Node(left->data, acquire(left->left),
+				new Node(data, acquire(left->right), right));
+		}
+		else
+		{
+			const Node* pivot = left->right;
+			result = new Node(pivot->data,
+				new Node(left->data, acquire(left->left), acquire(pivot->left)),
+				new Node(data, acquire(pivot->right), right));
+		}
+
+		release(left);
+		return result;
+	}
+
+	if (difference < -1)
+	{
+		if (nodeHeight(right->right) >= nodeHeight(right->left))
+		{
+			result = new Node(right->data,
+				new Node(data, left, acquire(right->left)),
+				acquire(right->right));
+		}
+		else
+		{
+			const Node* pivot = right->left;
+			result = new Node(pivot->data,
+				new Node(data, left, acquire(pivot->left)),
+				new Node(right->data, acquire(pivot->right),
+					acquire(right->right)));
+		}
+
+		release(right);
+		return result;
+	}
+
+	return new Node(data, left, right);
+}
+
+////////////////////// Insert Helper //////////////////////
+// <summary>
+// Helper function for insert. Recursion depth is the AVL height.
+// </summary>
+// <returns>
+// Returns a new reference to the root of the changed subtree, or to node
+// itself with inserted left false if data was already there.
+// </returns>
+const PersistentBinTree::Node* PersistentBinTree::insert(const Node* node,
+	const NodeData &data, bool &inserted)
+{
+	if (node == nullptr)
+	{
+		inserted = true;
+		return new Node(data, nullptr, nullptr);
+	}
+
+	int order = data.compare(node->data);
+
+	if (order == 0)
+	{
+		return acquire(node);
+	}
+
+	const Node* child = insert((order < 0) ? node->left : node->right, data,
+		inserted);
+
+	if (!inserted)
+	{
+		release(child);
+		return acquire(node);
+	}
+
+	return (order < 0) ? balance(node->data, child, acquire(node->right))
+		: balance(node->data, acquire(node->left), child);
+}
+
+////////////////////// Remove Helper //////////////////////
+// <summary>
+// Helper function for remove. A node with two children takes a copy of
+// the smallest data of its right subtree. Recursion depth is the AVL
+// height.
+// </summary>
+// <returns>
+// Returns a new reference to the root of the changed subtree, or to node
+// itself with removed left false if data was not there.
+// </returns>
+const PersistentBinTree::Node* PersistentBinTree::remove(const Node* node,
+	const NodeData &data, bool &removed)
+{
+	if (node == nullptr)
+	{
+		return nullptr;
+	}
+
+	int order = data.compare(node->data);
+
+	if (order == 0)
+	{
+		removed = true;
+
+		if (node->left == nullptr)
+		{
+			return acquire(node->right);
+		}
+
+		if (node->right == nullptr)
+		{
+			return acquire(node->left);
+		}
+
+		const Node* successor = node->right;
+
+		while (successor->left != nullptr)
+		{
+			successor = successor->left;
+		}
+
+		return balance(successor->data, acquire(node->left),
+			removeMin(node->right));
+	}
+
+	const Node* child = remove((order < 0) ? node->left : node->right, data,
+		removed);
+
+	if (!removed)
+	{
+		release(child);
+		return acquire(node);
+	}
+
+	return (order < 0) ? balance(node->data, child, acquire(node->right))
+		: balance(node->data, acquire(node->left), child);
+}
+
+//////////////////// Remove Min Helper ////////////////////
+// <summary>
+// Helper function for remove. Takes the smallest data out of the subtree
+// at node, which must not be empty.
+// </summary>
+// <returns>
+// Returns a new reference to the root of the changed subtree.
+// </returns>
+const PersistentBinTree::Node* PersistentBinTree::removeMin(const Node* node)
+{
+	if (node->left == nullptr)
+	{
+		return acquire(node->right);
+	}
+
+	return balance(node->data, removeMin(node->left), acquire(node->right));
+}
+
+/////////////////////// Build Helper //////////////////////
+// <summary>
+// Helper function for the tree constructor. Builds a balanced subtree of
+// items[low..high] around the midpoint. Recursion depth is logarithmic.
+// </summary>
+// <returns>
+// Returns a new reference to the root of the subtree.
+// </returns>
+const PersistentBinTree::Node* PersistentBinTree::build(
+	const vector<NodeData> &items, int low, int high)
+{
+	if (low > high)
+	{
+		return nullptr;
+	}
+
+	int middle = low + (high - low) / 2;
+	return new Node(items[middle], build(items, low, middle - 1),
+		build(items, middle + 1, high));
+}
+
+////////////////////// Node Height ////////////////////////
+// <summary>
+// Returns the stored height of node, 0 for an empty subtree.
+// </summary>
+int PersistentBinTree::nodeHeight(const Node* node)
+{
+	return (node == nullptr) ? 0 : node->height;
+}
+
+/////////////////////// Node Size /////////////////////////
+// <summary>
+// Returns the stored size of node, 0 for an empty subtree.
+// </summary>
+int PersistentBinTree::nodeSize(const Node* node)
+{
+	return (node == nullptr) ? 0 : node->size;
+}
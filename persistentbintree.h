@@ -0,0 +1,298 @@
+// -------------------------- persistentbintree.h -----------------------------
+// Header file for the PersistentBinTree class. PersistentBinTree is a binary
+// search tree of NodeData whose copies share structure. Copying a tree costs
+// O(1): the copy points at the same nodes. Nodes are never changed once
+// built, so an insert or remove copies only the O(log n) nodes on the path
+// it changes and leaves every other version of the tree as it was.
+//
+// Nodes are reference counted. A node is freed when the last version that
+// can reach it is destroyed or changed, so old versions stay readable for as
+// long as they are kept and cost only the nodes they do not share.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - The tree is always AVL-balanced, so every path copied is O(log n) long.
+// - Data is held by value in the nodes and copied along with the path, as
+//   in BasicBinTree; callers keep ownership of what they pass in.
+// - Reference counts are atomic, so versions that share nodes may be used
+//   and destroyed on different threads. One version object must still not
+//   be changed by one thread while another thread uses it.
+// - Pointers and iterators into a version stay valid until that version is
+//   changed, assigned or destroyed, whatever happens to other versions.
+// ----------------------------------------------------------------------------
+
+#ifndef PERSISTENTBINTREE_H
+#define PERSISTENTBINTREE_H
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "bintree.h"
+#include "nodedata.h"
+
+using namespace std;
+
+class PersistentBinTree
+{
+	struct Node;
+
+public:
+	////////////////// Default Constructor ////////////////////
+	// <summary>
+	// Creates an empty tree.
+	// </summary>
+	PersistentBinTree();
+
+	///////////////////// Tree Constructor ////////////////////
+	// <summary>
+	// Builds a balanced tree from a copy of the data in tree, in O(n).
+	// </summary>
+	explicit PersistentBinTree(const BinTree &tree);
+
+	//////////////////// Copy Constructor /////////////////////
+	// <summary>
+	// Creates a version that shares every node with obj. O(1).
+	// </summary>
+	PersistentBinTree(const PersistentBinTree &obj);
+
+	//////////////////// Move Constructor /////////////////////
+	// <summary>
+	// Takes the nodes of obj, which is left empty.
+	// </summary>
+	PersistentBinTree(PersistentBinTree &&obj) noexcept;
+
+	////////////////////// Destructor /////////////////////////
+	// <summary>
+	// Drops this version's reference to its nodes, freeing those no other
+	// version shares.
+	// </summary>
+	~PersistentBinTree();
+
+	//////////////////////// = Operator ///////////////////////
+	// <summary>
+	// Makes this tree share every node with obj. O(1) plus freeing what
+	// only this tree held.
+	// </summary>
+	PersistentBinTree& operator=(const PersistentBinTree &obj);
+	PersistentBinTree& operator=(PersistentBinTree &&obj) noexcept;
+
+	/////////////////////// == Operator ///////////////////////
+	// <summary>
+	// Compares the data of two trees in sorted order. Versions that still
+	// share their root compare equal in O(1).
+	// </summary>
+	// <returns>
+	// Returns true if both trees hold equal data, false otherwise.
+	// </returns>
+	bool operator==(const PersistentBinTree &obj) const;
+	bool operator!=(const PersistentBinTree &obj) const;
+
+	//////////////////////// Is Empty /////////////////////////
+	// <summary>
+	// Returns true if the tree has no data, false otherwise.
+	// </summary>
+	bool isEmpty() const;
+
+	////////////////////////// Size ///////////////////////////
+	// <summary>
+	// Returns the number of data in the tree.
+	// </summary>
+	int size() const;
+
+	//////////////////////// Retrieve /////////////////////////
+	// <summary>
+	// Function to search for the passed data in the tree, sets retrieveData
+	// to the stored copy if found.
+	// </summary>
+	// <returns>
+	// Returns true if the data is found and set, false otherwise.
+	// </returns>
+	bool retrieve(const NodeData &data, const NodeData* &retrieveData) const;
+
+	/////////////////////// Get Height ////////////////////////
+	// <summary>
+	// Function to get the height of the tree at the node containing the
+	// data parameter.
+	// </summary>
+	// <returns>
+	// Returns the height at the data, 0 if data is not found.
+	// </returns>
+	int getHeight(const NodeData &data) const;
+
+	///////////////////////// Insert //////////////////////////
+	// <summary>
+	// Function to insert a copy of data. Copies the path to the new leaf and
+	// leaves other versions unchanged.
+	// </summary>
+	// <returns>
+	// Returns true if inserted, false if equal data is already in the tree.
+	// </returns>
+	bool insert(const NodeData &data);
+
+	///////////////////////// Remove //////////////////////////
+	// <summary>
+	// Function to remove the data equal to the passed data. Copies the path
+	// to it and leaves other versions unchanged.
+	// </summary>
+	// <returns>
+	// Returns true if the data was found and removed, false otherwise.
+	// </returns>
+	bool remove(const NodeData &data);
+
+	/////////////////////// Make Empty ////////////////////////
+	// <summary>
+	// Empties this version. Other versions keep their data.
+	// </summary>
+	void makeEmpty();
+
+	//////////////////////// Iterator /////////////////////////
+	// <summary>
+	// Forward iterator over the data of a version in sorted order. Keeps the
+	// path from the root on an explicit stack, since shared nodes cannot have
+	// parent links.
+	// </summary>
+	class Iterator
+	{
+	public:
+		typedef forward_iterator_tag iterator_category;
+		typedef NodeData value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const NodeData* pointer;
+		typedef const NodeData& reference;
+
+		Iterator();
+
+		reference operator*() const;
+		pointer operator->() const;
+
+		Iterator& operator++();
+		Iterator operator++(int);
+
+		bool operator==(const Iterator &other) const;
+		bool operator!=(const Iterator &other) const;
+
+	private:
+		friend class PersistentBinTree;
+
+		// <summary>
+		// Pushes node and its left spine.
+		// </summary>
+		void descend(const Node* node);
+
+		vector<const Node*> path;			// top is current, then ancestors to visit
+	};
+
+	typedef Iterator iterator;
+	typedef Iterator const_iterator;
+
+	Iterator begin() const;
+	Iterator end() const;
+
+private:
+	struct Node
+	{
+		NodeData data;
+		const Node* left;
+		const Node* right;
+		int height;							// height of the subtree, 1 for a leaf
+		int size;							// number of nodes in the subtree
+		mutable atomic<int> refs;			// versions and parents holding this node
+
+		Node(const NodeData &data, const Node* left, const Node* right);
+	};
+
+	const Node* root;
+
+	/////////////////////// Find Node /////////////////////////
+	// <summary>
+	// Helper function to find the node containing the passed data under node.
+	// </summary>
+	// <returns>
+	// Returns the found node, nullptr if there is none.
+	// </returns>
+	static const Node* findNode(const NodeData &data, const Node* node);
+
+	///////////////////////// Acquire /////////////////////////
+	// <summary>
+	// Helper function that adds a reference to node, if any.
+	// </summary>
+	// <returns>
+	// Returns node.
+	// </returns>
+	static const Node* acquire(const Node* node);
+
+	///////////////////////// Release /////////////////////////
+	// <summary>
+	// Helper function that drops a reference to node, freeing it and then
+	// any children it held the last reference to. Uses an explicit stack.
+	// </summary>
+	static void release(const Node* node);
+
+	//////////////////////// Balance //////////////////////////
+	// <summary>
+	// Helper function that builds a node from data, left and right, rotating
+	// when the heights differ by two. Takes over the references to left and
+	// right.
+	// </summary>
+	// <returns>
+	// Returns a new reference to the root of the balanced subtree.
+	// </returns>
+	static const Node* balance(const NodeData &data, const Node* left,
+		const Node* right);
+
+	////////////////////// Insert Helper //////////////////////
+	// <summary>
+	// Helper function for insert. Recursion depth is the AVL height.
+	// </summary>
+	// <returns>
+	// Returns a new reference to the root of the changed subtree, or to node
+	// itself with inserted left false if data was already there.
+	// </returns>
+	static const Node* insert(const Node* node, const NodeData &data,
+		bool &inserted);
+
+	////////////////////// Remove Helper //////////////////////
+	// <summary>
+	// Helper function for remove. Recursion depth is the AVL height.
+	// </summary>
+	// <returns>
+	// Returns a new reference to the root of the changed subtree, or to node
+	// itself with removed left false if data was not there.
+	// </returns>
+	static const Node* remove(const Node* node, const NodeData &data,
+		bool &removed);
+
+	//////////////////// Remove Min Helper ////////////////////
+	// <summary>
+	// Helper function for remove. Takes the smallest data out of the subtree
+	// at node, which must not be empty.
+	// </summary>
+	// <returns>
+	// Returns a new reference to the root of the changed subtree.
+	// </returns>
+	static const Node* removeMin(const Node* node);
+
+	/////////////////////// Build Helper //////////////////////
+	// <summary>
+	// Helper function for the tree constructor. Builds a balanced subtree of
+	// items[low..high].
+	// </summary>
+	// <returns>
+	// Returns a new reference to the root of the subtree.
+	// </returns>
+	static const Node* build(const vector<NodeData> &items, int low, int high);
+
+	////////////////////// Node Height ////////////////////////
+	// <summary>
+	// Returns the stored height of node, 0 for an empty subtree.
+	// </summary>
+	static int nodeHeight(const Node* node);
+
+	/////////////////////// Node Size /////////////////////////
+	// <summary>
+	// Returns the stored size of node, 0 for an empty subtree.
+	// </summary>
+	static int nodeSize(const Node* node);
+};
+
+#endif
@@ -0,0 +1,306 @@
+// ---------------------------- balancedriver.cpp -----------------------------
+// Driver for the balanced mode of BinTree. Inserts sorted, reverse sorted
+// and random keys into balanced trees and checks that the height never
+// exceeds the AVL bound of 1.44 log2(n + 2), including for a tree that took
+// its mode through operator=. Then takes data out of a balanced and a plain
+// tree with remove, extract and removeRange, next to a std::set, and checks
+// along the way that both hold the same data and that every node's cached
+// height and size are right and, in the balanced tree, AVL-balanced. Last
+// it times sorted inserts into a balanced and a plain BinTree of the same
+// sizes.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/balancedriver.cpp bintree.cpp treewriter.cpp
+//       supportingdocs/nodedata.cpp -o balancedriver
+//   ./balancedriver [keys]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - keys defaults to 1,000,000. A plain BinTree fed sorted input costs
+//   O(n^2), so it is only timed up to PLAIN_LIMIT keys.
+// - Keys are zero padded, so string order is numeric order.
+// - The shape of a tree is read back from its TreeWriter SIDEWAYS text:
+//   data in reverse order, indented four more spaces per level down.
+// - Removals go on until a quarter of the keys are left; the shape is
+//   checked CHECKS times on the way and once more at the end. removeRange
+//   takes up to RANGE_WIDTH keys at a time.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bintree.h"
+#include "treewriter.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int PLAIN_LIMIT = 20000;
+const int CHECKS = 8;
+const int RANGE_WIDTH = 20;
+
+//global function prototypes
+int fill(BinTree&, const vector<int>&);           // inserts, returns count
+int treeHeight(const BinTree&);                   // height of the root
+bool checkHeight(const BinTree&, const string&);  // AVL bound check
+double timeSorted(bool balanced, int keys);       // ms for sorted inserts
+bool checkRemovals(bool balanced, int keys);      // remove, extract, ranges
+bool checkShape(const BinTree&, const set<int>&); // data, heights, sizes
+int checkSubtree(const BinTree&, const vector<string>& keys,
+	const vector<int>& depths, int low, int high, int top, bool& ok);
+
+int main(int argc, char* argv[]) {
+	int keys = (argc > 1) ? atoi(argv[1]) : 1000000;
+	bool passed = true;
+
+	vector<int> sorted(keys);
+	for (int i = 0; i < keys; i++) {
+		sorted[i] = i;
+	}
+	vector<int> reversed(sorted.rbegin(), sorted.rend());
+	vector<int> shuffled(sorted);
+	shuffle(shuffled.begin(), shuffled.end(), mt19937(343));
+
+	cout << "Height bound, " << keys << " keys:" << endl;
+	{
+		BinTree T(true);
+		fill(T, sorted);
+		passed &= checkHeight(T, "sorted");
+	}
+	{
+		BinTree T(true);
+		fill(T, reversed);
+		passed &= checkHeight(T, "reversed");
+	}
+	{
+		BinTree T(true);
+		fill(T, shuffled);
+		passed &= checkHeight(T, "random");
+	}
+	{
+		// an empty balanced tree equals an empty plain one, so this checks
+		// that operator= carries the mode over regardless
+		BinTree balanced(true), copy;
+		copy = balanced;
+		fill(copy, sorted);
+		passed &= checkHeight(copy, "assigned");
+	}
+
+	cout << endl << "Removals, " << keys << " keys:" << endl;
+	passed &= checkRemovals(true, keys);
+	passed &= checkRemovals(false, keys);
+
+	cout << endl << "Sorted inserts (ms):" << endl;
+	printf("  %10s %12s %12s\n", "keys", "balanced", "plain");
+	for (int size = 1000; size <= keys; size *= 10) {
+		printf("  %10d %12.1f ", size, timeSorted(true, size));
+		if (size <= PLAIN_LIMIT) {
+			printf("%12.1f\n", timeSorted(false, size));
+		}
+		else {
+			printf("%12s\n", "-");
+		}
+	}
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//-------------------------------- fill --------------------------------------
+// Inserts a key for each value in order, deleting the data of duplicates.
+int fill(BinTree& T, const vector<int>& values) {
+	int inserted = 0;
+	for (int value : values) {
+		NodeData* ptr = new NodeData(makeKey(value));
+		if (T.insert(ptr)) {
+			inserted++;
+		}
+		else {
+			delete ptr;
+		}
+	}
+	return inserted;
+}
+
+//----------------------------- treeHeight -----------------------------------
+// Returns the height of T, found as the largest height of any of its data.
+int treeHeight(const BinTree& T) {
+	int height = 0;
+	for (const NodeData& data : T) {
+		height = max(height, T.getHeight(data));
+	}
+	return height;
+}
+
+//----------------------------- checkHeight ----------------------------------
+// Prints the height of T and returns whether it is within the AVL bound.
+bool checkHeight(const BinTree& T, const string& label) {
+	int height = treeHeight(T);
+	int bound = static_cast<int>(1.4405 * log2(T.size() + 2.0));
+	bool ok = T.isBalanced() && height <= bound;
+	printf("  %-9s height %3d, bound %3d  %s\n", label.c_str(), height, bound,
+		ok ? "ok" : "FAILED");
+	return ok;
+}
+
+//------------------------------ timeSorted ----------------------------------
+// Returns the milliseconds taken to insert keys sorted keys into a new tree.
+double timeSorted(bool balanced, int keys) {
+	vector<NodeData*> data;
+	for (int i = 0; i < keys; i++) {
+		data.push_back(new NodeData(makeKey(i)));
+	}
+
+	BinTree T(balanced);
+	auto start = chrono::steady_clock::now();
+	for (NodeData* ptr : data) {
+		T.insert(ptr);
+	}
+	auto stop = chrono::steady_clock::now();
+	return chrono::duration<double, milli>(stop - start).count();
+}
+
+//---------------------------- checkRemovals ---------------------------------
+// Fills a tree with keys 0 .. keys - 1 in random order, then removes random
+// keys, some absent by then, with remove, extract and removeRange until a
+// quarter are left, doing the same to a std::set. Checks what each call
+// returns and, every so often, the whole tree against the set. Then empties
+// the tree with one removeRange and fills it again. Prints one line and
+// returns true if every check passed.
+bool checkRemovals(bool balanced, int keys) {
+	mt19937 rng(balanced ? 343 : 344);
+	vector<int> values(keys);
+	for (int i = 0; i < keys; i++) {
+		values[i] = i;
+	}
+	shuffle(values.begin(), values.end(), rng);
+
+	BinTree T(balanced);
+	fill(T, values);
+	set<int> expected(values.begin(), values.end());
+	bool ok = checkShape(T, expected);
+
+	int steps = 0;
+	int checkEvery = max(1, keys / CHECKS);
+	while (static_cast<int>(expected.size()) > keys / 4) {
+		int value = static_cast<int>(rng() % keys);
+		NodeData key(makeKey(value));
+		switch (rng() % 3) {
+		case 0:
+			ok &= T.remove(key) == (expected.erase(value) == 1);
+			break;
+		case 1: {
+			NodeData* data = T.extract(key);
+			ok &= (data != nullptr) == (expected.erase(value) == 1);
+			ok &= data == nullptr || *data == key;
+			delete data;                      // the caller owns it now
+			break;
+		}
+		default: {
+			int high = value + static_cast<int>(rng() % RANGE_WIDTH);
+			auto first = expected.lower_bound(value);
+			auto last = expected.upper_bound(high);
+			int count = static_cast<int>(distance(first, last));
+			expected.erase(first, last);
+			ok &= T.removeRange(key, NodeData(makeKey(high))) == count;
+			break;
+		}
+		}
+		if (++steps % checkEvery == 0) {
+			ok &= checkShape(T, expected);
+		}
+	}
+	ok &= checkShape(T, expected);
+	int left = T.size();
+	int height = treeHeight(T);
+
+	// high below low takes nothing, the full range takes everything
+	ok &= T.removeRange(NodeData(makeKey(1)), NodeData(makeKey(0))) == 0;
+	ok &= T.removeRange(NodeData(makeKey(0)), NodeData(makeKey(keys))) == left;
+	expected.clear();
+	ok &= T.isEmpty() && checkShape(T, expected);
+	fill(T, values);
+	expected.insert(values.begin(), values.end());
+	ok &= checkShape(T, expected);
+
+	printf("  %-9s %d left, height %3d  %s\n", balanced ? "balanced" : "plain",
+		left, height, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+//------------------------------ checkShape ----------------------------------
+// Reads the shape of T back from its sideways text and returns true if T
+// holds exactly the keys of expected, every data has the rank of its
+// position, and every node has the right cached height. In balanced mode
+// the heights of the two children of every node must also differ by at
+// most one.
+bool checkShape(const BinTree& T, const set<int>& expected) {
+	ostringstream text;
+	{
+		TreeWriter writer(text, TreeWriter::SIDEWAYS);
+		writer.write(T);
+	}
+
+	vector<string> keys;
+	vector<int> depths;
+	istringstream lines(text.str());
+	string line;
+	while (getline(lines, line)) {
+		size_t indent = line.find_first_not_of(' ');
+		keys.push_back(line.substr(indent));
+		depths.push_back(static_cast<int>(indent / 4));
+	}
+	reverse(keys.begin(), keys.end());
+	reverse(depths.begin(), depths.end());
+
+	bool ok = T.size() == static_cast<int>(expected.size())
+		&& keys.size() == expected.size();
+	int position = 0;
+	for (auto it = expected.begin(); ok && it != expected.end(); ++it) {
+		ok = keys[position] == makeKey(*it)
+			&& T.rank(NodeData(keys[position])) == position;
+		position++;
+	}
+	if (ok && !keys.empty()) {
+		int top = *min_element(depths.begin(), depths.end());     // the root
+		checkSubtree(T, keys, depths, 0, static_cast<int>(keys.size()), top,
+			ok);
+	}
+	return ok;
+}
+
+//----------------------------- checkSubtree ---------------------------------
+// Returns the height of the subtree held by positions low .. high - 1 of
+// keys, whose root is the one position there at depth top. Clears ok if a
+// node's cached height is not its real height or, in balanced mode, its
+// children differ in height by more than one.
+int checkSubtree(const BinTree& T, const vector<string>& keys,
+	const vector<int>& depths, int low, int high, int top, bool& ok) {
+	if (low >= high) {
+		return 0;
+	}
+	int at = low;
+	while (at < high && depths[at] != top) {
+		at++;
+	}
+	if (at == high) {
+		ok = false;                               // no node at this depth
+		return 0;
+	}
+
+	int left = checkSubtree(T, keys, depths, low, at, top + 1, ok);
+	int right = checkSubtree(T, keys, depths, at + 1, high, top + 1, ok);
+	int height = max(left, right) + 1;
+	ok &= T.getHeight(NodeData(keys[at])) == height;
+	ok &= !T.isBalanced() || abs(left - right) <= 1;
+	return height;
+}
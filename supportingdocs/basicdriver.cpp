@@ -0,0 +1,343 @@
+// ------------------------------ basicdriver.cpp -----------------------------
+// Check driver for the BasicBinTree class template. Runs random inserts and
+// removes on balanced and plain trees of int next to a std::set and checks
+// every query against it: retrieve, the bounds, rank, select, countRange
+// and getHeight. Then checks iteration both ways and the allocator and
+// move behaviour of copies, moves and assignments.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -I. -Isupportingdocs
+//       supportingdocs/basicdriver.cpp -o basicdriver
+//   ./basicdriver [keys]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - keys defaults to 200,000 random inserts and as many random removes, of
+//   values from 0 to 2 * keys - 1, so many of both find nothing to do.
+// - The queries are checked every keys / CHECKS operations, for PROBES
+//   random values each time.
+// - Allocator checks use Arena, an allocator that counts the nodes each
+//   arena has live and checks that each node goes back to the arena it
+//   came from. Arenas only compare equal to themselves, and propagate on
+//   copy and move assignment or not, depending on their second parameter.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "basicbintree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int CHECKS = 8;
+const int PROBES = 2000;
+const int ARENAS = 4;
+
+int liveNodes[ARENAS];                   // nodes each arena has handed out
+bool wrongArena = false;                 // a node went back to another arena
+
+template <typename T, bool Propagate>
+struct Arena {
+	typedef T value_type;
+	typedef integral_constant<bool, Propagate>
+		propagate_on_container_copy_assignment;
+	typedef integral_constant<bool, Propagate>
+		propagate_on_container_move_assignment;
+	typedef integral_constant<bool, Propagate> propagate_on_container_swap;
+	typedef false_type is_always_equal;
+
+	int id;                              // index into liveNodes
+
+	explicit Arena(int id = 0) : id(id) {}
+	template <typename U>
+	Arena(const Arena<U, Propagate>& other) : id(other.id) {}
+	template <typename U>
+	struct rebind { typedef Arena<U, Propagate> other; };
+
+	// every block starts with the id of the arena that made it
+	T* allocate(size_t n) {
+		liveNodes[id] += static_cast<int>(n);
+		char* block = static_cast<char*>(::operator new(n * sizeof(T)
+			+ alignof(max_align_t)));
+		*reinterpret_cast<int*>(block) = id;
+		return reinterpret_cast<T*>(block + alignof(max_align_t));
+	}
+	void deallocate(T* p, size_t n) {
+		char* block = reinterpret_cast<char*>(p) - alignof(max_align_t);
+		wrongArena |= *reinterpret_cast<int*>(block) != id;
+		liveNodes[id] -= static_cast<int>(n);
+		::operator delete(block);
+	}
+
+	template <typename U>
+	bool operator==(const Arena<U, Propagate>& other) const {
+		return id == other.id;
+	}
+	template <typename U>
+	bool operator!=(const Arena<U, Propagate>& other) const {
+		return id != other.id;
+	}
+};
+
+typedef BasicBinTree<int> IntTree;
+typedef BasicBinTree<string, less<string>, Arena<string, false>> FixedTree;
+typedef BasicBinTree<string, less<string>, Arena<string, true>> MovingTree;
+
+//global function prototypes
+bool checkRandom(bool balanced, int keys);
+bool checkQueries(const IntTree&, const set<int>&, int range, mt19937& rng);
+bool checkIterators(int keys);
+template <typename Tree>
+bool checkAllocators(bool propagate);
+bool checkMoves();
+bool liveAre(int first, int second, int third);
+
+int main(int argc, char* argv[]) {
+	int keys = (argc > 1) ? atoi(argv[1]) : 200000;
+	bool passed = true;
+
+	cout << "BasicBinTree, " << keys << " keys:" << endl;
+	auto start = chrono::steady_clock::now();
+	passed &= report("balanced, random", msSince(start),
+		checkRandom(true, keys));
+	start = chrono::steady_clock::now();
+	passed &= report("plain, random", msSince(start), checkRandom(false, keys));
+	start = chrono::steady_clock::now();
+	passed &= report("iterators", msSince(start), checkIterators(keys));
+	start = chrono::steady_clock::now();
+	passed &= report("fixed allocators", msSince(start),
+		checkAllocators<FixedTree>(false));
+	start = chrono::steady_clock::now();
+	passed &= report("moving allocators", msSince(start),
+		checkAllocators<MovingTree>(true));
+	start = chrono::steady_clock::now();
+	passed &= report("moves", msSince(start), checkMoves());
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//------------------------------ checkRandom ---------------------------------
+// Inserts keys random values into a tree, then removes keys random values,
+// doing the same to a std::set. Returns true if every insert and remove
+// returned what the set did and every round of queries passed.
+bool checkRandom(bool balanced, int keys) {
+	mt19937 rng(balanced ? 343 : 344);
+	int range = 2 * keys;
+	IntTree T(balanced);
+	set<int> expected;
+	bool ok = T.isBalanced() == balanced && T.isEmpty();
+	int checkEvery = max(1, keys / CHECKS);
+
+	for (int i = 0; i < 2 * keys; i++) {
+		int value = static_cast<int>(rng() % range);
+		if (i < keys) {
+			ok &= T.insert(value) == expected.insert(value).second;
+		}
+		else {
+			ok &= T.remove(value) == (expected.erase(value) == 1);
+		}
+		if (i % checkEvery == 0) {
+			ok &= checkQueries(T, expected, range, rng);
+		}
+	}
+	ok &= checkQueries(T, expected, range, rng);
+
+	T.makeEmpty();
+	ok &= T.isEmpty() && T.size() == 0 && T.begin() == T.end();
+	return ok;
+}
+
+//----------------------------- checkQueries ---------------------------------
+// Returns true if T matches expected: size, PROBES random retrieves, bounds,
+// ranks, selects and range counts, the cached height of every key, and the
+// AVL height bound in balanced mode.
+bool checkQueries(const IntTree& T, const set<int>& expected, int range,
+	mt19937& rng) {
+	bool ok = T.size() == static_cast<int>(expected.size());
+	vector<int> sorted(expected.begin(), expected.end());
+	const int* found = nullptr;
+
+	for (int i = 0; i < PROBES; i++) {
+		int value = static_cast<int>(rng() % range);
+		auto lower = lower_bound(sorted.begin(), sorted.end(), value);
+		auto upper = upper_bound(sorted.begin(), sorted.end(), value);
+		bool present = lower != upper;
+
+		ok &= T.retrieve(value, found) == present
+			&& (!present || *found == value);
+		ok &= T.lowerBound(value, found) == (lower != sorted.end())
+			&& (lower == sorted.end() || *found == *lower);
+		ok &= T.ceiling(value, found) == (lower != sorted.end())
+			&& (lower == sorted.end() || *found == *lower);
+		ok &= T.upperBound(value, found) == (upper != sorted.end())
+			&& (upper == sorted.end() || *found == *upper);
+		ok &= T.floor(value, found) == (upper != sorted.begin())
+			&& (upper == sorted.begin() || *found == *(upper - 1));
+		ok &= T.rank(value) == static_cast<int>(lower - sorted.begin());
+
+		int k = static_cast<int>(rng() % (sorted.size() + 1));
+		bool selected = T.select(k, found);
+		ok &= selected == (k < static_cast<int>(sorted.size()))
+			&& (!selected || *found == sorted[k]);
+
+		int high = value + static_cast<int>(rng() % 100);
+		ok &= T.countRange(value, high) == static_cast<int>(
+			upper_bound(sorted.begin(), sorted.end(), high) - lower);
+	}
+
+	// the largest cached height is the root's, so it bounds every path
+	int height = 0;
+	for (int value : T) {
+		height = max(height, T.getHeight(value));
+	}
+	ok &= T.getHeight(range) == 0;
+	ok &= !T.isBalanced()
+		|| height <= static_cast<int>(1.4405 * log2(T.size() + 2.0));
+	return ok;
+}
+
+//---------------------------- checkIterators --------------------------------
+// Returns true if a tree of keys random values iterates in sorted order
+// forwards and backwards, steps back from end(), and keeps its iterators
+// valid while other keys are inserted and removed.
+bool checkIterators(int keys) {
+	mt19937 rng(345);
+	IntTree T(true);
+	set<int> expected;
+	for (int i = 0; i < keys; i++) {
+		int value = static_cast<int>(rng() % (2 * keys));
+		T.insert(value);
+		expected.insert(value);
+	}
+
+	bool ok = equal(T.begin(), T.end(), expected.begin(), expected.end());
+	ok &= equal(T.rbegin(), T.rend(), expected.rbegin(), expected.rend());
+	ok &= distance(T.begin(), T.end()) == T.size();
+
+	auto last = T.end();
+	--last;
+	ok &= *last == *expected.rbegin();
+	auto it = T.begin();
+	ok &= *it++ == *expected.begin() && it != T.begin();
+	ok &= *--it == *expected.begin();
+
+	// iterators point at nodes, which stay put while others come and go
+	auto middle = next(T.begin(), T.size() / 2);
+	int held = *middle;
+	for (int i = 0; i < keys / 2; i++) {
+		int value = static_cast<int>(rng() % (2 * keys));
+		T.insert(value);
+		expected.insert(value);
+		value = static_cast<int>(rng() % (2 * keys));
+		if (value != held) {
+			T.remove(value);
+			expected.erase(value);
+		}
+	}
+	ok &= *middle == held;
+	ok &= equal(middle, T.end(), expected.find(held), expected.end());
+	ok &= equal(T.begin(), middle, expected.begin(), expected.find(held));
+	return ok;
+}
+
+//---------------------------- checkAllocators -------------------------------
+// Copies, moves and assigns trees on different arenas and returns true if
+// the nodes end up in the arenas the allocator rules say: copies on the
+// source's arena, moves taking the nodes along, and assignments taking the
+// source's arena only when the allocator propagates. Every node must go
+// back to its own arena, and none may be left at the end.
+template <typename Tree>
+bool checkAllocators(bool propagate) {
+	typedef typename Tree::allocator_type Alloc;
+	const int n = 1000;
+	bool ok = true;
+	{
+		Tree first(true, less<string>(), Alloc(1));
+		Tree second(true, less<string>(), Alloc(2));
+		for (int i = 0; i < n; i++) {
+			first.insert(makeKey(i));
+			second.insert(makeKey(n + i) + string(40, 'x'));
+		}
+		ok &= liveAre(0, n, n);
+
+		Tree copy(second);                          // the source's arena
+		ok &= copy == second && liveAre(0, n, 2 * n);
+
+		Tree moved(move(copy));                     // nodes go along
+		ok &= moved == second && copy.isEmpty() && liveAre(0, n, 2 * n);
+		copy.insert(makeKey(0));                    // still usable
+		ok &= copy.size() == 1 && liveAre(0, n, 2 * n + 1);
+		copy.makeEmpty();
+
+		// copy assignment takes the arena along only if it propagates
+		first = second;
+		ok &= first == second;
+		ok &= propagate ? liveAre(0, 0, 3 * n) : liveAre(0, n, 2 * n);
+
+		// a move between unequal arenas either takes the arena along or
+		// moves each key into a node of its own arena
+		Tree third(true, less<string>(), Alloc(3));
+		third.insert(makeKey(0));
+		third = move(moved);
+		ok &= third == second && moved.isEmpty();
+		ok &= propagate ? liveNodes[3] == 0 : liveNodes[3] == n;
+		ok &= liveNodes[1] + liveNodes[2] + liveNodes[3] == 3 * n;
+	}
+	ok &= liveAre(0, 0, 0) && liveNodes[3] == 0 && !wrongArena;
+	return ok;
+}
+
+//------------------------------ checkMoves ----------------------------------
+// Returns true if moves are noexcept where the allocator allows it, and a
+// tree moved from, by construction or assignment, is empty and usable.
+bool checkMoves() {
+	bool ok = is_nothrow_move_constructible<IntTree>::value
+		&& is_nothrow_move_assignable<IntTree>::value
+		&& is_nothrow_move_constructible<FixedTree>::value
+		&& !is_nothrow_move_assignable<FixedTree>::value
+		&& is_nothrow_move_constructible<MovingTree>::value
+		&& is_nothrow_move_assignable<MovingTree>::value;
+
+	IntTree source(true);
+	for (int i = 0; i < 1000; i++) {
+		source.insert(i);
+	}
+	IntTree target(move(source));
+	ok &= target.size() == 1000 && source.isEmpty() && source.size() == 0;
+	ok &= target.isBalanced();
+
+	source.insert(7);
+	IntTree other(false);
+	other.insert(1);
+	other = move(target);
+	ok &= other.size() == 1000 && other.isBalanced() && target.isEmpty();
+	target.insert(3);
+	ok &= target.size() == 1 && source.size() == 1;
+
+	// moving into itself through a reference must leave the tree intact
+	IntTree& alias = other;
+	other = move(alias);
+	ok &= other.size() == 1000;
+	return ok;
+}
+
+//-------------------------------- liveAre -----------------------------------
+// Returns true if arenas 0, 1 and 2 have exactly these nodes live.
+bool liveAre(int first, int second, int third) {
+	return liveNodes[0] == first && liveNodes[1] == second
+		&& liveNodes[2] == third;
+}
@@ -0,0 +1,104 @@
+// ---------------------------- buffereddriver.cpp ----------------------------
+// Benchmark for BufferedBinTree. Inserts the same random keys into a
+// BufferedBinTree, flushing at the end, and, as the baseline, into a
+// balanced BinTree with one insert per data, deleting the duplicates as
+// buildTree does. Both trees must end up with the same data, and data must
+// be found by retrieve as soon as it is inserted, before any flush.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/buffereddriver.cpp bufferedbintree.cpp bintree.cpp
+//       treewriter.cpp supportingdocs/nodedata.cpp -o buffereddriver
+//   ./buffereddriver [keys]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - keys defaults to 2,000,000 random 32-bit numbers as text, so a few
+//   repeat.
+// - The buffered tree is timed with the default batch size and with a
+//   small one, BufferedBinTree::DEFAULT_BATCH / 16.
+// - Every READ_EVERY inserts, the last key inserted is looked up; these
+//   reads are part of the timed loops on both sides.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bintree.h"
+#include "bufferedbintree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int READ_EVERY = 1000;
+
+int main(int argc, char* argv[]) {
+	int count = (argc > 1) ? atoi(argv[1]) : 2000000;
+	bool passed = true;
+	mt19937 rng(343);
+
+	vector<string> keys;
+	for (int i = 0; i < count; i++) {
+		keys.push_back(to_string(rng()));
+	}
+
+	cout << count << " random keys, insert and flush:" << endl;
+
+	// the baseline: one search per insert, duplicates deleted at once
+	BinTree expected(true);
+	NodeData* found = nullptr;
+	bool seen = true;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < count; i++) {
+		NodeData* data = new NodeData(keys[i]);
+		if (!expected.insert(data)) {
+			delete data;
+		}
+		if (i % READ_EVERY == 0) {
+			seen &= expected.retrieve(NodeData(keys[i]), found);
+		}
+	}
+	double treeMs = msSince(start);
+	printf("  %-24s %10.1f ms\n", "BinTree::insert", treeMs);
+	passed &= seen;
+
+	int batches[] = { BufferedBinTree::DEFAULT_BATCH,
+		BufferedBinTree::DEFAULT_BATCH / 16 };
+	for (int batch : batches) {
+		vector<NodeData*> items;
+		for (const string& key : keys) {
+			items.push_back(new NodeData(key));
+		}
+
+		BufferedBinTree buffered(true, batch);
+		seen = true;
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < count; i++) {
+			buffered.insert(items[i]);
+			if (i % READ_EVERY == 0) {
+				seen &= buffered.retrieve(NodeData(keys[i]), found);
+			}
+		}
+		buffered.flush();
+		double ms = msSince(start);
+
+		const BinTree& tree = buffered.getTree();
+		bool ok = seen && buffered.buffered() == 0
+			&& tree.size() == expected.size()
+			&& equal(tree.begin(), tree.end(), expected.begin());
+		passed &= ok;
+
+		char label[32];
+		snprintf(label, sizeof(label), "buffered, batch %d", batch);
+		printf("  %-24s %10.1f ms  %4.1fx  %s\n", label, ms, treeMs / ms,
+			ok ? "ok" : "FAILED");
+	}
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
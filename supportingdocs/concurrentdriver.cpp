@@ -0,0 +1,223 @@
+// -------------------------- concurrentdriver.cpp ----------------------------
+// Stress driver and read-scaling benchmark for ConcurrentBinTree.
+//
+// The stress part runs one writer that keeps inserting and removing odd
+// keys while reader threads retrieve keys, read their data, take heights
+// and walk Snapshots. Even keys are inserted up front and never removed, so
+// every reader must always find them. Data the readers reach is read in
+// full, so a node or data freed too early shows up under AddressSanitizer,
+// and a missing barrier shows up under ThreadSanitizer.
+//
+// The benchmark then measures lookups per second for 1, 2, 4, ... reader
+// threads against the same tree while the writer keeps churning, next to
+// the same lookups on a BinTree behind one mutex with no writer at all.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/concurrentdriver.cpp concurrentbintree.cpp
+//       bintree.cpp treewriter.cpp supportingdocs/nodedata.cpp
+//       -o concurrentdriver
+//   ./concurrentdriver [keys] [stress ms] [bench ms]
+// For the race check, build with -O1 -g -fsanitize=thread instead of -O2.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - keys defaults to 100,000 stable keys, stress ms to 3000 and bench ms
+//   to 500 per thread count.
+// - Reader threads go up to the number of hardware threads, and to at
+//   least 4 so the stress part always has several readers.
+// - Exits with 1 if a reader saw a wrong result, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bintree.h"
+#include "concurrentbintree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+//global function prototypes
+void churn(ConcurrentBinTree&, int keys, atomic<bool>& stop, unsigned seed);
+bool readLoop(const ConcurrentBinTree&, int keys, atomic<bool>& stop,
+	unsigned seed);
+double lookupRate(int threads, int keys, int ms,
+	bool (*lookup)(const void*, const NodeData&), const void* tree);
+bool lookupConcurrent(const void* tree, const NodeData& key);
+bool lookupLocked(const void* tree, const NodeData& key);
+
+mutex treeLock;                          // guards the BinTree baseline
+
+int main(int argc, char* argv[]) {
+	int keys = (argc > 1) ? atoi(argv[1]) : 100000;
+	int stressMs = (argc > 2) ? atoi(argv[2]) : 3000;
+	int benchMs = (argc > 3) ? atoi(argv[3]) : 500;
+	int maxThreads = max(4, static_cast<int>(thread::hardware_concurrency()));
+
+	ConcurrentBinTree T;
+	BinTree locked(true);
+	for (int i = 0; i < keys; i++) {
+		T.insert(new NodeData(makeKey(2 * i)));
+		locked.insert(new NodeData(makeKey(2 * i)));
+	}
+
+	cout << "Stress: 1 writer, " << maxThreads << " readers, " << stressMs
+		<< " ms" << endl;
+	atomic<bool> stop(false);
+	atomic<bool> passed(true);
+	thread writer(churn, ref(T), keys, ref(stop), 1u);
+	vector<thread> readers;
+	for (int i = 0; i < maxThreads; i++) {
+		readers.emplace_back([&, i]() {
+			if (!readLoop(T, keys, stop, 100u + i)) {
+				passed = false;
+			}
+		});
+	}
+	this_thread::sleep_for(chrono::milliseconds(stressMs));
+	stop = true;
+	writer.join();
+	for (thread& reader : readers) {
+		reader.join();
+	}
+	cout << "  " << (passed ? "ok" : "FAILED") << ", " << T.size()
+		<< " keys at the end" << endl;
+
+	cout << endl << "Read scaling with 1 writer (M lookups/s):" << endl;
+	printf("  %8s %14s %14s\n", "readers", "concurrent", "mutex+BinTree");
+	stop = false;
+	writer = thread(churn, ref(T), keys, ref(stop), 2u);
+	for (int threads = 1; threads <= maxThreads; threads *= 2) {
+		double lockFree = lookupRate(threads, keys, benchMs,
+			lookupConcurrent, &T);
+		double mutexed = lookupRate(threads, keys, benchMs,
+			lookupLocked, &locked);
+		printf("  %8d %14.2f %14.2f\n", threads, lockFree, mutexed);
+	}
+	stop = true;
+	writer.join();
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//-------------------------------- churn -------------------------------------
+// Writer loop: inserts or removes a random odd key until stop is set.
+void churn(ConcurrentBinTree& T, int keys, atomic<bool>& stop, unsigned seed) {
+	mt19937 rng(seed);
+	while (!stop) {
+		int value = 2 * static_cast<int>(rng() % keys) + 1;
+		if (rng() % 2 == 0) {
+			NodeData* ptr = new NodeData(makeKey(value));
+			if (!T.insert(ptr)) {
+				delete ptr;
+			}
+		}
+		else {
+			T.remove(NodeData(makeKey(value)));
+		}
+	}
+}
+
+//------------------------------- readLoop -----------------------------------
+// Reader loop: checks lookups, heights and Snapshots until stop is set.
+// Returns false at the first wrong result.
+bool readLoop(const ConcurrentBinTree& T, int keys, atomic<bool>& stop,
+		unsigned seed) {
+	mt19937 rng(seed);
+	for (long long round = 0; !stop; round++) {
+		int value = static_cast<int>(rng() % (2 * keys));
+		string key = makeKey(value);
+		NodeData* found = nullptr;
+		bool hit = T.retrieve(NodeData(key), found);
+
+		// stable keys are always there; data found must match the key
+		if ((value % 2 == 0 && !hit) || (hit && found->getData() != key)) {
+			return false;
+		}
+		if (value % 2 == 0 && T.getHeight(NodeData(key)) < 1) {
+			return false;
+		}
+
+		if (round % 2048 == 0) {
+			ConcurrentBinTree::Snapshot view(T);
+			int count = 0;
+			int stable = 0;
+			string previous;
+			for (const NodeData& data : view) {
+				if (count > 0 && !(previous < data.getData())) {
+					return false;
+				}
+				previous = data.getData();
+				stable += (previous.back() - '0') % 2 == 0;
+				count++;
+			}
+			if (count != view.size() || stable != keys) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//------------------------------ lookupRate ----------------------------------
+// Returns the millions of lookups per second that threads readers reach
+// together on tree in ms milliseconds.
+double lookupRate(int threads, int keys, int ms,
+		bool (*lookup)(const void*, const NodeData&), const void* tree) {
+	atomic<bool> stop(false);
+	atomic<long long> total(0);
+	vector<thread> readers;
+
+	for (int i = 0; i < threads; i++) {
+		readers.emplace_back([&, i]() {
+			mt19937 rng(1000u + i);
+			vector<NodeData> probes;
+			for (int j = 0; j < 4096; j++) {
+				int value = static_cast<int>(rng() % (2 * keys));
+				probes.emplace_back(makeKey(value));
+			}
+			long long done = 0;
+			while (!stop) {
+				for (const NodeData& probe : probes) {
+					lookup(tree, probe);
+				}
+				done += probes.size();
+			}
+			total += done;
+		});
+	}
+
+	auto start = chrono::steady_clock::now();
+	this_thread::sleep_for(chrono::milliseconds(ms));
+	stop = true;
+	for (thread& reader : readers) {
+		reader.join();
+	}
+	double seconds = chrono::duration<double>(
+		chrono::steady_clock::now() - start).count();
+	return total / seconds / 1e6;
+}
+
+//--------------------------- lookupConcurrent -------------------------------
+// Lock-free lookup in a ConcurrentBinTree.
+bool lookupConcurrent(const void* tree, const NodeData& key) {
+	NodeData* found = nullptr;
+	return static_cast<const ConcurrentBinTree*>(tree)->retrieve(key, found);
+}
+
+//----------------------------- lookupLocked ---------------------------------
+// Lookup in a BinTree under the global mutex, as callers do today.
+bool lookupLocked(const void* tree, const NodeData& key) {
+	lock_guard<mutex> guard(treeLock);
+	NodeData* found = nullptr;
+	return static_cast<const BinTree*>(tree)->retrieve(key, found);
+}
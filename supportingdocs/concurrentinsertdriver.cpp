@@ -0,0 +1,175 @@
+// ----------------------- concurrentinsertdriver.cpp -------------------------
+// Multi-producer driver for ConcurrentInsertTree. In each round, producer
+// threads all insert the same keys at once, each in its own order or all
+// in the same one, and retrieve every key they have inserted while the
+// others are still inserting. Then it checks that exactly one insert
+// succeeded for every key, that the tree kept the data of that insert, and
+// that moveTo leaves a BinTree with all the keys in sorted order and the
+// height of a balanced tree.
+//
+// Producers delete the data of every insert that returned false as soon as
+// it returns, and the data of the tree is only read after that, so data the
+// tree kept by mistake shows up under AddressSanitizer as a use after free.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/concurrentinsertdriver.cpp concurrentinserttree.cpp
+//       bintree.cpp treewriter.cpp supportingdocs/nodedata.cpp
+//       -o concurrentinsertdriver
+//   ./concurrentinsertdriver [keys] [rounds]
+// For the race check, build with -O1 -g -fsanitize=thread instead of -O2.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - keys defaults to 200,000 and rounds to 6. Every producer inserts every
+//   key, so each round makes keys * producers inserts.
+// - Producers go up to the number of hardware threads, and to at least 4
+//   so that inserts always contend.
+// - Odd rounds give all producers the same order, so they race for the
+//   same empty link; even rounds give each producer its own order.
+// - The BinTree that moveTo fills already holds data, which moveTo must
+//   replace; it is balanced in even rounds and plain in odd ones.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bintree.h"
+#include "concurrentinserttree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+//global function prototypes
+bool produce(ConcurrentInsertTree&, const vector<int>& order,
+	vector<NodeData*>& won);
+bool checkRound(ConcurrentInsertTree&, int keys,
+	const vector<vector<NodeData*>>& won, bool balanced);
+
+int main(int argc, char* argv[]) {
+	int keys = (argc > 1) ? atoi(argv[1]) : 200000;
+	int rounds = (argc > 2) ? atoi(argv[2]) : 6;
+	int producers = max(4, static_cast<int>(thread::hardware_concurrency()));
+	bool passed = true;
+
+	cout << producers << " producers, " << keys << " keys each:" << endl;
+	for (int round = 0; round < rounds; round++) {
+		vector<vector<int>> orders(producers, vector<int>(keys));
+		for (int p = 0; p < producers; p++) {
+			for (int i = 0; i < keys; i++) {
+				orders[p][i] = i;
+			}
+			unsigned seed = (round % 2 == 1) ? round : round * producers + p;
+			shuffle(orders[p].begin(), orders[p].end(), mt19937(seed));
+		}
+
+		ConcurrentInsertTree T;
+		vector<vector<NodeData*>> won(producers);
+		atomic<bool> found(true);
+		vector<thread> threads;
+		auto start = chrono::steady_clock::now();
+		for (int p = 0; p < producers; p++) {
+			threads.emplace_back([&, p]() {
+				if (!produce(T, orders[p], won[p])) {
+					found = false;
+				}
+			});
+		}
+		for (thread& producer : threads) {
+			producer.join();
+		}
+		double ms = msSince(start);
+
+		bool ok = found && checkRound(T, keys, won, round % 2 == 0);
+		passed &= ok;
+		printf("  round %d, %-10s %10.1f ms  %s\n", round,
+			round % 2 == 1 ? "same order" : "own orders", ms,
+			ok ? "ok" : "FAILED");
+	}
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//------------------------------- produce ------------------------------------
+// Inserts a new data for each value of order into T. Sets won[value] to
+// the data of each insert that succeeded and deletes the data of the
+// others. After each insert, retrieves that value and one inserted
+// earlier. Returns true if each retrieve found data equal to its key.
+bool produce(ConcurrentInsertTree& T, const vector<int>& order,
+	vector<NodeData*>& won) {
+	bool found = true;
+	won.assign(order.size(), nullptr);
+	for (size_t i = 0; i < order.size(); i++) {
+		NodeData* data = new NodeData(makeKey(order[i]));
+		if (T.insert(data)) {
+			won[order[i]] = data;
+		}
+		else {
+			delete data;                   // rejected, still the caller's
+		}
+
+		// the key just inserted, and one inserted earlier
+		for (size_t at : { i, i / 2 }) {
+			NodeData key(makeKey(order[at]));
+			NodeData* seen = nullptr;
+			found &= T.retrieve(key, seen) && *seen == key;
+		}
+	}
+	return found;
+}
+
+//------------------------------ checkRound ----------------------------------
+// Checks T after all producers are done, won[p] being what producer p
+// recorded. Exactly one producer must have won each key, and T must hold
+// that producer's data. Then moves T into a BinTree that already holds
+// data and checks the result. Returns true if every check passed.
+bool checkRound(ConcurrentInsertTree& T, int keys,
+	const vector<vector<NodeData*>>& won, bool balanced) {
+	bool ok = T.size() == keys;
+	vector<NodeData*> winners(keys, nullptr);
+	for (int value = 0; value < keys; value++) {
+		int wins = 0;
+		for (const vector<NodeData*>& producer : won) {
+			if (producer[value] != nullptr) {
+				winners[value] = producer[value];
+				wins++;
+			}
+		}
+		NodeData* seen = nullptr;
+		ok &= wins == 1 && T.retrieve(NodeData(makeKey(value)), seen)
+			&& seen == winners[value];
+	}
+
+	BinTree tree(balanced);
+	for (int value = keys; value < keys + 100; value++) {
+		tree.insert(new NodeData(makeKey(value)));
+	}
+	ok &= T.moveTo(tree) == keys && T.isEmpty() && T.size() == 0;
+	ok &= tree.size() == keys && tree.isBalanced() == balanced;
+
+	// sorted, and the very data the winners inserted
+	int position = 0;
+	int height = 0;
+	for (const NodeData& data : tree) {
+		ok &= position < keys && &data == winners[position];
+		height = max(height, tree.getHeight(data));
+		position++;
+	}
+	ok &= position == keys;
+	ok &= keys == 0 || height == static_cast<int>(floor(log2(keys))) + 1;
+
+	// still an ordinary BinTree afterwards
+	NodeData* extra = new NodeData(makeKey(keys));
+	ok &= tree.insert(extra) && tree.remove(NodeData(makeKey(0)));
+	ok &= tree.rank(*extra) == keys - 1;
+	return ok;
+}
@@ -0,0 +1,51 @@
+// ------------------------------ driverutil.h --------------------------------
+// Small helpers shared by the drivers in supportingdocs: the zero padded
+// keys they build trees from, and the timing and report lines they print.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Only the drivers include this file, each from its one source file, so
+//   the helpers are inline and need no source file of their own.
+// - Keys are nine digits, so string order is numeric order for values
+//   from 0 to 999,999,999.
+// - Times are taken with steady_clock.
+// ----------------------------------------------------------------------------
+
+#ifndef DRIVERUTIL_H
+#define DRIVERUTIL_H
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace std;
+
+//------------------------------- makeKey ------------------------------------
+// Returns value as a nine digit, zero padded string.
+inline string makeKey(int value) {
+	char buffer[16];
+	snprintf(buffer, sizeof(buffer), "%09d", value);
+	return buffer;
+}
+
+//------------------------------- msSince ------------------------------------
+// Returns the milliseconds since start.
+inline double msSince(chrono::steady_clock::time_point start) {
+	return chrono::duration<double, milli>(
+		chrono::steady_clock::now() - start).count();
+}
+
+//-------------------------------- nsPer -------------------------------------
+// Returns the nanoseconds since start divided by count.
+inline double nsPer(chrono::steady_clock::time_point start, int count) {
+	return chrono::duration<double, nano>(
+		chrono::steady_clock::now() - start).count() / count;
+}
+
+//-------------------------------- report ------------------------------------
+// Prints one line for step, with the time it took, and returns ok.
+inline bool report(const char* step, double ms, bool ok) {
+	printf("  %-22s %10.3f ms  %s\n", step, ms, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+#endif
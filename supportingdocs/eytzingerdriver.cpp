@@ -0,0 +1,130 @@
+// --------------------------- eytzingerdriver.cpp ----------------------------
+// Benchmark for EytzingerIndex against the BinTree it is built from. For
+// trees of growing size it times retrieve, lowerBound and range scans of
+// about 50 keys on both, with the same random probes, and checks that both
+// give the same answers.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/eytzingerdriver.cpp eytzingerindex.cpp bintree.cpp
+//       treewriter.cpp supportingdocs/nodedata.cpp -o eytzingerdriver
+//   ./eytzingerdriver [largest size]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Sizes go from 1,000 up to the largest size, 10,000,000 by default, by
+//   factors of 10. Each 10M keys need about 1.5 GB for the tree and the
+//   index together, so 100M needs a machine with about 16 GB.
+// - The tree is built with bulkLoad, which lays its top levels out close
+//   together; a tree built by random inserts is slower to search than this.
+// - Probes are random keys, half of them absent.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bintree.h"
+#include "eytzingerindex.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int PROBES = 200000;
+const int SCAN = 100;                    // values spanned by a range scan
+
+//global function prototypes
+
+int main(int argc, char* argv[]) {
+	int largest = (argc > 1) ? atoi(argv[1]) : 10000000;
+	bool passed = true;
+	mt19937 rng(343);
+
+	cout << "ns per query, BinTree / EytzingerIndex:" << endl;
+	printf("  %10s %19s %19s %19s\n", "size", "retrieve", "lowerBound",
+		"scan of 50");
+
+	for (int size = 1000; size <= largest; size *= 10) {
+		vector<NodeData*> items;
+		for (int i = 0; i < size; i++) {
+			items.push_back(new NodeData(makeKey(2 * i)));
+		}
+		BinTree T;
+		T.bulkLoad(items.data(), size);
+		EytzingerIndex index(T);
+
+		vector<NodeData> probes;
+		for (int i = 0; i < PROBES; i++) {
+			int value = static_cast<int>(rng() % (2 * size));
+			probes.emplace_back(makeKey(value));
+		}
+		vector<const NodeData*> answers(PROBES);
+
+		NodeData* found = nullptr;
+		const NodeData* indexed = nullptr;
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < PROBES; i++) {
+			answers[i] = T.retrieve(probes[i], found) ? found : nullptr;
+		}
+		double treeRetrieve = nsPer(start, PROBES);
+
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < PROBES; i++) {
+			bool hit = index.retrieve(probes[i], indexed);
+			passed &= hit == (answers[i] != nullptr);
+			passed &= !hit || *indexed == *answers[i];
+		}
+		double indexRetrieve = nsPer(start, PROBES);
+
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < PROBES; i++) {
+			answers[i] = T.lowerBound(probes[i], found) ? found : nullptr;
+		}
+		double treeLower = nsPer(start, PROBES);
+
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < PROBES; i++) {
+			bool hit = index.lowerBound(probes[i], indexed);
+			passed &= hit == (answers[i] != nullptr);
+			passed &= !hit || *indexed == *answers[i];
+		}
+		double indexLower = nsPer(start, PROBES);
+
+		// both sides sum the lengths they see, so the scans cannot be skipped
+		vector<int> lows;
+		for (int i = 0; i < PROBES / 10; i++) {
+			lows.push_back(static_cast<int>(rng() % (2 * size)));
+		}
+		int scans = static_cast<int>(lows.size());
+		long long treeBytes = 0;
+		long long indexBytes = 0;
+		start = chrono::steady_clock::now();
+		for (int low : lows) {
+			T.forEachInRange(NodeData(makeKey(low)),
+				NodeData(makeKey(low + SCAN)), [&](const NodeData& data) {
+					treeBytes += data.getData().size();
+				});
+		}
+		double treeScan = nsPer(start, scans);
+
+		start = chrono::steady_clock::now();
+		for (int low : lows) {
+			index.forEachInRange(NodeData(makeKey(low)),
+				NodeData(makeKey(low + SCAN)), [&](const NodeData& data) {
+					indexBytes += data.getData().size();
+				});
+		}
+		double indexScan = nsPer(start, scans);
+		passed &= treeBytes > 0 && treeBytes == indexBytes;
+
+		printf("  %10d %9.1f /%8.1f %9.1f /%8.1f %9.1f /%8.1f\n", size,
+			treeRetrieve, indexRetrieve, treeLower, indexLower, treeScan,
+			indexScan);
+	}
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// ----------------------------- heightdriver.cpp -----------------------------
+// Benchmark for getHeight, which reads the height cached in each node. For
+// trees of growing size it checks every height and measures the time per
+// poll, next to the time of one walk over the whole tree: the least the
+// old getHeight paid, since it searched every node and then measured the
+// subtree under the match.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/heightdriver.cpp bintree.cpp treewriter.cpp
+//       supportingdocs/nodedata.cpp -o heightdriver
+//   ./heightdriver [largest level count]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Trees of 2^k - 1 keys are built with bulkLoad for k from 10 up to the
+//   largest level count, 20 by default. They are then perfect, so the data
+//   at sorted position i, counting from 1, has height 1 plus the number of
+//   trailing zero bits of i.
+// - The whole-tree walk is only timed up to WALK_LIMIT nodes.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bintree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int POLLS = 200000;
+const int WALK_LIMIT = 1 << 17;
+
+//global function prototypes
+int expectedHeight(int position);                 // height in a perfect tree
+
+int main(int argc, char* argv[]) {
+	int largest = (argc > 1) ? atoi(argv[1]) : 20;
+	bool passed = true;
+	mt19937 rng(343);
+
+	cout << "getHeight polls:" << endl;
+	printf("  %10s %8s %14s %14s\n", "size", "height", "ns per poll",
+		"ns per walk");
+
+	for (int levels = 10; levels <= largest; levels += 2) {
+		int size = (1 << levels) - 1;
+		vector<NodeData*> items;
+		for (int i = 1; i <= size; i++) {
+			items.push_back(new NodeData(makeKey(i)));
+		}
+
+		BinTree T;
+		T.bulkLoad(items.data(), size);
+
+		for (int i = 1; i <= size; i++) {
+			passed &= T.getHeight(NodeData(makeKey(i))) == expectedHeight(i);
+		}
+		passed &= T.getHeight(NodeData(makeKey(0))) == 0;
+
+		vector<NodeData> probes;
+		for (int i = 0; i < POLLS; i++) {
+			probes.emplace_back(makeKey(1 + static_cast<int>(rng() % size)));
+		}
+
+		long long sum = 0;
+		auto start = chrono::steady_clock::now();
+		for (const NodeData& probe : probes) {
+			sum += T.getHeight(probe);
+		}
+		auto stop = chrono::steady_clock::now();
+		double pollNs = chrono::duration<double, nano>(stop - start).count()
+			/ POLLS;
+		passed &= sum >= POLLS;
+
+		printf("  %10d %8d %14.1f ", size, levels, pollNs);
+
+		if (size <= WALK_LIMIT) {
+			int walks = 20;
+			int visited = 0;
+			start = chrono::steady_clock::now();
+			for (int i = 0; i < walks; i++) {
+				for (const NodeData& data : T) {
+					visited += data.getData().size() > 0;
+				}
+			}
+			stop = chrono::steady_clock::now();
+			passed &= visited == walks * size;
+			printf("%14.1f\n",
+				chrono::duration<double, nano>(stop - start).count() / walks);
+		}
+		else {
+			printf("%14s\n", "-");
+		}
+	}
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//---------------------------- expectedHeight --------------------------------
+// Returns the height of the node at sorted position, counting from 1, in a
+// perfect tree: 1 plus the number of trailing zero bits of position.
+int expectedHeight(int position) {
+	int height = 1;
+	while (position % 2 == 0) {
+		position /= 2;
+		height++;
+	}
+	return height;
+}
@@ -0,0 +1,148 @@
+// ----------------------------- loaderdriver.cpp -----------------------------
+// Benchmark for TreeLoader. Writes files of random numbers in the format
+// of data2.txt, then times TreeLoader::loadFile on them, with one worker
+// and with one per hardware thread, next to the buildTree loop of the lab
+// driver: one stream extraction, allocation and insert per token. Every
+// tree the loader builds is checked against the one the loop builds.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/loaderdriver.cpp treeloader.cpp bintree.cpp
+//       treewriter.cpp supportingdocs/nodedata.cpp -o loaderdriver
+//   ./loaderdriver [megabytes] [file]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - megabytes defaults to 50 and file to loaderdriver.out in the current
+//   directory; the file is removed at the end.
+// - The first file is megabytes of records of about RECORD_TOKENS tokens,
+//   which the loader builds in parallel with each other. The second is one
+//   record a tenth that size, which the loader sorts with all workers.
+// - Tokens are random numbers below TOKEN_RANGE, so some repeat.
+// - The loop copies buildTree without its echo of each token to cout.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bintree.h"
+#include "treeloader.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int RECORD_TOKENS = 1000;
+const int TOKEN_RANGE = 5000000;
+
+//global function prototypes
+size_t writeText(const string& path, size_t bytes, int recordTokens);
+bool timeFile(const string& path, size_t bytes);
+void buildTree(BinTree&, ifstream&);              // lab2, without the echo
+bool sameData(const BinTree&, const BinTree&);
+
+int main(int argc, char* argv[]) {
+	int megabytes = (argc > 1) ? atoi(argv[1]) : 50;
+	string path = (argc > 2) ? argv[2] : "loaderdriver.out";
+	size_t bytes = static_cast<size_t>(megabytes) << 20;
+	bool passed = true;
+
+	cout << "Many records:" << endl;
+	passed &= timeFile(path, writeText(path, bytes, RECORD_TOKENS));
+
+	cout << "One record:" << endl;
+	passed &= timeFile(path, writeText(path, bytes / 10, 0));
+
+	remove(path.c_str());
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//------------------------------ writeText -----------------------------------
+// Writes records of random numbers to path, at least bytes long, each
+// record ended by "$$". Records hold about recordTokens tokens, or all of
+// them if recordTokens is 0. Returns the number of bytes written.
+size_t writeText(const string& path, size_t bytes, int recordTokens) {
+	mt19937 rng(343);
+	string text;
+	while (text.size() < bytes) {
+		text += to_string(rng() % TOKEN_RANGE);
+		bool ends = recordTokens > 0 && rng() % recordTokens == 0;
+		text += ends ? " $$\n" : " ";
+	}
+	text += "$$\n";
+	ofstream out(path);
+	out << text;
+	return text.size();
+}
+
+//------------------------------- timeFile -----------------------------------
+// Loads the file at path, bytes long, both ways and prints the times.
+// Returns true if the loader built the same trees as the loop.
+bool timeFile(const string& path, size_t bytes) {
+	bool passed = true;
+
+	// the lab driver's way, one tree per record until the file runs out;
+	// a deque, as BinTree is copied when a vector grows
+	deque<BinTree> expected;
+	auto start = chrono::steady_clock::now();
+	{
+		ifstream infile(path);
+		while (!infile.eof()) {
+			expected.emplace_back();
+			buildTree(expected.back(), infile);
+		}
+		expected.pop_back();                  // the read that found the end
+	}
+	double loopMs = msSince(start);
+	printf("  %zu bytes, %zu records\n", bytes, expected.size());
+	printf("  %-22s %10.1f ms\n", "per-token insert", loopMs);
+
+	int workers[] = { 1, 0 };
+	for (int count : workers) {
+		vector<BinTree> trees;
+		start = chrono::steady_clock::now();
+		int built = TreeLoader::loadFile(path, trees, false, count);
+		double ms = msSince(start);
+
+		bool ok = built == static_cast<int>(expected.size());
+		for (int i = 0; ok && i < built; i++) {
+			ok = sameData(trees[i], expected[i]);
+		}
+		passed &= ok;
+		printf("  loadFile, %-12s %10.1f ms  %4.1fx  %s\n",
+			count == 1 ? "1 worker" : "all workers", ms, loopMs / ms,
+			ok ? "ok" : "FAILED");
+	}
+	return passed;
+}
+
+//------------------------------- buildTree ----------------------------------
+// Builds T from the next record of infile, as the lab driver does.
+void buildTree(BinTree& T, ifstream& infile) {
+	string s;
+
+	for (;;) {
+		infile >> s;
+		if (s == "$$") break;                // at end of one line
+		if (infile.eof()) break;             // no more lines of data
+		NodeData* ptr = new NodeData(s);
+
+		bool success = T.insert(ptr);
+		if (!success)
+			delete ptr;                       // duplicate case, not inserted
+	}
+}
+
+//------------------------------- sameData -----------------------------------
+// Returns true if both trees hold the same data, whatever their shape.
+bool sameData(const BinTree& first, const BinTree& second) {
+	return first.size() == second.size()
+		&& equal(first.begin(), first.end(), second.begin());
+}
@@ -0,0 +1,147 @@
+// ----------------------------- lookupdriver.cpp -----------------------------
+// Benchmark for the ordered lookups of BinTree. For trees of growing size
+// it measures the time per retrieve, per key of retrieveBatch for a few
+// batch sizes, per lowerBound and floor, and the time a search that visits
+// every node would take, as findNode did before it followed the BST
+// ordering. Lookups are checked against the keys put in, and every batch
+// result against the data retrieve found for the same key.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/lookupdriver.cpp bintree.cpp treewriter.cpp
+//       supportingdocs/nodedata.cpp -o lookupdriver
+//   ./lookupdriver [largest size]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Sizes go from 1,000 up to the largest size, 1,000,000 by default, by
+//   factors of 10. Trees are plain BinTrees built from shuffled even keys,
+//   so probes of odd keys miss.
+// - retrieveBatch is timed for batches of 64, 256 and 1024 keys; the last
+//   batch of the probes is a partial one.
+// - The full-tree search is only timed up to SCAN_LIMIT nodes.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bintree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int PROBES = 100000;
+const int SCAN_LIMIT = 100000;
+const int BATCHES[] = { 64, 256, 1024 };
+
+//global function prototypes
+bool scanFor(const BinTree&, const NodeData&);    // visits every node
+
+int main(int argc, char* argv[]) {
+	int largest = (argc > 1) ? atoi(argv[1]) : 1000000;
+	bool passed = true;
+	mt19937 rng(343);
+
+	cout << "Lookup latency (ns per lookup):" << endl;
+	printf("  %10s %10s %10s %10s %10s %10s %10s %12s\n", "size", "retrieve",
+		"batch 64", "batch 256", "batch 1024", "lowerBound", "floor",
+		"full scan");
+
+	for (int size = 1000; size <= largest; size *= 10) {
+		vector<int> values(size);
+		for (int i = 0; i < size; i++) {
+			values[i] = 2 * i;
+		}
+		shuffle(values.begin(), values.end(), rng);
+
+		BinTree T;
+		for (int value : values) {
+			T.insert(new NodeData(makeKey(value)));
+		}
+
+		vector<NodeData> probes;
+		vector<int> probeValues;
+		for (int i = 0; i < PROBES; i++) {
+			probeValues.push_back(static_cast<int>(rng() % (2 * size)));
+			probes.emplace_back(makeKey(probeValues.back()));
+		}
+
+		// what retrieve finds is what every batch must find
+		vector<NodeData*> expectedData(PROBES, nullptr);
+		int hits = 0;
+		NodeData* found = nullptr;
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < PROBES; i++) {
+			bool hit = T.retrieve(probes[i], found);
+			passed &= hit == (probeValues[i] % 2 == 0);
+			if (hit) {
+				expectedData[i] = found;
+				hits++;
+			}
+		}
+		double retrieveNs = nsPer(start, PROBES);
+
+		vector<double> batchNs;
+		for (int batch : BATCHES) {
+			vector<NodeData*> results(PROBES, nullptr);
+			int batchHits = 0;
+			start = chrono::steady_clock::now();
+			for (int i = 0; i < PROBES; i += batch) {
+				batchHits += T.retrieveBatch(&probes[i], min(batch, PROBES - i),
+					&results[i]);
+			}
+			batchNs.push_back(nsPer(start, PROBES));
+			passed &= batchHits == hits && results == expectedData;
+		}
+
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < PROBES; i++) {
+			int expected = (probeValues[i] + 1) / 2 * 2;    // next even value
+			bool hit = T.lowerBound(probes[i], found);
+			passed &= hit == (expected < 2 * size);
+			passed &= !hit || found->getData() == makeKey(expected);
+		}
+		double lowerNs = nsPer(start, PROBES);
+
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < PROBES; i++) {
+			int expected = probeValues[i] / 2 * 2;          // previous even value
+			passed &= T.floor(probes[i], found)
+				&& found->getData() == makeKey(expected);
+		}
+		double floorNs = nsPer(start, PROBES);
+
+		printf("  %10d %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f ", size,
+			retrieveNs, batchNs[0], batchNs[1], batchNs[2], lowerNs, floorNs);
+
+		if (size <= SCAN_LIMIT) {
+			int scans = max(1, PROBES / size);
+			start = chrono::steady_clock::now();
+			for (int i = 0; i < scans; i++) {
+				passed &= scanFor(T, probes[i]) == (probeValues[i] % 2 == 0);
+			}
+			printf("%12.1f\n", nsPer(start, scans));
+		}
+		else {
+			printf("%12s\n", "-");
+		}
+	}
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//------------------------------- scanFor ------------------------------------
+// Looks for key by visiting every node, as the old findNode did.
+bool scanFor(const BinTree& T, const NodeData& key) {
+	bool found = false;
+	for (const NodeData& data : T) {
+		found |= data == key;
+	}
+	return found;
+}
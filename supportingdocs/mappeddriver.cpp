@@ -0,0 +1,176 @@
+// ----------------------------- mappeddriver.cpp -----------------------------
+// Benchmark and checks for MappedTree. Saves one large tree, times the
+// save, an open with and without the checksum, loadInto and, as the old
+// start-up, one insert per data into a balanced BinTree. Then checks every
+// query on the file against the same query on the tree, and checks that
+// damaged files are rejected: a decreasing offset table by open, even
+// without the checksum, and keys out of order by loadInto.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/mappeddriver.cpp mappedtree.cpp bintree.cpp
+//       treewriter.cpp supportingdocs/nodedata.cpp -o mappeddriver
+//   ./mappeddriver [nodes] [file]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - nodes defaults to 1,000,000 and file to mappeddriver.out in the
+//   current directory. The file, and a damaged copy next to it, are
+//   removed at the end.
+// - Keys are the even numbers, nine digits, so half the probes are absent
+//   and every key has the same length.
+// - The damaged copies are made from the layout in mappedtree.h: a 40 byte
+//   header, then the prefixes, the offsets and the keys.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "bintree.h"
+#include "mappedtree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int PROBES = 200000;
+const size_t HEADER_BYTES = 40;
+
+//global function prototypes
+bool writeCopy(const string& path, const vector<char>& bytes);
+
+int main(int argc, char* argv[]) {
+	int nodes = (argc > 1) ? atoi(argv[1]) : 1000000;
+	string path = (argc > 2) ? argv[2] : "mappeddriver.out";
+	string damaged = path + ".damaged";
+	bool passed = true;
+	mt19937 rng(343);
+
+	vector<int> values(nodes);
+	for (int i = 0; i < nodes; i++) {
+		values[i] = 2 * i;
+	}
+	vector<NodeData*> items;
+	for (int value : values) {
+		items.push_back(new NodeData(makeKey(value)));
+	}
+	BinTree T;
+	T.bulkLoad(items.data(), nodes);
+
+	cout << nodes << " nodes, " << path << ":" << endl;
+
+	auto start = chrono::steady_clock::now();
+	bool saved = MappedTree::save(T, path);
+	passed &= report("save", msSince(start), saved);
+
+	MappedTree M;
+	start = chrono::steady_clock::now();
+	bool opened = M.open(path, false);
+	passed &= report("open, no checksum", msSince(start),
+		opened && M.size() == nodes);
+
+	start = chrono::steady_clock::now();
+	opened = M.open(path);
+	passed &= report("open, checksum", msSince(start),
+		opened && M.size() == nodes);
+
+	BinTree loaded;
+	start = chrono::steady_clock::now();
+	int count = M.loadInto(loaded);
+	passed &= report("loadInto", msSince(start), count == nodes
+		&& loaded == T);
+
+	// the old start-up: one insert per data, in the order they were written
+	shuffle(values.begin(), values.end(), rng);
+	BinTree inserted(true);
+	start = chrono::steady_clock::now();
+	for (int value : values) {
+		inserted.insert(new NodeData(makeKey(value)));
+	}
+	// == also compares the shape, which the inserts need not match
+	passed &= report("insert per data", msSince(start), inserted.size()
+		== nodes && equal(inserted.begin(), inserted.end(), T.begin()));
+
+	// every query, on the file and on the tree, with the same probes
+	vector<NodeData> probes;
+	for (int i = 0; i < PROBES; i++) {
+		probes.emplace_back(makeKey(static_cast<int>(rng() % (2 * nodes + 2))));
+	}
+	bool same = true;
+	string_view view;
+	NodeData* found = nullptr;
+	start = chrono::steady_clock::now();
+	for (const NodeData& probe : probes) {
+		same &= M.retrieve(probe, view) == T.retrieve(probe, found);
+		bool hit = M.lowerBound(probe, view);
+		same &= hit == T.lowerBound(probe, found);
+		same &= !hit || view == found->getData();
+		same &= M.rank(probe) == T.rank(probe);
+	}
+	for (int i = 0; i < PROBES / 10; i++) {
+		int k = static_cast<int>(rng() % (nodes + 1));
+		bool hit = M.select(k, view);
+		same &= hit == T.select(k, found);
+		same &= !hit || view == found->getData();
+		NodeData low(makeKey(static_cast<int>(rng() % (2 * nodes))));
+		NodeData high(makeKey(static_cast<int>(rng() % (2 * nodes))));
+		same &= M.countRange(low, high) == T.countRange(low, high);
+	}
+	passed &= report("queries match tree", msSince(start), same);
+
+	// damaged copies of the file
+	vector<char> bytes;
+	{
+		ifstream in(path, ios::binary);
+		bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+	}
+	size_t offsetsAt = HEADER_BYTES + 8 * static_cast<size_t>(nodes);
+	size_t keysAt = offsetsAt + 8 * (static_cast<size_t>(nodes) + 1);
+
+	if (nodes >= 2) {
+		// an offset past the next one: views would run out of the key block
+		vector<char> broken = bytes;
+		uint64_t past = 0;
+		memcpy(&past, &broken[offsetsAt + 8 * nodes], 8);
+		memcpy(&broken[offsetsAt + 8 * (nodes / 2)], &past, 8);
+		passed &= writeCopy(damaged, broken);
+		MappedTree D;
+		passed &= report("bad offsets rejected", 0.0,
+			!D.open(damaged, false) && !D.open(damaged));
+
+		// the first two keys swapped: the offsets are still fine
+		broken = bytes;
+		swap_ranges(broken.begin() + keysAt, broken.begin() + keysAt + 9,
+			broken.begin() + keysAt + 9);
+		passed &= writeCopy(damaged, broken);
+		bool checked = !D.open(damaged);
+		bool unchecked = D.open(damaged, false);
+		BinTree kept;
+		kept.insert(new NodeData(makeKey(1)));
+		passed &= report("bad order rejected", 0.0, checked && unchecked
+			&& D.loadInto(kept) == -1 && kept.size() == 1);
+	}
+
+	M.close();
+	remove(path.c_str());
+	remove(damaged.c_str());
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//------------------------------- writeCopy ----------------------------------
+// Writes bytes to path, replacing it. Returns true if every byte is written.
+bool writeCopy(const string& path, const vector<char>& bytes) {
+	ofstream out(path, ios::binary | ios::trunc);
+	out.write(bytes.data(), static_cast<streamsize>(bytes.size()));
+	return static_cast<bool>(out);
+}
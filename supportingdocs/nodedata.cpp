@@ -1,46 +1,79 @@
 #include "nodedata.h"
 
 //------------------- constructors/destructor  -------------------------------
-NodeData::NodeData() { data = ""; }                         // default
+NodeData::NodeData() { data = ""; prefix = 0; }             // default
 
 NodeData::~NodeData() { }            // needed so strings are deleted properly
 
-NodeData::NodeData(const NodeData& nd) { data = nd.data; }  // copy
+NodeData::NodeData(const NodeData& nd) {                    // copy
+	data = nd.data;
+	prefix = nd.prefix;
+}
 
-NodeData::NodeData(const string& s) { data = s; }    // cast string to NodeData
+NodeData::NodeData(const string& s) { data = s; setPrefix(); }   // cast string to NodeData
 
 //------------------------- operator= ----------------------------------------
 NodeData& NodeData::operator=(const NodeData& rhs) {
 	if (this != &rhs) {
 		data = rhs.data;
+		prefix = rhs.prefix;
 	}
 	return *this;
 }
 
 //------------------------- operator==,!= ------------------------------------
 bool NodeData::operator==(const NodeData& rhs) const {
-	return data == rhs.data;
+	return prefix == rhs.prefix && data == rhs.data;
 }
 
 bool NodeData::operator!=(const NodeData& rhs) const {
-	return data != rhs.data;
+	return !(*this == rhs);
 }
 
 //------------------------ operator<,>,<=,>= ---------------------------------
 bool NodeData::operator<(const NodeData& rhs) const {
-	return data < rhs.data;
+	return compare(rhs) < 0;
 }
 
 bool NodeData::operator>(const NodeData& rhs) const {
-	return data > rhs.data;
+	return compare(rhs) > 0;
 }
 
 bool NodeData::operator<=(const NodeData& rhs) const {
-	return data <= rhs.data;
+	return compare(rhs) <= 0;
 }
 
 bool NodeData::operator>=(const NodeData& rhs) const {
-	return data >= rhs.data;
+	return compare(rhs) >= 0;
+}
+
+//------------------------------ compare -------------------------------------
+// The prefixes order the same way as the strings' first 8 bytes, so unless
+// those bytes match one integer compare decides. Otherwise the rest of the
+// strings break the tie.
+
+int NodeData::compare(const NodeData& rhs) const {
+	if (prefix != rhs.prefix) {
+		return (prefix < rhs.prefix) ? -1 : 1;
+	}
+	if (data.size() > 8 && rhs.data.size() > 8) {
+		return data.compare(8, string::npos, rhs.data, 8, string::npos);
+	}
+	return data.compare(rhs.data);
+}
+
+//----------------------------- setPrefix ------------------------------------
+// pack the first 8 bytes of data as an unsigned big-endian integer, padding
+// short strings with zero bytes
+
+void NodeData::setPrefix() {
+	prefix = 0;
+	for (size_t i = 0; i < 8; i++) {
+		prefix <<= 8;
+		if (i < data.size()) {
+			prefix |= static_cast<unsigned char>(data[i]);
+		}
+	}
 }
 
 //------------------------------ setData -------------------------------------
@@ -48,6 +81,7 @@ bool NodeData::operator>=(const NodeData& rhs) const {
 
 bool NodeData::setData(istream& infile) {
 	getline(infile, data);
+	setPrefix();
 	return !infile.eof();       // eof function is true when eof char is read
 }
 
@@ -1,8 +1,12 @@
 #ifndef NODEDATA_H
 #define NODEDATA_H
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <fstream>
+#if __cplusplus >= 202002L
+#include <compare>
+#endif
 using namespace std;
 
 // simple class containing one string to use for testing
@@ -29,8 +33,26 @@ public:
 	bool operator<=(const NodeData &) const;
 	bool operator>=(const NodeData &) const;
 
+	// three-way compare: negative, zero or positive as *this is less than,
+	// equal to or greater than the parameter; one call per tree level
+	int compare(const NodeData &) const;
+
+	// cached prefix, for indexes that search on it without touching data
+	uint64_t getPrefix() const { return prefix; }
+
+	// the string itself, for writers and indexes that store its bytes
+	const string& getData() const { return data; }
+#if __cplusplus >= 202002L
+	strong_ordering operator<=>(const NodeData &rhs) const {
+		return compare(rhs) <=> 0;
+	}
+#endif
+
 private:
-	string data;
+	string data;         // short strings are stored inline by string itself
+	uint64_t prefix;     // first 8 bytes of data, big-endian, zero padded
+
+	void setPrefix();    // recompute prefix after data changes
 };
 
 #endif
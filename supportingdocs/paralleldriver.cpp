@@ -0,0 +1,90 @@
+// ---------------------------- paralleldriver.cpp ----------------------------
+// Scaling benchmark for the parallel copy, comparison and makeEmpty of
+// BinTree. Builds one large tree, then for 1, 2, 4, ... threads, set with
+// BinTree::setParallelism, times the copy constructor, operator== and
+// makeEmpty on it, and checks each copy against the original.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/paralleldriver.cpp bintree.cpp treewriter.cpp
+//       supportingdocs/nodedata.cpp -o paralleldriver
+//   ./paralleldriver [nodes] [most threads]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - nodes defaults to 4,000,000, which needs about 1 GB for the tree and
+//   its copy. Trees below PARALLEL_CUTOFF nodes always use one thread.
+// - most threads defaults to the number of hardware threads, and is at
+//   least 1. More threads than cores still runs, and still checks the
+//   results, but cannot get faster.
+// - Each time is the best of REPEATS runs.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bintree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int REPEATS = 3;
+
+int main(int argc, char* argv[]) {
+	int nodes = (argc > 1) ? atoi(argv[1]) : 4000000;
+	int mostThreads = (argc > 2) ? atoi(argv[2])
+		: static_cast<int>(thread::hardware_concurrency());
+	mostThreads = max(mostThreads, 1);
+	bool passed = true;
+
+	vector<NodeData*> items;
+	for (int i = 0; i < nodes; i++) {
+		items.push_back(new NodeData(makeKey(i)));
+	}
+	BinTree T(true);
+	T.bulkLoad(items.data(), nodes);
+
+	cout << nodes << " nodes, best of " << REPEATS << " (ms):" << endl;
+	printf("  %8s %10s %10s %10s\n", "threads", "copy", "==", "makeEmpty");
+
+	for (int threads = 1; threads <= mostThreads; threads *= 2) {
+		BinTree::setParallelism(threads);
+		double copyMs = 1e30;
+		double equalMs = 1e30;
+		double emptyMs = 1e30;
+
+		for (int run = 0; run < REPEATS; run++) {
+			auto start = chrono::steady_clock::now();
+			BinTree copy(T);
+			copyMs = min(copyMs, msSince(start));
+
+			start = chrono::steady_clock::now();
+			passed &= copy == T;
+			equalMs = min(equalMs, msSince(start));
+			passed &= copy.size() == nodes;
+
+			start = chrono::steady_clock::now();
+			copy.makeEmpty();
+			emptyMs = min(emptyMs, msSince(start));
+			passed &= copy.isEmpty();
+		}
+
+		printf("  %8d %10.1f %10.1f %10.1f\n", threads, copyMs, equalMs,
+			emptyMs);
+	}
+
+	// a copy that differs in its last data must compare unequal
+	BinTree changed(T);
+	changed.remove(NodeData(makeKey(nodes - 1)));
+	changed.insert(new NodeData(makeKey(nodes)));
+	passed &= changed != T;
+
+	BinTree::setParallelism(0);
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
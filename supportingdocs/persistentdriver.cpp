@@ -0,0 +1,195 @@
+// --------------------------- persistentdriver.cpp ---------------------------
+// Driver and copy benchmark for PersistentBinTree. Inserts and removes
+// random keys in one tree, next to a std::set, and keeps a copy of both
+// every so often. At the end, and again after half of the copies are
+// dropped, every version kept must still hold exactly the keys of its set,
+// within the AVL height bound. Then times copying a PersistentBinTree
+// against copying a BinTree of the same data.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/persistentdriver.cpp persistentbintree.cpp
+//       bintree.cpp treewriter.cpp supportingdocs/nodedata.cpp
+//       -o persistentdriver
+//   ./persistentdriver [keys]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - keys defaults to 200,000. Keys are drawn from 0 .. 2 * keys - 1, so
+//   about half of the inserts and removes find their key already there.
+// - keys inserts fill the tree, then keys more steps insert or remove at
+//   random; a version is kept every keys / VERSIONS steps.
+// - Every kept version is checked with PROBES random retrieves, and once
+//   against a tree built from a BinTree of the same keys.
+// - Copies are timed for sizes from 1,000 up to keys by factors of 10,
+//   each copy destroyed again right away.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "bintree.h"
+#include "persistentbintree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int VERSIONS = 16;
+const int PROBES = 1000;
+const int COPY_STEPS = 2000000;
+
+//global function prototypes
+bool checkVersion(const PersistentBinTree&, const set<int>&, mt19937& rng);
+bool timeCopies(int size);                        // prints one table row
+
+int main(int argc, char* argv[]) {
+	int keys = (argc > 1) ? atoi(argv[1]) : 200000;
+	bool passed = true;
+	mt19937 rng(343);
+
+	PersistentBinTree P;
+	set<int> expected;
+	bool same = true;
+	for (int i = 0; i < keys; i++) {
+		int value = static_cast<int>(rng() % (2 * keys));
+		same &= P.insert(NodeData(makeKey(value)))
+			== expected.insert(value).second;
+	}
+
+	// every change copies a path, so each kept version must stay as it was
+	vector<PersistentBinTree> versions;
+	vector<set<int>> versionKeys;
+	int keepEvery = max(1, keys / VERSIONS);
+	auto start = chrono::steady_clock::now();
+	for (int step = 0; step < keys; step++) {
+		if (step % keepEvery == 0) {
+			versions.push_back(P);
+			versionKeys.push_back(expected);
+		}
+		int value = static_cast<int>(rng() % (2 * keys));
+		if (rng() % 2 == 0) {
+			same &= P.insert(NodeData(makeKey(value)))
+				== expected.insert(value).second;
+		}
+		else {
+			same &= P.remove(NodeData(makeKey(value)))
+				== (expected.erase(value) == 1);
+		}
+	}
+	versions.push_back(P);
+	versionKeys.push_back(expected);
+	passed &= report("insert and remove", msSince(start), same);
+
+	same = true;
+	start = chrono::steady_clock::now();
+	for (size_t i = 0; i < versions.size(); i++) {
+		same &= checkVersion(versions[i], versionKeys[i], rng);
+	}
+	passed &= report("all versions", msSince(start), same);
+
+	// dropping a version must free only what no other version shares
+	same = true;
+	start = chrono::steady_clock::now();
+	for (size_t i = 0; i < versions.size(); i += 2) {
+		versions[i].makeEmpty();
+		same &= versions[i].isEmpty() && versions[i].size() == 0;
+	}
+	for (size_t i = 1; i < versions.size(); i += 2) {
+		same &= checkVersion(versions[i], versionKeys[i], rng);
+	}
+	passed &= report("half dropped", msSince(start), same);
+
+	cout << endl << "Copy and destroy (ns per copy):" << endl;
+	printf("  %10s %14s %14s\n", "size", "BinTree", "Persistent");
+	for (int size = 1000; size <= keys; size *= 10) {
+		passed &= timeCopies(size);
+	}
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//----------------------------- checkVersion ---------------------------------
+// Returns true if P holds exactly the keys of expected, in order, answers
+// PROBES random retrieves as expected does, stays within the AVL height
+// bound of 1.44 log2(n + 2) and equals a tree built from a BinTree.
+bool checkVersion(const PersistentBinTree& P, const set<int>& expected,
+	mt19937& rng) {
+	bool ok = P.size() == static_cast<int>(expected.size());
+	auto it = expected.begin();
+	int height = 0;
+	for (const NodeData& data : P) {
+		ok &= it != expected.end() && data.getData() == makeKey(*it);
+		height = max(height, P.getHeight(data));
+		if (it != expected.end()) {
+			++it;
+		}
+	}
+	ok &= it == expected.end();
+	ok &= height <= static_cast<int>(1.4405 * log2(P.size() + 2.0));
+
+	// up to just past the largest key, so about half the probes miss
+	int limit = expected.empty() ? 1 : *expected.rbegin() + 2;
+	const NodeData* found = nullptr;
+	for (int i = 0; i < PROBES; i++) {
+		int value = static_cast<int>(rng() % limit);
+		NodeData key(makeKey(value));
+		bool hit = P.retrieve(key, found);
+		ok &= hit == (expected.count(value) == 1);
+		ok &= !hit || *found == key;
+	}
+
+	vector<NodeData*> items;
+	for (int value : expected) {
+		items.push_back(new NodeData(makeKey(value)));
+	}
+	BinTree built;
+	built.bulkLoad(items.data(), static_cast<int>(items.size()));
+	ok &= PersistentBinTree(built) == P;
+	return ok;
+}
+
+//------------------------------ timeCopies ----------------------------------
+// Copies a balanced BinTree and a PersistentBinTree of size keys, each
+// copy destroyed right away, and prints the nanoseconds per copy of each.
+// Returns true if every copy had all size data.
+bool timeCopies(int size) {
+	vector<NodeData*> items;
+	for (int i = 0; i < size; i++) {
+		items.push_back(new NodeData(makeKey(i)));
+	}
+	BinTree T(true);
+	T.bulkLoad(items.data(), size);
+	PersistentBinTree P(T);
+
+	// enough copies that each column runs for a while
+	int treeCopies = max(1, COPY_STEPS / size);
+	long long sizes = 0;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < treeCopies; i++) {
+		BinTree copy(T);
+		sizes += copy.size();
+	}
+	double treeNs = nsPer(start, treeCopies);
+
+	int persistentCopies = COPY_STEPS;
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < persistentCopies; i++) {
+		PersistentBinTree copy(P);
+		sizes += copy.size();
+	}
+	double persistentNs = nsPer(start, persistentCopies);
+
+	bool ok = sizes == static_cast<long long>(treeCopies + persistentCopies)
+		* size;
+	printf("  %10d %14.1f %14.1f  %s\n", size, treeNs, persistentNs,
+		ok ? "ok" : "FAILED");
+	return ok;
+}
@@ -0,0 +1,148 @@
+// ----------------------------- rangedriver.cpp ------------------------------
+// Benchmark and checks for the range queries of BinTree: the range view,
+// forEachInRange and countRange. For ranges of growing width over one
+// large tree it times each of them, next to a full in-order scan that
+// tests every data against the bounds, and checks that all four give the
+// same data.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/rangedriver.cpp bintree.cpp treewriter.cpp
+//       supportingdocs/nodedata.cpp -o rangedriver
+//   ./rangedriver [nodes]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - nodes defaults to 1,000,000. Keys are the even numbers, nine digits,
+//   and bounds are random numbers, so a bound is absent half the time.
+// - Widths go from 10 by factors of 100 up to the whole key range, in
+//   values, so a range holds about width / 2 data.
+// - The full scan is slow, so it is only run for SCANS ranges per width;
+//   those ranges are the ones checked. The others are timed over up to
+//   QUERIES ranges, fewer for wide ranges so that about STEPS data are
+//   visited per width.
+// - Empty ranges, with high < low or no data between the bounds, are
+//   checked once at the end.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bintree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int SCANS = 20;
+const int QUERIES = 20000;
+const long long STEPS = 20000000;
+
+int main(int argc, char* argv[]) {
+	int nodes = (argc > 1) ? atoi(argv[1]) : 1000000;
+	bool passed = true;
+	mt19937 rng(343);
+
+	vector<NodeData*> items;
+	for (int i = 0; i < nodes; i++) {
+		items.push_back(new NodeData(makeKey(2 * i)));
+	}
+	BinTree T;
+	T.bulkLoad(items.data(), nodes);
+
+	cout << nodes << " nodes, ns per query:" << endl;
+	printf("  %10s %12s %12s %12s %12s\n", "width", "full scan", "range",
+		"forEach", "countRange");
+
+	for (long long width = 10; ; width *= 100) {
+		int span = static_cast<int>(min<long long>(width, 2LL * nodes));
+		int queries = static_cast<int>(min<long long>(QUERIES,
+			max<long long>(SCANS, STEPS / span)));
+		vector<NodeData> lows;
+		vector<NodeData> highs;
+		for (int i = 0; i < queries; i++) {
+			int low = static_cast<int>(rng() % (2 * nodes - span + 1));
+			lows.emplace_back(makeKey(low));
+			highs.emplace_back(makeKey(low + span));
+		}
+
+		// the first SCANS ranges, every way, data compared one by one
+		vector<vector<const NodeData*>> expected(SCANS);
+		auto start = chrono::steady_clock::now();
+		for (int i = 0; i < SCANS; i++) {
+			for (const NodeData& data : T) {
+				if (lows[i] <= data && data <= highs[i]) {
+					expected[i].push_back(&data);
+				}
+			}
+		}
+		double scanNs = nsPer(start, SCANS);
+
+		for (int i = 0; i < SCANS; i++) {
+			vector<const NodeData*> viewed;
+			for (const NodeData& data : T.range(lows[i], highs[i])) {
+				viewed.push_back(&data);
+			}
+			vector<const NodeData*> visited;
+			T.forEachInRange(lows[i], highs[i], [&](const NodeData& data) {
+				visited.push_back(&data);
+			});
+			int count = static_cast<int>(expected[i].size());
+			passed &= viewed == expected[i] && visited == expected[i];
+			passed &= T.countRange(lows[i], highs[i]) == count;
+			passed &= T.range(lows[i], highs[i]).empty() == (count == 0);
+		}
+
+		// every query sums the lengths it sees, so no loop can be skipped
+		long long viewBytes = 0;
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < queries; i++) {
+			for (const NodeData& data : T.range(lows[i], highs[i])) {
+				viewBytes += data.getData().size();
+			}
+		}
+		double rangeNs = nsPer(start, queries);
+
+		long long visitBytes = 0;
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < queries; i++) {
+			T.forEachInRange(lows[i], highs[i], [&](const NodeData& data) {
+				visitBytes += data.getData().size();
+			});
+		}
+		double visitNs = nsPer(start, queries);
+
+		long long counted = 0;
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < queries; i++) {
+			counted += T.countRange(lows[i], highs[i]);
+		}
+		double countNs = nsPer(start, queries);
+		passed &= viewBytes == visitBytes && visitBytes == 9 * counted;
+
+		printf("  %10d %12.0f %12.1f %12.1f %12.1f\n", span, scanNs, rangeNs,
+			visitNs, countNs);
+
+		if (span == 2 * nodes) {
+			break;
+		}
+	}
+
+	// high below low, and both bounds between the same two keys
+	NodeData two(makeKey(2));
+	NodeData four(makeKey(4));
+	NodeData gap(makeKey(3));
+	int calls = 0;
+	T.forEachInRange(four, two, [&calls](const NodeData&) { calls++; });
+	T.forEachInRange(gap, gap, [&calls](const NodeData&) { calls++; });
+	passed &= calls == 0;
+	passed &= T.range(four, two).empty() && T.range(gap, gap).empty();
+	passed &= T.countRange(four, two) == 0 && T.countRange(gap, gap) == 0;
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
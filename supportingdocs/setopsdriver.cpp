@@ -0,0 +1,220 @@
+// ------------------------------ setopsdriver.cpp ----------------------------
+// Driver for the set operations of BinTree. Runs unionWith, intersectWith
+// and differenceWith on random trees and checks every result against
+// std::set_union, std::set_intersection and std::set_difference on the same
+// keys. It covers every mix of balanced and plain trees, trees of about the
+// same size and of very different sizes, sizes below and above
+// PARALLEL_CUTOFF, and trees on their own pools or sharing one.
+//
+// Besides the keys, each result must keep the right data: for a key in
+// both trees, the data of the tree operated on; for any other key, the data
+// of the tree it came from. The other tree must be left empty, and a
+// balanced result must stay within the AVL height bound.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/setopsdriver.cpp bintree.cpp treewriter.cpp
+//       supportingdocs/nodedata.cpp -o setopsdriver
+//   ./setopsdriver [large size]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - large size defaults to 200,000, above PARALLEL_CUTOFF, and sizes of
+//   SMALL_SIZE are run as well. A size is the expected number of keys in
+//   the tree operated on; keys are drawn from 0 .. 2 * size - 1.
+// - The other tree is about the same size, or a hundredth of it.
+// - Balanced trees are built with bulkLoad; plain trees by inserting their
+//   keys in random order, so they have the uneven shapes plain trees get.
+// - Times are for the operation alone, not for building the trees.
+// - setParallelism is set to WORKERS, so large inputs are split across
+//   threads even on a machine with fewer cores.
+// - Data that an operation drops is deleted by it; a leak or a double
+//   delete shows up under AddressSanitizer.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bintree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int SMALL_SIZE = 2000;
+const int WORKERS = 4;
+
+enum Operation { UNION, INTERSECTION, DIFFERENCE };
+
+//global function prototypes
+bool runCase(Operation, int size, int ratio, bool balanced,
+	bool otherBalanced, bool sharedPool, mt19937& rng, double& ms);
+vector<int> pickKeys(int range, int ratio, mt19937& rng);
+void fillTree(BinTree&, const vector<int>& keys, vector<NodeData*>& data);
+bool checkResult(const BinTree&, const vector<int>& expected,
+	const vector<NodeData*>& first, const vector<NodeData*>& second);
+
+int main(int argc, char* argv[]) {
+	int large = (argc > 1) ? atoi(argv[1]) : 200000;
+	bool passed = true;
+	mt19937 rng(343);
+	BinTree::setParallelism(WORKERS);
+
+	const char* names[] = { "union", "intersection", "difference" };
+	for (int size : { SMALL_SIZE, large }) {
+		cout << "Size " << size << ":" << endl;
+		for (Operation op : { UNION, INTERSECTION, DIFFERENCE }) {
+			for (int ratio : { 1, 100 }) {
+				for (int modes = 0; modes < 4; modes++) {
+					bool balanced = modes < 2;
+					bool otherBalanced = modes % 2 == 0;
+					for (bool shared : { false, true }) {
+						double ms = 0.0;
+						bool ok = runCase(op, size, ratio, balanced,
+							otherBalanced, shared, rng, ms);
+						passed &= ok;
+						printf("  %-12s 1:%-3d %-8s %-8s %-6s %10.3f ms  %s\n",
+							names[op], ratio, balanced ? "balanced" : "plain",
+							otherBalanced ? "balanced" : "plain",
+							shared ? "shared" : "own", ms, ok ? "ok" : "FAILED");
+					}
+				}
+			}
+		}
+	}
+
+	BinTree::setParallelism(0);
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//------------------------------- runCase ------------------------------------
+// Builds a tree of about size keys and another of about size / ratio keys,
+// the second on the first one's pool if sharedPool, applies op to them and
+// checks the result against the std algorithm for op. Sets ms to the time
+// op took. Returns true if every check passed.
+bool runCase(Operation op, int size, int ratio, bool balanced,
+	bool otherBalanced, bool sharedPool, mt19937& rng, double& ms) {
+	vector<int> firstKeys = pickKeys(2 * size, 2, rng);
+	vector<int> secondKeys = pickKeys(2 * size, 2 * ratio, rng);
+
+	vector<NodeData*> first(2 * size, nullptr);
+	vector<NodeData*> second(2 * size, nullptr);
+	BinTree T(balanced, nullptr);
+	BinTree other(otherBalanced, sharedPool ? T.getPool() : nullptr);
+	fillTree(T, firstKeys, first);
+	fillTree(other, secondKeys, second);
+	bool ok = (T.getPool() == other.getPool()) == sharedPool;
+
+	vector<int> expected;
+	auto start = chrono::steady_clock::now();
+	switch (op) {
+	case UNION:
+		T.unionWith(move(other));
+		break;
+	case INTERSECTION:
+		T.intersectWith(move(other));
+		second.assign(second.size(), nullptr);   // none of it may be kept
+		break;
+	default:
+		T.differenceWith(move(other));
+		second.assign(second.size(), nullptr);
+		break;
+	}
+	ms = msSince(start);
+
+	switch (op) {
+	case UNION:
+		set_union(firstKeys.begin(), firstKeys.end(), secondKeys.begin(),
+			secondKeys.end(), back_inserter(expected));
+		break;
+	case INTERSECTION:
+		set_intersection(firstKeys.begin(), firstKeys.end(),
+			secondKeys.begin(), secondKeys.end(), back_inserter(expected));
+		break;
+	default:
+		set_difference(firstKeys.begin(), firstKeys.end(), secondKeys.begin(),
+			secondKeys.end(), back_inserter(expected));
+		break;
+	}
+	ok &= other.isEmpty() && other.size() == 0;
+	ok &= T.isBalanced() == balanced;
+	ok &= checkResult(T, expected, first, second);
+
+	// both trees still work as trees afterwards
+	NodeData* extra = new NodeData(makeKey(2 * size));
+	ok &= T.insert(extra)
+		&& T.rank(*extra) == static_cast<int>(expected.size());
+	other.insert(new NodeData(makeKey(0)));
+	ok &= other.size() == 1;
+	return ok;
+}
+
+//------------------------------- pickKeys -----------------------------------
+// Returns, in order, each value from 0 to range - 1 with a chance of one in
+// ratio.
+vector<int> pickKeys(int range, int ratio, mt19937& rng) {
+	vector<int> keys;
+	for (int value = 0; value < range; value++) {
+		if (rng() % ratio == 0) {
+			keys.push_back(value);
+		}
+	}
+	return keys;
+}
+
+//------------------------------- fillTree -----------------------------------
+// Fills T with a new data for each of the sorted keys, by bulkLoad if T is
+// balanced and by inserts in random order if not, and records the data of
+// each key in data, indexed by key.
+void fillTree(BinTree& T, const vector<int>& keys, vector<NodeData*>& data) {
+	vector<NodeData*> items;
+	for (int value : keys) {
+		data[value] = new NodeData(makeKey(value));
+		items.push_back(data[value]);
+	}
+	if (T.isBalanced()) {
+		T.bulkLoad(items.data(), static_cast<int>(items.size()));
+		return;
+	}
+	shuffle(items.begin(), items.end(), mt19937(static_cast<unsigned>(
+		items.size())));
+	for (NodeData* item : items) {
+		T.insert(item);
+	}
+}
+
+//------------------------------ checkResult ---------------------------------
+// Returns true if T holds exactly the keys of expected, in order, each key
+// with its data from first if first has it and otherwise from second, every
+// data has the rank of its position, and a balanced T is within the AVL
+// height bound of 1.44 log2(n + 2).
+bool checkResult(const BinTree& T, const vector<int>& expected,
+	const vector<NodeData*>& first, const vector<NodeData*>& second) {
+	bool ok = T.size() == static_cast<int>(expected.size());
+	size_t position = 0;
+	int height = 0;
+	for (const NodeData& data : T) {
+		if (position >= expected.size()) {
+			return false;
+		}
+		int value = expected[position];
+		const NodeData* owner = first[value] != nullptr ? first[value]
+			: second[value];
+		ok &= &data == owner;
+		ok &= T.rank(data) == static_cast<int>(position);
+		height = max(height, T.getHeight(data));
+		position++;
+	}
+	ok &= position == expected.size();
+	ok &= !T.isBalanced()
+		|| height <= static_cast<int>(1.4405 * log2(T.size() + 2.0));
+	return ok;
+}
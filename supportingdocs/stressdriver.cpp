@@ -0,0 +1,121 @@
+// ---------------------------- stressdriver.cpp ------------------------------
+// Stress driver for the explicit-stack walks of BinTree. Builds a plain
+// BinTree shaped like a linked list, one node per level, and runs the copy
+// constructor, operator=, ==, <<, getHeight and makeEmpty on it. Each of
+// these used to recurse once per level and overflowed the call stack on
+// degenerate trees of a few hundred thousand nodes.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/stressdriver.cpp bintree.cpp treewriter.cpp
+//       supportingdocs/nodedata.cpp -o stressdriver
+//   ./stressdriver [nodes]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - nodes defaults to 10,000,000, which needs about 2 GB for the tree and
+//   its copy.
+// - Inserting sorted keys one by one would take O(n^2) to build the list.
+//   Instead each key is appended with splitOff and joinWith, which cost O(1)
+//   on a plain tree whose largest key is at the root, and leave the same
+//   degenerate shape: every node hangs off the left of the one above it.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include "bintree.h"
+#include "driverutil.h"
+
+using namespace std;
+
+// <summary>
+// Stream buffer that counts the characters written to it and drops them.
+// </summary>
+class CountingBuffer : public streambuf {
+public:
+	long long count = 0;
+
+protected:
+	int_type overflow(int_type c) override {
+		count++;
+		return traits_type::not_eof(c);
+	}
+
+	streamsize xsputn(const char*, streamsize n) override {
+		count += n;
+		return n;
+	}
+};
+
+//global function prototypes
+void buildList(BinTree&, int nodes);               // degenerate tree
+
+int main(int argc, char* argv[]) {
+	int nodes = (argc > 1) ? atoi(argv[1]) : 10000000;
+	bool passed = true;
+	auto start = chrono::steady_clock::now();
+
+	BinTree T;
+	buildList(T, nodes);
+	NodeData top(makeKey(nodes - 1));
+	NodeData bottom(makeKey(0));
+	passed &= report("build", msSince(start), T.size() == nodes);
+
+	start = chrono::steady_clock::now();
+	bool heights = T.getHeight(top) == nodes && T.getHeight(bottom) == 1;
+	passed &= report("getHeight", msSince(start), heights);
+
+	start = chrono::steady_clock::now();
+	BinTree copy(T);
+	passed &= report("copy constructor", msSince(start), copy.size() == nodes);
+
+	start = chrono::steady_clock::now();
+	passed &= report("operator==", msSince(start), copy == T);
+
+	start = chrono::steady_clock::now();
+	BinTree assigned;
+	assigned = copy;
+	passed &= report("operator=", msSince(start), assigned.size() == nodes);
+
+	start = chrono::steady_clock::now();
+	copy.makeEmpty();
+	passed &= report("makeEmpty", msSince(start), copy.isEmpty());
+
+	start = chrono::steady_clock::now();
+	passed &= report("operator!=", msSince(start), copy != T);
+
+	start = chrono::steady_clock::now();
+	CountingBuffer counter;
+	ostream sink(&counter);
+	sink << T;
+	// each key is 9 digits and a space, then one endl
+	passed &= report("operator<<", msSince(start),
+		counter.count == 10LL * nodes + 1);
+
+	start = chrono::steady_clock::now();
+	T.makeEmpty();
+	assigned.makeEmpty();
+	passed &= report("makeEmpty", msSince(start),
+		T.isEmpty() && assigned.isEmpty());
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//------------------------------ buildList -----------------------------------
+// Appends keys 0 .. nodes - 1 to the plain tree T. splitOff hands next a
+// share of T's pool, so joinWith takes next's node back without moving it
+// and hangs the old tree off the left of the new root.
+void buildList(BinTree& T, int nodes) {
+	BinTree next;
+	for (int i = 0; i < nodes; i++) {
+		NodeData key(makeKey(i));
+		T.splitOff(key, next);                 // empty: every key is smaller
+		next.insert(new NodeData(key));
+		T.joinWith(move(next));
+	}
+}
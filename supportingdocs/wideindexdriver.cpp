@@ -0,0 +1,131 @@
+// --------------------------- wideindexdriver.cpp ----------------------------
+// Microbenchmark suite for WideIndex. For key counts from 1K to 16M it
+// times retrieve with each search kernel forced in turn, lowerBound and
+// rank with the kernel picked at runtime, and, as baselines, std::lower_bound
+// over the sorted keys and retrieve on a balanced BasicBinTree<int64_t>.
+// Every answer is checked against std::lower_bound.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -I. -Isupportingdocs
+//       supportingdocs/wideindexdriver.cpp wideindex.cpp -o wideindexdriver
+//   ./wideindexdriver [largest power of two]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Key counts are 2^10, 2^12, ... up to 2^largest, 2^24 by default.
+// - The BasicBinTree baseline is only built up to TREE_LIMIT keys.
+// - A kernel the CPU lacks falls back to SCALAR; its column then repeats
+//   the scalar time and is marked with a *.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "basicbintree.h"
+#include "wideindex.h"
+#include "driverutil.h"
+
+using namespace std;
+
+const int PROBES = 1 << 20;
+const int TREE_LIMIT = 1 << 22;
+
+int main(int argc, char* argv[]) {
+	int largest = (argc > 1) ? atoi(argv[1]) : 24;
+	bool passed = true;
+	mt19937_64 rng(343);
+	const WideIndex::Kernel kernels[] = { WideIndex::SCALAR, WideIndex::SSE42,
+		WideIndex::AVX2 };
+
+	cout << "ns per lookup:" << endl;
+	printf("  %9s %8s %8s %8s %8s %8s %8s %8s\n", "keys", "binary", "tree",
+		"scalar", "sse4.2", "avx2", "lower", "rank");
+
+	for (int power = 10; power <= largest; power += 2) {
+		int size = 1 << power;
+		vector<int64_t> keys(size);
+		for (int i = 0; i < size; i++) {
+			keys[i] = 4 * static_cast<int64_t>(i) + static_cast<int>(rng() % 4);
+		}
+
+		vector<int64_t> probes(PROBES);
+		vector<int> expected(PROBES);
+		for (int i = 0; i < PROBES; i++) {
+			probes[i] = static_cast<int64_t>(rng() % (4 * uint64_t(size)));
+			expected[i] = static_cast<int>(lower_bound(keys.begin(),
+				keys.end(), probes[i]) - keys.begin());
+		}
+
+		// every timed loop counts its hits, so no loop can be skipped
+		int hits = 0;
+		auto start = chrono::steady_clock::now();
+		for (int64_t probe : probes) {
+			hits += binary_search(keys.begin(), keys.end(), probe);
+		}
+		double binaryNs = nsPer(start, PROBES);
+
+		printf("  %9d %8.1f ", size, binaryNs);
+
+		if (size <= TREE_LIMIT) {
+			BasicBinTree<int64_t> tree(true);
+			for (int64_t key : keys) {
+				tree.insert(key);
+			}
+			int treeHits = 0;
+			const int64_t* found = nullptr;
+			start = chrono::steady_clock::now();
+			for (int64_t probe : probes) {
+				treeHits += tree.retrieve(probe, found);
+			}
+			printf("%8.1f ", nsPer(start, PROBES));
+			passed &= treeHits == hits;
+		}
+		else {
+			printf("%8s ", "-");
+		}
+
+		for (WideIndex::Kernel kernel : kernels) {
+			WideIndex index(keys.begin(), keys.end(), kernel);
+			int indexHits = 0;
+			start = chrono::steady_clock::now();
+			for (int64_t probe : probes) {
+				indexHits += index.retrieve(probe);
+			}
+			double ns = nsPer(start, PROBES);
+			passed &= indexHits == hits;
+			printf("%7.1f%c ", ns, index.getKernel() == kernel ? ' ' : '*');
+		}
+
+		WideIndex index(keys.begin(), keys.end());
+		int64_t found = 0;
+		long long sum = 0;
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < PROBES; i++) {
+			bool hit = index.lowerBound(probes[i], found);
+			passed &= hit == (expected[i] < size);
+			passed &= !hit || found == keys[expected[i]];
+		}
+		double lowerNs = nsPer(start, PROBES);
+
+		start = chrono::steady_clock::now();
+		for (int64_t probe : probes) {
+			sum += index.rank(probe);
+		}
+		double rankNs = nsPer(start, PROBES);
+		long long expectedSum = 0;
+		for (int position : expected) {
+			expectedSum += position;
+		}
+		passed &= sum == expectedSum;
+
+		printf("%8.1f %8.1f\n", lowerNs, rankNs);
+	}
+
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+// ----------------------------- writerdriver.cpp -----------------------------
+// Benchmark for TreeWriter. Dumps one large tree to a file in each format
+// and times it, next to the way the old operator<< and displaySideways
+// wrote: one stream insertion per data, and for sideways one endl, and so
+// one flush, per line. The in-order and sideways output is checked byte for
+// byte against the old way; JSON and CSV are checked for their size.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. -Isupportingdocs
+//       supportingdocs/writerdriver.cpp treewriter.cpp bintree.cpp
+//       supportingdocs/nodedata.cpp -o writerdriver
+//   ./writerdriver [nodes] [file]
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - nodes defaults to 10,000,000 and file to writerdriver.out in the
+//   current directory. The file is overwritten by each step and removed at
+//   the end. Sideways output is the largest, about 1 GB for 10M nodes.
+// - Keys are nine digits, so the expected size of each format is known.
+// - The tree is built with bulkLoad, so the depth of every data, which the
+//   old sideways layout needs, is known without walking the nodes.
+// - Files are compared through their size and a 64-bit FNV-1a hash.
+// - Exits with 1 if a check fails, 0 otherwise.
+// ----------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bintree.h"
+#include "treewriter.h"
+#include "driverutil.h"
+
+using namespace std;
+
+typedef pair<long long, uint64_t> Digest;         // file size and hash
+
+//global function prototypes
+vector<int> bulkLoadDepths(int nodes);             // depth of each position
+Digest digestFile(const string& path);
+double timeWriter(const BinTree&, TreeWriter::Format, const string& path);
+
+int main(int argc, char* argv[]) {
+	int nodes = (argc > 1) ? atoi(argv[1]) : 10000000;
+	string path = (argc > 2) ? argv[2] : "writerdriver.out";
+	long long n = nodes;
+	bool passed = true;
+
+	vector<NodeData*> items;
+	for (int i = 0; i < nodes; i++) {
+		items.push_back(new NodeData(makeKey(i)));
+	}
+	BinTree T;
+	T.bulkLoad(items.data(), nodes);
+
+	cout << "Writing " << nodes << " nodes to " << path << ":" << endl;
+
+	// the old operator<<: one insertion per data
+	auto start = chrono::steady_clock::now();
+	{
+		ofstream out(path);
+		for (const NodeData& data : T) {
+			out << data << " ";
+		}
+		out << endl;
+	}
+	double ms = msSince(start);
+	Digest expected = digestFile(path);
+	passed &= report("per-data <<", ms, expected.first == 10 * n + 1);
+
+	ms = timeWriter(T, TreeWriter::IN_ORDER, path);
+	passed &= report("TreeWriter in-order", ms, digestFile(path) == expected);
+
+	start = chrono::steady_clock::now();
+	{
+		ofstream out(path);
+		out << T;
+	}
+	ms = msSince(start);
+	passed &= report("operator<<", ms, digestFile(path) == expected);
+
+	// the old displaySideways: largest data first, 4 spaces per level
+	// counting the root as level 1 plus 4 more, and an endl per line
+	vector<int> depths = bulkLoadDepths(nodes);
+	start = chrono::steady_clock::now();
+	{
+		ofstream out(path);
+		int position = nodes;
+		for (auto it = T.rbegin(); it != T.rend(); ++it) {
+			out << string(4 * (depths[--position] + 2), ' ') << *it << endl;
+		}
+	}
+	ms = msSince(start);
+	expected = digestFile(path);
+	passed &= report("per-line endl", ms, true);
+
+	ms = timeWriter(T, TreeWriter::SIDEWAYS, path);
+	passed &= report("TreeWriter sideways", ms, digestFile(path) == expected);
+
+	ms = timeWriter(T, TreeWriter::JSON, path);
+	passed &= report("TreeWriter JSON", ms,
+		digestFile(path).first == 12 * n + 2);
+
+	ms = timeWriter(T, TreeWriter::CSV, path);
+	passed &= report("TreeWriter CSV", ms, digestFile(path).first == 10 * n);
+
+	remove(path.c_str());
+	cout << endl << (passed ? "All checks passed." : "Checks FAILED.") << endl;
+	return passed ? 0 : 1;
+}
+
+//---------------------------- bulkLoadDepths --------------------------------
+// Returns the depth, 0 at the root, of each sorted position in a tree that
+// bulkLoad built from nodes data: each range is rooted at its middle.
+vector<int> bulkLoadDepths(int nodes) {
+	vector<int> depths(nodes);
+	vector<pair<pair<int, int>, int>> stack;          // (low, high), depth
+	stack.push_back({ { 0, nodes - 1 }, 0 });
+	while (!stack.empty()) {
+		int low = stack.back().first.first;
+		int high = stack.back().first.second;
+		int depth = stack.back().second;
+		stack.pop_back();
+		if (low > high) {
+			continue;
+		}
+		int middle = low + (high - low) / 2;
+		depths[middle] = depth;
+		stack.push_back({ { low, middle - 1 }, depth + 1 });
+		stack.push_back({ { middle + 1, high }, depth + 1 });
+	}
+	return depths;
+}
+
+//------------------------------ digestFile ----------------------------------
+// Returns the size of the file at path and a 64-bit FNV-1a hash of it.
+Digest digestFile(const string& path) {
+	ifstream in(path, ios::binary);
+	vector<char> block(1 << 20);
+	Digest digest(0, 14695981039346656037ull);
+	while (in.read(block.data(), block.size()) || in.gcount() > 0) {
+		for (streamsize i = 0; i < in.gcount(); i++) {
+			digest.second = (digest.second ^ static_cast<unsigned char>(block[i]))
+				* 1099511628211ull;
+		}
+		digest.first += in.gcount();
+	}
+	return digest;
+}
+
+//------------------------------ timeWriter ----------------------------------
+// Returns the milliseconds taken to write T to path in format, file closed.
+double timeWriter(const BinTree& T, TreeWriter::Format format,
+		const string& path) {
+	auto start = chrono::steady_clock::now();
+	{
+		ofstream out(path);
+		TreeWriter writer(out, format);
+		writer.write(T);
+	}
+	return msSince(start);
+}
@@ -0,0 +1,541 @@
+// ------------------------------ treeloader.cpp ------------------------------
+// Implementation file for the TreeLoader class. Builds one BinTree per
+// "$$"-terminated record of whitespace-separated text.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - The SSE2 scan is only built where the compiler targets SSE2, which
+//   every x86-64 compiler does; elsewhere the bytes are tested one at a
+//   time.
+// - mmap is used on POSIX systems; elsewhere the file is read into memory.
+// ----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include "treeloader.h"
+
+#if defined(__SSE2__)
+#define TREELOADER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TREELOADER_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+////////////////////////// Load File //////////////////////
+// <summary>
+// Replaces the contents of trees with one tree per record of the file at
+// path. The file is mapped and read in place.
+// </summary>
+// <returns>
+// Returns the number of trees built, or -1 if the file could not be read.
+// </returns>
+int TreeLoader::loadFile(const string &path, vector<BinTree> &trees,
+	bool balanced, int workers)
+{
+#ifdef TREELOADER_MMAP
+	int descriptor = open(path.c_str(), O_RDONLY);
+
+	if (descriptor < 0)
+	{
+		return -1;
+	}
+
+	struct stat info;
+
+	if (fstat(descriptor, &info) != 0)
+	{
+		close(descriptor);
+		return -1;
+	}
+
+	size_t length = static_cast<size_t>(info.st_size);
+
+	if (length == 0)
+	{
+		close(descriptor);
+		return loadText("", 0, trees, balanced, workers);
+	}
+
+	void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor,
+		0);
+	close(descriptor);
+
+	if (address == MAP_FAILED)
+	{
+		return -1;
+	}
+
+	madvise(address, length, MADV_SEQUENTIAL);
+
+	int built = loadText(static_cast<const char*>(address), length, trees,
+		balanced, workers);
+
+	munmap(address, length);
+	return built;
+#else
+	ifstream infile(path, ios::binary);
+
+	if (!infile)
+	{
+		return -1;
+	}
+
+	string text((istreambuf_iterator<char>(infile)),
+		istreambuf_iterator<char>());
+
+	return loadText(text.data(), text.size(), trees, balanced, workers);
+#endif
+}
+
+////////////////////////// Load Text //////////////////////
+// <summary>
+// Replaces the contents of trees with one tree per record of the length
+// bytes at text. The text is cut at whitespace into one chunk per worker,
+// the chunks are scanned in parallel, and their tokens are gathered in
+// order so each record is one contiguous run.
+// </summary>
+// <returns>
+// Returns the number of trees built.
+// </returns>
+int TreeLoader::loadText(const char* text, size_t length,
+	vector<BinTree> &trees, bool balanced, int workers)
+{
+	if (workers <= 0)
+	{
+		unsigned int threads = thread::hardware_concurrency();
+		workers = (threads > 1) ? static_cast<int>(threads) : 1;
+	}
+	if (length < PARALLEL_BYTES)
+	{
+		workers = 1;
+	}
+
+	const char* end = text + length;
+	vector<const char*> cuts(workers + 1);
+
+	cuts[0] = text;
+	cuts[workers] = end;
+	for (int i = 1; i < workers; i++)
+	{
+		const char* cut = max(text + length / workers * i, cuts[i - 1]);
+
+		if (cut > text && !isSpace(cut[-1]))
+		{
+			cut = findSpace(cut, end);		// do not cut a token in two
+		}
+		cuts[i] = cut;
+	}
+
+	vector<Chunk> chunks(workers);
+
+	runParallel(workers, workers, [&](int i)
+	{
+		scanChunk(cuts[i], cuts[i + 1], chunks[i]);
+	});
+
+	size_t total = 0;
+
+	for (const Chunk &chunk : chunks)
+	{
+		total += chunk.tokens.size();
+	}
+
+	vector<Token> tokens;
+	vector<size_t> ends;
+
+	if (workers == 1)
+	{
+		tokens.swap(chunks[0].tokens);
+		ends.swap(chunks[0].ends);
+	}
+
+	tokens.reserve(total);
+	for (Chunk &chunk : chunks)
+	{
+		for (size_t stop : chunk.ends)
+		{
+			ends.push_back(tokens.size() + stop);
+		}
+
+		tokens.insert(tokens.end(), chunk.tokens.begin(), chunk.tokens.end());
+		vector<Token>().swap(chunk.tokens);
+	}
+
+	if (tokens.size() > (ends.empty() ? 0 : ends.back()))
+	{
+		ends.push_back(tokens.size());	// last record has no "$$"
+	}
+
+	int records = static_cast<int>(ends.size());
+	vector<int> small;
+
+	trees.clear();
+	trees.reserve(records);
+	for (int i = 0; i < records; i++)
+	{
+		trees.emplace_back(balanced);
+	}
+
+	for (int i = 0; i < records; i++)
+	{
+		size_t first = (i == 0) ? 0 : ends[i - 1];
+
+		if (workers > 1 && ends[i] - first >= PARALLEL_TOKENS)
+		{
+			buildRecord(tokens.data() + first, tokens.data() + ends[i], trees[i],
+				workers);
+		}
+		else
+		{
+			small.push_back(i);
+		}
+	}
+
+	runParallel(static_cast<int>(small.size()), workers, [&](int i)
+	{
+		int record = small[i];
+		size_t first = (record == 0) ? 0 : ends[record - 1];
+
+		buildRecord(tokens.data() + first, tokens.data() + ends[record],
+			trees[record], 1);
+	});
+
+	return records;
+}
+
+////////////////////// Scan Chunk /////////////////////////
+// <summary>
+// Helper function that finds the tokens in [begin, end) and where records
+// end among them. Works 64 bytes at a time: with one bit per byte telling
+// whitespace, a token starts at each text byte after whitespace and ends
+// at each whitespace byte after text, so both are found with shifts and
+// walked with one count of trailing zeros each. The last partial block is
+// padded with spaces.
+// </summary>
+void TreeLoader::scanChunk(const char* begin, const char* end, Chunk &chunk)
+{
+	const char* start = nullptr;
+	uint64_t carry = 1;						// begin follows whitespace or nothing
+
+	chunk.tokens.reserve(static_cast<size_t>(end - begin) / 8);
+
+	for (const char* block = begin; block < end; block += BLOCK)
+	{
+		uint64_t space;
+
+		if (end - block >= BLOCK)
+		{
+			space = spaceBits(block);
+		}
+		else
+		{
+			char padded[BLOCK];
+
+			memset(padded, ' ', BLOCK);
+			memcpy(padded, block, static_cast<size_t>(end - block));
+			space = spaceBits(padded);
+		}
+
+		uint64_t previous = (space << 1) | carry;
+		uint64_t starts = ~space & previous;
+		uint64_t edges = starts | (space & ~previous);
+
+		carry = space >> 63;
+
+		while (edges != 0)
+		{
+			int bit = lowestBit(edges);
+			const char* position = block + bit;
+
+			if ((starts >> bit) & 1)
+			{
+				start = position;
+			}
+			else
+			{
+				addToken(start, position, end, chunk);
+			}
+
+			edges &= edges - 1;
+		}
+	}
+
+	if (carry == 0)
+	{
+		addToken(start, end, end, chunk);	// chunk ends inside a token
+	}
+}
+
+/////////////////////// Add Token /////////////////////////
+// <summary>
+// Helper function that records the token [text, stop) in chunk, or the end
+// of a record if the token is "$$". The prefix is read as one 8-byte load
+// when those bytes lie before limit.
+// </summary>
+void TreeLoader::addToken(const char* text, const char* stop,
+	const char* limit, Chunk &chunk)
+{
+	size_t length = static_cast<size_t>(stop - text);
+
+	if (length == 2 && text[0] == '$' && text[1] == '$')
+	{
+		chunk.ends.push_back(chunk.tokens.size());
+		return;
+	}
+
+	uint64_t prefix;
+
+	if (limit - text >= 8)
+	{
+		memcpy(&prefix, text, sizeof(prefix));
+		prefix = toBigEndian(prefix);
+		if (length < 8)
+		{
+			prefix &= ~(~0ull >> (8 * length));
+		}
+	}
+	else
+	{
+		prefix = prefixOf(text, length);
+	}
+
+	chunk.tokens.push_back({ prefix, text, length });
+}
+
+/////////////////////// Space Bits ////////////////////////
+// <summary>
+// Tests 64 bytes for whitespace. With SSE2 this takes 16 bytes per step:
+// a space, or a byte from tab to carriage return, found as the bytes that
+// stay at most 4 once tab is subtracted.
+// </summary>
+// <returns>
+// Returns a mask with bit i set if block[i] is whitespace.
+// </returns>
+uint64_t TreeLoader::spaceBits(const char* block)
+{
+	uint64_t bits = 0;
+
+#ifdef TREELOADER_SSE2
+	for (int i = 0; i < BLOCK; i += 16)
+	{
+		__m128i bytes = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(block + i));
+		__m128i space = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+		__m128i offset = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+		__m128i control = _mm_cmpeq_epi8(
+			_mm_min_epu8(offset, _mm_set1_epi8(4)), offset);
+		uint64_t mask = static_cast<unsigned>(
+			_mm_movemask_epi8(_mm_or_si128(space, control)));
+
+		bits |= mask << i;
+	}
+#else
+	for (int i = 0; i < BLOCK; i++)
+	{
+		bits |= static_cast<uint64_t>(isSpace(block[i])) << i;
+	}
+#endif
+
+	return bits;
+}
+
+////////////////////// Find Space /////////////////////////
+// <summary>
+// Returns the first whitespace byte at or after text, end if there is
+// none.
+// </summary>
+const char* TreeLoader::findSpace(const char* text, const char* end)
+{
+	while (text < end && !isSpace(*text))
+	{
+		text++;
+	}
+
+	return text;
+}
+
+/////////////////////// Is Space //////////////////////////
+// <summary>
+// Returns true if c is whitespace, false otherwise.
+// </summary>
+bool TreeLoader::isSpace(char c)
+{
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/////////////////////// Prefix Of /////////////////////////
+// <summary>
+// Returns the first 8 bytes of text as NodeData caches them: big-endian
+// and zero padded.
+// </summary>
+uint64_t TreeLoader::prefixOf(const char* text, size_t length)
+{
+	uint64_t prefix = 0;
+
+	for (size_t i = 0; i < 8; i++)
+	{
+		prefix <<= 8;
+		if (i < length)
+		{
+			prefix |= static_cast<unsigned char>(text[i]);
+		}
+	}
+
+	return prefix;
+}
+
+///////////////////// To Big Endian /////////////////////
+// <summary>
+// Returns the 8 bytes of value, as they lie in memory, read as a
+// big-endian integer. Compilers turn this into a single byte swap where
+// one is needed.
+// </summary>
+uint64_t TreeLoader::toBigEndian(uint64_t value)
+{
+	unsigned char bytes[sizeof(value)];
+	uint64_t result = 0;
+
+	memcpy(bytes, &value, sizeof(value));
+	for (size_t i = 0; i < sizeof(value); i++)
+	{
+		result = (result << 8) | bytes[i];
+	}
+
+	return result;
+}
+
+////////////////////// Lowest Bit /////////////////////////
+// <summary>
+// Returns the index of the lowest set bit of bits, which must not be 0.
+// </summary>
+int TreeLoader::lowestBit(uint64_t bits)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(bits);
+#else
+	int bit = 0;
+
+	while ((bits & 1) == 0)
+	{
+		bits >>= 1;
+		bit++;
+	}
+
+	return bit;
+#endif
+}
+
+/////////////////////// Less Than /////////////////////////
+// <summary>
+// Orders tokens the same way NodeData::compare orders their data: by the
+// prefix, then by all of the bytes.
+// </summary>
+bool TreeLoader::lessThan(const Token &left, const Token &right)
+{
+	if (left.prefix != right.prefix)
+	{
+		return left.prefix < right.prefix;
+	}
+
+	return string_view(left.text, left.length)
+		< string_view(right.text, right.length);
+}
+
+/////////////////////// Same Text /////////////////////////
+// <summary>
+// Returns true if both tokens hold the same bytes, false otherwise.
+// </summary>
+bool TreeLoader::sameText(const Token &left, const Token &right)
+{
+	return left.prefix == right.prefix
+		&& string_view(left.text, left.length)
+		== string_view(right.text, right.length);
+}
+
+////////////////////// Sort Tokens ////////////////////////
+// <summary>
+// Helper function that sorts [first, last) using workers threads: each
+// sorts one slice, then neighbouring slices are merged in rounds, each
+// round halving the number of sorted runs.
+// </summary>
+void TreeLoader::sortTokens(Token* first, Token* last, int workers)
+{
+	size_t count = static_cast<size_t>(last - first);
+
+	if (workers <= 1 || count < PARALLEL_TOKENS)
+	{
+		sort(first, last, lessThan);
+		return;
+	}
+
+	vector<Token*> bounds(workers + 1);
+
+	for (int i = 0; i < workers; i++)
+	{
+		bounds[i] = first + count / workers * i;
+	}
+	bounds[workers] = last;
+
+	runParallel(workers, workers, [&](int i)
+	{
+		sort(bounds[i], bounds[i + 1], lessThan);
+	});
+
+	for (int width = 1; width < workers; width *= 2)
+	{
+		int merges = (workers + 2 * width - 1) / (2 * width);
+
+		runParallel(merges, workers, [&](int i)
+		{
+			int low = i * 2 * width;
+			int middle = min(low + width, workers);
+			int high = min(low + 2 * width, workers);
+
+			if (middle < high)
+			{
+				inplace_merge(bounds[low], bounds[middle], bounds[high], lessThan);
+			}
+		});
+	}
+}
+
+////////////////////// Build Record ///////////////////////
+// <summary>
+// Helper function that sorts the tokens of one record, drops repeats and
+// bulk loads tree with them. The data is created by workers threads, in
+// slices of about 8 per worker.
+// </summary>
+void TreeLoader::buildRecord(Token* first, Token* last, BinTree &tree,
+	int workers)
+{
+	sortTokens(first, last, workers);
+	last = unique(first, last, sameText);
+
+	int count = static_cast<int>(last - first);
+	vector<NodeData*> items(count);
+	int slices = (workers > 1) ? workers * 8 : 1;
+
+	runParallel(slices, workers, [&](int slice)
+	{
+		int low = static_cast<int>(static_cast<long long>(count) * slice / slices);
+		int high = static_cast<int>(
+			static_cast<long long>(count) * (slice + 1) / slices);
+
+		for (int i = low; i < high; i++)
+		{
+			items[i] = new NodeData(string(first[i].text, first[i].length));
+		}
+	});
+
+	tree.bulkLoad(items.data(), count);
+}
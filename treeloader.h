@@ -0,0 +1,222 @@
+// ------------------------------ treeloader.h --------------------------------
+// Header file for the TreeLoader class. TreeLoader builds BinTrees from text
+// in the format of supportingdocs/data2.txt: whitespace-separated tokens,
+// each record of tokens ended by "$$", one tree per record. It does the
+// same job as the buildTree loop of the lab driver, without one stream
+// extraction, allocation and insert per token.
+//
+// The text is read whole (memory-mapped where possible) and cut into one
+// chunk per worker at whitespace. Workers find the tokens of their chunks
+// in parallel, 64 bytes at a time, testing 16 bytes per instruction where
+// SSE2 is available. The tokens of each record are then sorted by the same
+// order as NodeData, repeats are dropped, and the tree is linked at once
+// with BinTree::bulkLoad. Small records are built in parallel with each
+// other; a large record is sorted by all workers together.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Whitespace is what operator>> skips in the "C" locale: space, tab,
+//   newline, vertical tab, form feed and carriage return.
+// - Tokens after the last "$$" form one more record; input that ends with
+//   "$$" and whitespace gives no empty tree after it.
+// - Each record keeps one copy of each distinct token, as buildTree does by
+//   deleting the data that insert rejects.
+// ----------------------------------------------------------------------------
+
+#ifndef TREELOADER_H
+#define TREELOADER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bintree.h"
+#include "nodedata.h"
+
+using namespace std;
+
+class TreeLoader
+{
+public:
+	////////////////////////// Load File //////////////////////
+	// <summary>
+	// Replaces the contents of trees with one tree per record of the file at
+	// path.
+	// </summary>
+	// <parameter = "balanced">
+	// Passed to the constructor of every tree, so later inserts keep them
+	// AVL-balanced. They start out height-balanced either way.
+	// </parameter>
+	// <parameter = "workers">
+	// Threads to use, or 0 for one per hardware thread. Input smaller than
+	// PARALLEL_BYTES always uses one.
+	// </parameter>
+	// <returns>
+	// Returns the number of trees built, or -1 if the file could not be read,
+	// in which case trees is left unchanged.
+	// </returns>
+	static int loadFile(const string &path, vector<BinTree> &trees,
+		bool balanced = false, int workers = 0);
+
+	////////////////////////// Load Text //////////////////////
+	// <summary>
+	// Replaces the contents of trees with one tree per record of the length
+	// bytes at text. Same rules as loadFile.
+	// </summary>
+	// <returns>
+	// Returns the number of trees built.
+	// </returns>
+	static int loadText(const char* text, size_t length, vector<BinTree> &trees,
+		bool balanced = false, int workers = 0);
+
+	static const size_t PARALLEL_BYTES = 1 << 20;	// input before work is split
+
+private:
+	// <summary>
+	// A token in the input, with the prefix NodeData would cache for it.
+	// </summary>
+	struct Token
+	{
+		uint64_t prefix;
+		const char* text;
+		size_t length;
+	};
+
+	// <summary>
+	// The tokens one worker found, and the number of them that came before
+	// each "$$" it found.
+	// </summary>
+	struct Chunk
+	{
+		vector<Token> tokens;
+		vector<size_t> ends;
+	};
+
+	static const size_t PARALLEL_TOKENS = 1 << 16;	// record size sorted by all
+	static const int BLOCK = 64;			// bytes scanned per step
+
+	////////////////////// Scan Chunk /////////////////////////
+	// <summary>
+	// Helper function that finds the tokens in [begin, end) and where records
+	// end among them.
+	// </summary>
+	static void scanChunk(const char* begin, const char* end, Chunk &chunk);
+
+	/////////////////////// Add Token /////////////////////////
+	// <summary>
+	// Helper function that records the token [text, stop) in chunk, or the end
+	// of a record if the token is "$$". Bytes up to limit may be read.
+	// </summary>
+	static void addToken(const char* text, const char* stop,
+		const char* limit, Chunk &chunk);
+
+	/////////////////////// Space Bits ////////////////////////
+	// <summary>
+	// Returns a mask with bit i set if block[i] is whitespace, for the BLOCK
+	// bytes at block.
+	// </summary>
+	static uint64_t spaceBits(const char* block);
+
+	////////////////////// Find Space /////////////////////////
+	// <summary>
+	// Returns the first whitespace byte at or after text, end if there is
+	// none.
+	// </summary>
+	static const char* findSpace(const char* text, const char* end);
+
+	/////////////////////// Is Space //////////////////////////
+	// <summary>
+	// Returns true if c is whitespace, false otherwise.
+	// </summary>
+	static bool isSpace(char c);
+
+	/////////////////////// Prefix Of /////////////////////////
+	// <summary>
+	// Returns the first 8 bytes of text as NodeData caches them: big-endian
+	// and zero padded.
+	// </summary>
+	static uint64_t prefixOf(const char* text, size_t length);
+
+	///////////////////// To Big Endian /////////////////////
+	// <summary>
+	// Returns the 8 bytes of value, as they lie in memory, read as a
+	// big-endian integer.
+	// </summary>
+	static uint64_t toBigEndian(uint64_t value);
+
+	////////////////////// Lowest Bit /////////////////////////
+	// <summary>
+	// Returns the index of the lowest set bit of bits, which must not be 0.
+	// </summary>
+	static int lowestBit(uint64_t bits);
+
+	/////////////////////// Less Than /////////////////////////
+	// <summary>
+	// Orders tokens the same way NodeData::compare orders their data.
+	// </summary>
+	static bool lessThan(const Token &left, const Token &right);
+
+	/////////////////////// Same Text /////////////////////////
+	// <summary>
+	// Returns true if both tokens hold the same bytes, false otherwise.
+	// </summary>
+	static bool sameText(const Token &left, const Token &right);
+
+	////////////////////// Sort Tokens ////////////////////////
+	// <summary>
+	// Helper function that sorts [first, last) using workers threads: each
+	// sorts one slice, then neighbouring slices are merged in rounds.
+	// </summary>
+	static void sortTokens(Token* first, Token* last, int workers);
+
+	////////////////////// Build Record ///////////////////////
+	// <summary>
+	// Helper function that sorts the tokens of one record, drops repeats and
+	// bulk loads tree with them. The data is created by workers threads.
+	// </summary>
+	static void buildRecord(Token* first, Token* last, BinTree &tree,
+		int workers);
+
+	////////////////////// Run Parallel ///////////////////////
+	// <summary>
+	// Calls work(i) for every i in [0, count) on workers threads, the calling
+	// thread among them, each taking the next i from a shared counter.
+	// </summary>
+	template <typename Work>
+	static void runParallel(int count, int workers, Work work);
+};
+
+////////////////////// Run Parallel ///////////////////////
+// <summary>
+// Calls work(i) for every i in [0, count) on workers threads, the calling
+// thread among them, each taking the next i from a shared counter.
+// </summary>
+template <typename Work>
+void TreeLoader::runParallel(int count, int workers, Work work)
+{
+	atomic<int> next(0);
+	vector<thread> threads;
+
+	auto run = [&]()
+	{
+		for (int i = next++; i < count; i = next++)
+		{
+			work(i);
+		}
+	};
+
+	for (int worker = 1; worker < workers && worker < count; worker++)
+	{
+		threads.emplace_back(run);
+	}
+
+	run();
+
+	for (thread &worker : threads)
+	{
+		worker.join();
+	}
+}
+
+#endif
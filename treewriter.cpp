@@ -0,0 +1,326 @@
+// ------------------------------ treewriter.cpp ------------------------------
+// Implementation file for the TreeWriter class. Streams the data of a
+// BinTree as text through one large buffer.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - The stream buffer keeps no put area, so the NodeData stream never holds
+//   text of its own and everything it formats lands in the block in order.
+// ----------------------------------------------------------------------------
+
+#include <cstring>
+#include "treewriter.h"
+
+using namespace std;
+
+//////////////////// Stream Constructor ///////////////////
+// <summary>
+// Creates a writer that hands its blocks to out.
+// </summary>
+TreeWriter::TreeWriter(ostream &out, Format format, size_t bufferSize)
+	: TreeWriter(Sink([&out](const char* text, size_t length)
+	{
+		out.write(text, static_cast<streamsize>(length));
+	}), format, bufferSize)
+{
+}
+
+///////////////////// Sink Constructor ////////////////////
+// <summary>
+// Creates a writer that hands its blocks to sink.
+// </summary>
+TreeWriter::TreeWriter(Sink sink, Format format, size_t bufferSize)
+	: buffer(move(sink), bufferSize), stream(&buffer), format(format)
+{
+}
+
+/////////////////////// Destructor ////////////////////////
+// <summary>
+// Flushes whatever is still buffered.
+// </summary>
+TreeWriter::~TreeWriter()
+{
+	flush();
+}
+
+/////////////////////// Get Format ////////////////////////
+// <summary>
+// Returns the format used by the next write.
+// </summary>
+TreeWriter::Format TreeWriter::getFormat() const
+{
+	return format;
+}
+
+/////////////////////// Set Format ////////////////////////
+// <summary>
+// Changes the format used by later writes.
+// </summary>
+void TreeWriter::setFormat(Format format)
+{
+	this->format = format;
+}
+
+////////////////////////// Write //////////////////////////
+// <summary>
+// Appends the data of tree to the buffer in the current format, handing
+// full blocks to the sink as it goes.
+// </summary>
+void TreeWriter::write(const BinTree &tree)
+{
+	switch (format)
+	{
+	case IN_ORDER:
+		BinTree::inOrder(tree.root, [this](BinTree::Node* current)
+		{
+			writeData(*current->data);
+			buffer.append(' ');
+		});
+		buffer.append('\n');
+		break;
+
+	case SIDEWAYS:
+		BinTree::sideways(tree.root, [this](BinTree::Node* current, int level)
+		{
+			// indent for readability, 4 spaces per depth level
+			for (int i = level; i >= 0; i--)
+			{
+				buffer.append("    ", 4);
+			}
+
+			writeData(*current->data);
+			buffer.append('\n');
+		});
+		break;
+
+	case JSON:
+	{
+		bool first = true;
+
+		buffer.append('[');
+		BinTree::inOrder(tree.root, [this, &first](BinTree::Node* current)
+		{
+			if (!first)
+			{
+				buffer.append(',');
+			}
+			first = false;
+			writeJson(*current->data);
+		});
+		buffer.append("]\n", 2);
+		break;
+	}
+
+	case CSV:
+		BinTree::inOrder(tree.root, [this](BinTree::Node* current)
+		{
+			writeCsv(*current->data);
+			buffer.append('\n');
+		});
+		break;
+	}
+}
+
+////////////////////////// Flush //////////////////////////
+// <summary>
+// Hands whatever is buffered to the sink.
+// </summary>
+void TreeWriter::flush()
+{
+	buffer.flush();
+}
+
+//////////////////////// Write Data ///////////////////////
+// <summary>
+// Helper function that formats data straight into the buffer.
+// </summary>
+void TreeWriter::writeData(const NodeData &data)
+{
+	stream << data;
+}
+
+//////////////////////// Write JSON ///////////////////////
+// <summary>
+// Helper function that writes data as a quoted JSON string. Runs of
+// characters that need no escape are appended in one piece.
+// </summary>
+void TreeWriter::writeJson(const NodeData &data)
+{
+	static const char HEX[] = "0123456789abcdef";
+
+	formatField(data);
+	buffer.append('"');
+
+	size_t start = 0;
+
+	for (size_t i = 0; i < field.size(); i++)
+	{
+		unsigned char c = static_cast<unsigned char>(field[i]);
+
+		if (c >= 0x20 && c != '"' && c != '\\')
+		{
+			continue;
+		}
+
+		buffer.append(field.data() + start, i - start);
+		start = i + 1;
+
+		switch (c)
+		{
+		case '"':  buffer.append("\\\"", 2); break;
+		case '\\': buffer.append("\\\\", 2); break;
+		case '\n': buffer.append("\\n", 2); break;
+		case '\r': buffer.append("\\r", 2); break;
+		case '\t': buffer.append("\\t", 2); break;
+		default:
+		{
+			char escape[] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xf] };
+			buffer.append(escape, sizeof(escape));
+			break;
+		}
+		}
+	}
+
+	buffer.append(field.data() + start, field.size() - start);
+	buffer.append('"');
+}
+
+///////////////////////// Write CSV ///////////////////////
+// <summary>
+// Helper function that writes data as one CSV field, quoted only when it
+// holds a comma, quote or line break, with quotes doubled.
+// </summary>
+void TreeWriter::writeCsv(const NodeData &data)
+{
+	formatField(data);
+
+	if (field.find_first_of(",\"\r\n") == string::npos)
+	{
+		buffer.append(field.data(), field.size());
+		return;
+	}
+
+	size_t start = 0;
+	size_t quote = field.find('"');
+
+	buffer.append('"');
+
+	while (quote != string::npos)
+	{
+		buffer.append(field.data() + start, quote + 1 - start);
+		buffer.append('"');
+		start = quote + 1;
+		quote = field.find('"', start);
+	}
+
+	buffer.append(field.data() + start, field.size() - start);
+	buffer.append('"');
+}
+
+/////////////////////// Format Field ////////////////////
+// <summary>
+// Helper function that formats data into field. The string keeps its
+// capacity, so this does not allocate once it has grown.
+// </summary>
+void TreeWriter::formatField(const NodeData &data)
+{
+	field.clear();
+	buffer.capture = &field;
+	stream << data;
+	buffer.capture = nullptr;
+}
+
+/////////////////// Buffer Constructor ////////////////////
+// <summary>
+// Creates an empty block of capacity bytes, at least one.
+// </summary>
+TreeWriter::Buffer::Buffer(Sink sink, size_t capacity)
+	: capture(nullptr), sink(move(sink)), block(capacity > 0 ? capacity : 1),
+	used(0)
+{
+}
+
+//////////////////////// Append ///////////////////////////
+// <summary>
+// Appends length bytes of text to the block, handing the block to the sink
+// first if they do not fit. Text at least as large as the block goes to the
+// sink directly.
+// </summary>
+void TreeWriter::Buffer::append(const char* text, size_t length)
+{
+	if (length > block.size() - used)
+	{
+		flush();
+
+		if (length >= block.size())
+		{
+			sink(text, length);
+			return;
+		}
+	}
+
+	memcpy(block.data() + used, text, length);
+	used += length;
+}
+
+void TreeWriter::Buffer::append(char c)
+{
+	if (used == block.size())
+	{
+		flush();
+	}
+
+	block[used++] = c;
+}
+
+////////////////////////// Flush //////////////////////////
+// <summary>
+// Hands the block to the sink if it holds anything.
+// </summary>
+void TreeWriter::Buffer::flush()
+{
+	if (used > 0)
+	{
+		sink(block.data(), used);
+		used = 0;
+	}
+}
+
+///////////////////////// Xsputn //////////////////////////
+// <summary>
+// Takes the text of an insert into the stream.
+// </summary>
+// <returns>
+// Returns length, since all of the text is always taken.
+// </returns>
+streamsize TreeWriter::Buffer::xsputn(const char* text, streamsize length)
+{
+	if (capture != nullptr)
+	{
+		capture->append(text, static_cast<size_t>(length));
+	}
+	else
+	{
+		append(text, static_cast<size_t>(length));
+	}
+
+	return length;
+}
+
+//////////////////////// Overflow /////////////////////////
+// <summary>
+// Takes a single character inserted into the stream.
+// </summary>
+// <returns>
+// Returns c, or a value other than eof when c is eof.
+// </returns>
+TreeWriter::Buffer::int_type TreeWriter::Buffer::overflow(int_type c)
+{
+	if (traits_type::eq_int_type(c, traits_type::eof()))
+	{
+		return traits_type::not_eof(c);
+	}
+
+	char ch = traits_type::to_char_type(c);
+	xsputn(&ch, 1);
+	return c;
+}
@@ -0,0 +1,168 @@
+// ------------------------------ treewriter.h --------------------------------
+// Header file for the TreeWriter class. TreeWriter streams the data of a
+// BinTree as text to an ostream or to any other sink, in one of several
+// formats: in order on one line, sideways, a JSON array or CSV rows.
+//
+// Output is gathered in one large buffer that is handed to the sink only
+// when it fills up or is flushed, so a tree of any size is written in big
+// blocks without building the whole text in memory and without flushing
+// the stream after every data. The buffer is kept between writes, so one
+// writer can dump many trees.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Data is formatted with NodeData's operator<<. JSON and CSV escape the
+//   resulting text; the other formats print it unchanged.
+// - Text stays in the buffer until it fills, flush is called or the writer
+//   is destroyed. Output written straight to the same stream in between
+//   comes out ahead of it.
+// - The tree must not be changed while write runs.
+// ----------------------------------------------------------------------------
+
+#ifndef TREEWRITER_H
+#define TREEWRITER_H
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "bintree.h"
+#include "nodedata.h"
+
+using namespace std;
+
+class TreeWriter
+{
+public:
+	// <summary>
+	// Layout of the written text. IN_ORDER matches operator<< and SIDEWAYS
+	// matches displaySideways. JSON writes one array of strings per tree and
+	// CSV one row per data, both in sorted order.
+	// </summary>
+	enum Format { IN_ORDER, SIDEWAYS, JSON, CSV };
+
+	// <summary>
+	// Receives each full block of text, with its length in bytes.
+	// </summary>
+	typedef function<void(const char*, size_t)> Sink;
+
+	static const size_t DEFAULT_BUFFER = 1 << 16;	// bytes per block
+
+	//////////////////// Stream Constructor ///////////////////
+	// <summary>
+	// Creates a writer that hands its blocks to out.
+	// </summary>
+	// <parameter = "out">
+	// Stream to write to. It must outlive the writer.
+	// </parameter>
+	explicit TreeWriter(ostream &out, Format format = IN_ORDER,
+		size_t bufferSize = DEFAULT_BUFFER);
+
+	///////////////////// Sink Constructor ////////////////////
+	// <summary>
+	// Creates a writer that hands its blocks to sink, for output that is
+	// not an ostream such as a socket or a compressor.
+	// </summary>
+	explicit TreeWriter(Sink sink, Format format = IN_ORDER,
+		size_t bufferSize = DEFAULT_BUFFER);
+
+	/////////////////////// Destructor ////////////////////////
+	// <summary>
+	// Flushes whatever is still buffered.
+	// </summary>
+	~TreeWriter();
+
+	TreeWriter(const TreeWriter&) = delete;
+	TreeWriter& operator=(const TreeWriter&) = delete;
+
+	/////////////////////// Get Format ////////////////////////
+	// <summary>
+	// Returns the format used by the next write.
+	// </summary>
+	Format getFormat() const;
+
+	/////////////////////// Set Format ////////////////////////
+	// <summary>
+	// Changes the format used by later writes.
+	// </summary>
+	void setFormat(Format format);
+
+	////////////////////////// Write //////////////////////////
+	// <summary>
+	// Appends the data of tree to the buffer in the current format, handing
+	// full blocks to the sink as it goes. Uses an explicit stack, so any tree
+	// shape is safe.
+	// </summary>
+	// <parameter = "tree">
+	// Tree to write. It is left unchanged.
+	// </parameter>
+	void write(const BinTree &tree);
+
+	////////////////////////// Flush //////////////////////////
+	// <summary>
+	// Hands whatever is buffered to the sink. Does not flush the stream the
+	// sink writes to.
+	// </summary>
+	void flush();
+
+private:
+	// <summary>
+	// Stream buffer behind the NodeData stream. It has no put area, so every
+	// insert reaches xsputn or overflow, which either append to the block or,
+	// while capture is set, to the string capture points at.
+	// </summary>
+	class Buffer : public streambuf
+	{
+	public:
+		Buffer(Sink sink, size_t capacity);
+
+		void append(const char* text, size_t length);
+		void append(char c);
+		void flush();
+
+		string* capture;					// field being formatted, if any
+
+	protected:
+		streamsize xsputn(const char* text, streamsize length) override;
+		int_type overflow(int_type c) override;
+
+	private:
+		Sink sink;
+		vector<char> block;					// text not yet handed to sink
+		size_t used;						// bytes of block in use
+	};
+
+	Buffer buffer;
+	ostream stream;							// formats NodeData into buffer
+	Format format;
+	string field;							// scratch for JSON and CSV data
+
+	//////////////////////// Write Data ///////////////////////
+	// <summary>
+	// Helper function that formats data straight into the buffer.
+	// </summary>
+	void writeData(const NodeData &data);
+
+	//////////////////////// Write JSON ///////////////////////
+	// <summary>
+	// Helper function that writes data as a quoted JSON string, escaping
+	// quotes, backslashes and control characters.
+	// </summary>
+	void writeJson(const NodeData &data);
+
+	///////////////////////// Write CSV ///////////////////////
+	// <summary>
+	// Helper function that writes data as one CSV field, quoted only when it
+	// holds a comma, quote or line break, with quotes doubled.
+	// </summary>
+	void writeCsv(const NodeData &data);
+
+	/////////////////////// Format Field ////////////////////
+	// <summary>
+	// Helper function that formats data into field.
+	// </summary>
+	void formatField(const NodeData &data);
+};
+
+#endif
@@ -0,0 +1,313 @@
+// ----------------------------- wideindex.cpp --------------------------------
+// Implementation file for the WideIndex class. WideIndex is a read-only
+// static B-tree over 64-bit integer keys searched a whole node at a time.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Keys passed to the constructor are sorted and free of duplicates.
+// - The AVX2 and SSE4.2 kernels are only built for x86 with GCC or Clang;
+//   elsewhere every kernel request falls back to SCALAR.
+// ----------------------------------------------------------------------------
+
+#include <climits>
+#include "wideindex.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WIDEINDEX_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+////////////////////////// Size ///////////////////////////
+// <summary>
+// Returns the number of keys in the index.
+// </summary>
+int WideIndex::size() const
+{
+	return count;
+}
+
+///////////////////////// Kernel //////////////////////////
+// <summary>
+// Returns the search kernel in use, never AUTO.
+// </summary>
+WideIndex::Kernel WideIndex::getKernel() const
+{
+	return kernel;
+}
+
+//////////////////////// Retrieve /////////////////////////
+// <summary>
+// Function to search for key in the index.
+// </summary>
+// <returns>
+// Returns true if key is in the index, false otherwise.
+// </returns>
+bool WideIndex::retrieve(int64_t key) const
+{
+	int64_t found;
+	return search(key, found) < count && found == key;
+}
+
+////////////////////// Lower Bound ////////////////////////
+// <summary>
+// Finds the smallest key not less than key, sets found to it if found.
+// </summary>
+// <returns>
+// Returns true if such a key exists and is set, false otherwise.
+// </returns>
+bool WideIndex::lowerBound(int64_t key, int64_t &found) const
+{
+	int64_t candidate;
+
+	if (search(key, candidate) == count)
+	{
+		return false;
+	}
+
+	found = candidate;
+	return true;
+}
+
+////////////////////// Upper Bound ////////////////////////
+// <summary>
+// Finds the smallest key strictly greater than key, sets found to it if
+// found. Keys are integers, so this is the lower bound of key + 1.
+// </summary>
+// <returns>
+// Returns true if such a key exists and is set, false otherwise.
+// </returns>
+bool WideIndex::upperBound(int64_t key, int64_t &found) const
+{
+	if (key == INT64_MAX)
+	{
+		return false;
+	}
+
+	return lowerBound(key + 1, found);
+}
+
+////////////////////////// Rank ///////////////////////////
+// <summary>
+// Returns the number of keys in the index less than key.
+// </summary>
+int WideIndex::rank(int64_t key) const
+{
+	int64_t found;
+	return search(key, found);
+}
+
+////////////////////// Count Range ////////////////////////
+// <summary>
+// Returns the number of keys k with low <= k <= high, 0 if high < low.
+// </summary>
+int WideIndex::countRange(int64_t low, int64_t high) const
+{
+	if (high < low)
+	{
+		return 0;
+	}
+
+	int end = (high == INT64_MAX) ? count : rank(high + 1);
+	return end - rank(low);
+}
+
+///////////////////////// Build ///////////////////////////
+// <summary>
+// Lays sorted out in the implicit layout, padding the last slots, and picks
+// the search kernel.
+// </summary>
+void WideIndex::build(const vector<int64_t> &sorted, Kernel requested)
+{
+	count = static_cast<int>(sorted.size());
+	nodes.assign((sorted.size() + NODE_KEYS - 1) / NODE_KEYS, Node());
+	build(sorted, 0, 0);
+
+	if (requested == AUTO)
+	{
+		kernel = cpuSupports(AVX2) ? AVX2 : cpuSupports(SSE42) ? SSE42 : SCALAR;
+	}
+	else
+	{
+		kernel = cpuSupports(requested) ? requested : SCALAR;
+	}
+
+	countLess = (kernel == AVX2) ? countLessAvx2
+		: (kernel == SSE42) ? countLessSse42
+		: countLessScalar;
+}
+
+////////////////////// Build Helper ///////////////////////
+// <summary>
+// Helper function for build. Fills the subtree of node k in order starting
+// at sorted position next. Slots past the last key get INT64_MAX and rank
+// size(); they all come after the real keys in order, so a search never
+// prefers one over an equal real key.
+// </summary>
+// <returns>
+// Returns the next sorted position not yet placed.
+// </returns>
+int WideIndex::build(const vector<int64_t> &sorted, int k, int next)
+{
+	if (static_cast<size_t>(k) >= nodes.size())
+	{
+		return next;
+	}
+
+	Node &node = nodes[k];
+
+	for (int i = 0; i < NODE_KEYS; i++)
+	{
+		next = build(sorted, k * (NODE_KEYS + 1) + i + 1, next);
+
+		if (next < count)
+		{
+			node.keys[i] = sorted[next];
+			node.ranks[i] = next++;
+		}
+		else
+		{
+			node.keys[i] = INT64_MAX;
+			node.ranks[i] = count;
+		}
+	}
+
+	return build(sorted, k * (NODE_KEYS + 1) + NODE_KEYS + 1, next);
+}
+
+//////////////////////// Search ///////////////////////////
+// <summary>
+// Finds the first key not less than key. In each node the number of keys
+// less than key is both the slot of the best candidate so far and the child
+// to descend into, so one kernel call per level does all the comparing.
+// </summary>
+// <returns>
+// Returns the sorted position of that key, size() if there is none, and
+// sets found to the key itself when there is one.
+// </returns>
+int WideIndex::search(int64_t key, int64_t &found) const
+{
+	int position = count;
+	size_t k = 0;
+
+	while (k < nodes.size())
+	{
+		const Node &node = nodes[k];
+		int i = countLess(node.keys, key);
+
+		if (i < NODE_KEYS)
+		{
+			position = node.ranks[i];
+			found = node.keys[i];
+		}
+
+		k = k * (NODE_KEYS + 1) + i + 1;
+	}
+
+	return position;
+}
+
+////////////////////// Count Less /////////////////////////
+// <summary>
+// Portable kernel. Counts the keys of a node less than key.
+// </summary>
+int WideIndex::countLessScalar(const int64_t* keys, int64_t key)
+{
+	int less = 0;
+
+	for (int i = 0; i < NODE_KEYS; i++)
+	{
+		less += (keys[i] < key) ? 1 : 0;
+	}
+
+	return less;
+}
+
+#ifdef WIDEINDEX_X86
+
+////////////////////// Count Less /////////////////////////
+// <summary>
+// SSE4.2 kernel. Compares two keys per instruction and counts the set bits
+// of the combined movemask.
+// </summary>
+__attribute__((target("sse4.2")))
+int WideIndex::countLessSse42(const int64_t* keys, int64_t key)
+{
+	__m128i needle = _mm_set1_epi64x(key);
+	int mask = 0;
+
+	for (int i = 0; i < NODE_KEYS; i += 2)
+	{
+		__m128i block = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(keys + i));
+		__m128i less = _mm_cmpgt_epi64(needle, block);
+		mask |= _mm_movemask_pd(_mm_castsi128_pd(less)) << i;
+	}
+
+	return __builtin_popcount(mask);
+}
+
+////////////////////// Count Less /////////////////////////
+// <summary>
+// AVX2 kernel. Compares four keys per instruction and counts the set bits
+// of the combined movemask.
+// </summary>
+__attribute__((target("avx2")))
+int WideIndex::countLessAvx2(const int64_t* keys, int64_t key)
+{
+	__m256i needle = _mm256_set1_epi64x(key);
+	int mask = 0;
+
+	for (int i = 0; i < NODE_KEYS; i += 4)
+	{
+		__m256i block = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(keys + i));
+		__m256i less = _mm256_cmpgt_epi64(needle, block);
+		mask |= _mm256_movemask_pd(_mm256_castsi256_pd(less)) << i;
+	}
+
+	return __builtin_popcount(mask);
+}
+
+///////////////////// CPU Supports ////////////////////////
+// <summary>
+// Returns true if the running CPU can execute the passed kernel.
+// </summary>
+bool WideIndex::cpuSupports(Kernel kernel)
+{
+	__builtin_cpu_init();
+
+	switch (kernel)
+	{
+	case AVX2:
+		return __builtin_cpu_supports("avx2");
+	case SSE42:
+		return __builtin_cpu_supports("sse4.2");
+	default:
+		return true;
+	}
+}
+
+#else
+
+int WideIndex::countLessSse42(const int64_t* keys, int64_t key)
+{
+	return countLessScalar(keys, key);
+}
+
+int WideIndex::countLessAvx2(const int64_t* keys, int64_t key)
+{
+	return countLessScalar(keys, key);
+}
+
+///////////////////// CPU Supports ////////////////////////
+// <summary>
+// Returns true if the running CPU can execute the passed kernel. Only the
+// scalar kernel is built on this target.
+// </summary>
+bool WideIndex::cpuSupports(Kernel kernel)
+{
+	return kernel == SCALAR || kernel == AUTO;
+}
+
+#endif
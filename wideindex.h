@@ -0,0 +1,166 @@
+// ------------------------------ wideindex.h ---------------------------------
+// Header file for the WideIndex class. WideIndex is a read-only search
+// structure for 64-bit integer keys, laid out as a static B-tree with 16 keys
+// per node. The keys of a node fill two cache lines, and the children of
+// node k are stored implicitly at k * 17 + 1 through k * 17 + 17, so no
+// pointers are kept. A search compares the key against a whole node at once with SIMD
+// compare and movemask instructions and moves to the child in one step.
+// ----------------------------------------------------------------------------
+// Assumptions:
+// - Keys passed to the constructor are sorted and free of duplicates.
+// - The SIMD kernel is chosen once at construction from what the running CPU
+//   supports: AVX2, then SSE4.2, then a portable scalar loop. No special
+//   compiler flags are needed; the SIMD kernels are compiled per function.
+// - Positions returned by rank count from 0 in sorted order, the same as
+//   BinTree.
+// ----------------------------------------------------------------------------
+
+#ifndef WIDEINDEX_H
+#define WIDEINDEX_H
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class WideIndex
+{
+public:
+	static const int NODE_KEYS = 16;		// keys per node
+
+	// <summary>
+	// Search kernels. AUTO picks the fastest one the CPU supports; the others
+	// force a kernel, falling back to SCALAR if the CPU lacks it.
+	// </summary>
+	enum Kernel { AUTO, SCALAR, SSE42, AVX2 };
+
+	////////////////////// Constructor ////////////////////////
+	// <summary>
+	// Builds an index over the sorted keys in [first, last).
+	// </summary>
+	// <parameter = "kernel">
+	// Search kernel to use, AUTO by default.
+	// </parameter>
+	template <typename InputIt>
+	WideIndex(InputIt first, InputIt last, Kernel kernel = AUTO);
+
+	////////////////////////// Size ///////////////////////////
+	// <summary>
+	// Returns the number of keys in the index.
+	// </summary>
+	int size() const;
+
+	///////////////////////// Kernel //////////////////////////
+	// <summary>
+	// Returns the search kernel in use, never AUTO.
+	// </summary>
+	Kernel getKernel() const;
+
+	//////////////////////// Retrieve /////////////////////////
+	// <summary>
+	// Function to search for key in the index.
+	// </summary>
+	// <returns>
+	// Returns true if key is in the index, false otherwise.
+	// </returns>
+	bool retrieve(int64_t key) const;
+
+	////////////////////// Lower Bound ////////////////////////
+	// <summary>
+	// Finds the smallest key not less than key, sets found to it if found.
+	// </summary>
+	// <returns>
+	// Returns true if such a key exists and is set, false otherwise.
+	// </returns>
+	bool lowerBound(int64_t key, int64_t &found) const;
+
+	////////////////////// Upper Bound ////////////////////////
+	// <summary>
+	// Finds the smallest key strictly greater than key, sets found to it if
+	// found.
+	// </summary>
+	// <returns>
+	// Returns true if such a key exists and is set, false otherwise.
+	// </returns>
+	bool upperBound(int64_t key, int64_t &found) const;
+
+	////////////////////////// Rank ///////////////////////////
+	// <summary>
+	// Returns the number of keys in the index less than key.
+	// </summary>
+	int rank(int64_t key) const;
+
+	////////////////////// Count Range ////////////////////////
+	// <summary>
+	// Returns the number of keys k with low <= k <= high, 0 if high < low.
+	// </summary>
+	int countRange(int64_t low, int64_t high) const;
+
+private:
+	struct alignas(64) Node {
+		int64_t keys[NODE_KEYS];			// sorted keys, padded with INT64_MAX
+		int32_t ranks[NODE_KEYS];			// sorted position of each key
+	};
+
+	// counts the keys of a node less than key
+	typedef int (*CountFn)(const int64_t* keys, int64_t key);
+
+	vector<Node> nodes;						// nodes in implicit layout
+	int count;								// number of real keys
+	Kernel kernel;							// kernel in use
+	CountFn countLess;						// kernel entry point
+
+	///////////////////////// Build ///////////////////////////
+	// <summary>
+	// Lays sorted out in the implicit layout, padding the last slots.
+	// </summary>
+	void build(const vector<int64_t> &sorted, Kernel requested);
+
+	////////////////////// Build Helper ///////////////////////
+	// <summary>
+	// Helper function for build. Fills the subtree of node k in order starting
+	// at sorted position next. Recursion depth is the tree height.
+	// </summary>
+	// <returns>
+	// Returns the next sorted position not yet placed.
+	// </returns>
+	int build(const vector<int64_t> &sorted, int k, int next);
+
+	//////////////////////// Search ///////////////////////////
+	// <summary>
+	// Finds the first key not less than key.
+	// </summary>
+	// <returns>
+	// Returns the sorted position of that key, size() if there is none, and
+	// sets found to the key itself when there is one.
+	// </returns>
+	int search(int64_t key, int64_t &found) const;
+
+	////////////////////// Count Less /////////////////////////
+	// <summary>
+	// Search kernels. Each counts the NODE_KEYS keys of a node less than key,
+	// which is also the child to descend into.
+	// </summary>
+	static int countLessScalar(const int64_t* keys, int64_t key);
+	static int countLessSse42(const int64_t* keys, int64_t key);
+	static int countLessAvx2(const int64_t* keys, int64_t key);
+
+	///////////////////// CPU Supports ////////////////////////
+	// <summary>
+	// Returns true if the running CPU can execute the passed kernel.
+	// </summary>
+	static bool cpuSupports(Kernel kernel);
+};
+
+////////////////////// Constructor ////////////////////////
+// <summary>
+// Builds an index over the sorted keys in [first, last).
+// </summary>
+template <typename InputIt>
+WideIndex::WideIndex(InputIt first, InputIt last, Kernel kernel)
+{
+	vector<int64_t> sorted(first, last);
+	build(sorted, kernel);
+}
+
+#endif